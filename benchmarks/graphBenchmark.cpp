@@ -0,0 +1,160 @@
+/**
+ * @file: graphBenchmark.cpp
+ * @author: 0Ykahil
+ *
+ * Benchmarks the graph on each dataset at a few ranges: build time, adjacency memory,
+ * and the average time of findShortestPath (fewest landings, distance and A*) between random airports,
+ * then the fewest landings and distance searches again on each search queue, and the delta-stepping
+ * distancesFrom on 1 thread up to every hardware thread.
+ *
+ * Run from the repository root: ./build/graphBenchmark [dataset.json ...]
+ */
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "Graph.h"
+
+namespace {
+
+const int RANGES[] = {250, 500, 1000, 2000};
+const int QUERIES = 200;
+const SearchQueue QUEUES[] = {SearchQueue::BinaryHeap, SearchQueue::QuaternaryHeap, SearchQueue::RadixHeap};
+const int ONE_TO_ALL_SOURCES = 20;
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The thread counts distancesFrom is timed with: 1, 2, 4, ... and every hardware thread.
+std::vector<size_t> threadCounts() {
+    size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(hardwareThreads);
+    return counts;
+}
+
+void benchmarkDataset(const std::string& filepath) {
+    AirportTable table;
+    try {
+        table = AirportTable::load(filepath);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return;
+    }
+
+    std::cout << filepath << " (" << table.size() << " airports)" << std::endl;
+    std::cout << std::setw(8) << "range" << std::setw(10) << "edges" << std::setw(12) << "build ms"
+              << std::setw(14) << "adj KiB" << std::setw(16) << "dijkstra us" << std::setw(16) << "min dist us"
+              << std::setw(12) << "astar us" << std::endl;
+
+    // fewest landings and distance times on each queue, printed after the main table
+    std::ostringstream queueTable;
+    queueTable << std::setw(8) << "range";
+    for (SearchQueue queue : QUEUES) {
+        queueTable << std::setw(14) << searchQueueName(queue) + " fewest" << std::setw(14) << searchQueueName(queue) + " dist";
+    }
+    queueTable << std::endl;
+
+    // distancesFrom times on each thread count, and their speedup over one thread
+    const std::vector<size_t> counts = threadCounts();
+    std::ostringstream threadTable;
+    threadTable << std::setw(8) << "range";
+    for (size_t threads : counts) {
+        threadTable << std::setw(12) << std::to_string(threads) + " thr ms" << std::setw(10) << "speedup";
+    }
+    threadTable << std::endl;
+
+    for (int range : RANGES) {
+        Graph g(table.size());
+        auto start = std::chrono::steady_clock::now();
+        g.generateAirportGraph(table, range, true, BuildMode::SpatialGrid);
+        double buildMs = msSince(start);
+
+        std::vector<Airport> airports = g.getAirports();
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, airports.size() - 1);
+        std::vector<std::pair<size_t, size_t>> queries;
+        for (int q = 0; q < QUERIES; ++q) {
+            queries.push_back({pick(rng), pick(rng)});
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (const auto& [s, d] : queries) {
+            g.findShortestPath(airports[s], airports[d]);
+        }
+        double fewestUs = msSince(start) * 1000.0 / QUERIES;
+
+        start = std::chrono::steady_clock::now();
+        for (const auto& [s, d] : queries) {
+            g.findShortestPathMIN(airports[s], airports[d]);
+        }
+        double distanceUs = msSince(start) * 1000.0 / QUERIES;
+
+        start = std::chrono::steady_clock::now();
+        for (const auto& [s, d] : queries) {
+            g.findShortestPath(airports[s], airports[d], Graph::UNLIMITED_RANGE, RouteAlgorithm::AStar);
+        }
+        double aStarUs = msSince(start) * 1000.0 / QUERIES;
+
+        std::cout << std::setw(8) << range << std::setw(10) << g.edgeCount()
+                  << std::setw(12) << std::fixed << std::setprecision(1) << buildMs
+                  << std::setw(14) << g.adjacencyMemoryBytes() / 1024
+                  << std::setw(16) << fewestUs << std::setw(16) << distanceUs << std::setw(12) << aStarUs << std::endl;
+
+        queueTable << std::setw(8) << range;
+        for (SearchQueue queue : QUEUES) {
+            SearchContext context(queue);
+            for (RouteAlgorithm algorithm : {RouteAlgorithm::FewestLandings, RouteAlgorithm::Distance}) {
+                start = std::chrono::steady_clock::now();
+                for (const auto& [s, d] : queries) {
+                    g.findShortestPath(airports[s], airports[d], context, Graph::UNLIMITED_RANGE, algorithm);
+                }
+                queueTable << std::setw(14) << std::fixed << std::setprecision(1) << msSince(start) * 1000.0 / QUERIES;
+            }
+        }
+        queueTable << std::endl;
+
+        threadTable << std::setw(8) << range;
+        double oneThreadMs = 0;
+        for (size_t threads : counts) {
+            start = std::chrono::steady_clock::now();
+            for (int q = 0; q < ONE_TO_ALL_SOURCES; ++q) {
+                g.distancesFrom(airports[queries[q].first].id, Graph::UNLIMITED_RANGE, threads);
+            }
+            double ms = msSince(start) / ONE_TO_ALL_SOURCES;
+            if (threads == 1) {
+                oneThreadMs = ms;
+            }
+            threadTable << std::setw(12) << std::fixed << std::setprecision(2) << ms
+                        << std::setw(9) << std::setprecision(2) << oneThreadMs / ms << "x";
+        }
+        threadTable << std::endl;
+    }
+    std::cout << std::endl << "search queues (us per route)" << std::endl << queueTable.str() << std::endl;
+    std::cout << "delta-stepping distancesFrom (ms per source; hardware threads: " << std::thread::hardware_concurrency()
+              << ")" << std::endl << threadTable.str() << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> datasets;
+    for (int i = 1; i < argc; ++i) {
+        datasets.push_back(argv[i]);
+    }
+    if (datasets.empty()) {
+        datasets = {"./datasets/airports.json", "./datasets/global_airports.json"};
+    }
+
+    for (const std::string& dataset : datasets) {
+        benchmarkDataset(dataset);
+    }
+    return 0;
+}
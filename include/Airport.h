@@ -8,8 +8,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <cmath>
 
+// Earth's radius in nm
+const double EARTH_RADIUS_NM = 3440.065;
+
 // Converts degree coordinates to radians for formula use
 double toRadians(double degrees);
 
@@ -25,6 +30,20 @@ double toRadians(double degrees);
  */
 double haversine(double lat1, double lon1, double lat2, double lon2);
 
+// The type of an airport, stored in one byte instead of its name
+enum class AirportType : uint8_t {
+    Small,   // small_airport
+    Medium,  // medium_airport
+    Large,   // large_airport
+    Unknown  // any other type
+};
+
+// Returns the type named by a dataset's type field (e.g. "medium_airport"), or AirportType::Unknown.
+AirportType parseAirportType(std::string_view name);
+
+// Returns the dataset name of a type (e.g. "medium_airport"), or "unknown".
+std::string_view airportTypeName(AirportType type);
+
 /**
  * @class Airport
  * Represents an airport with its identifier, name, type, id, latitude, and longitude.
@@ -33,7 +52,8 @@ class Airport {
     public:
         std::string id;     // Identifier of airport by priority if available (IATA > ICAO > Ident).
         std::string name;   // Airport name.
-        std::string type;   // Airport type (one of: small_airport, medium_airport, large_airport).
+        AirportType type;   // Airport type (one of: small_airport, medium_airport, large_airport).
+        std::string continent; // Continent code of the airport (e.g. NA), empty if unknown.
         double latitude;    // Latitude of airport.
         double longitude;   // Longitude of airport.
 
@@ -45,9 +65,10 @@ class Airport {
          * @param type The type of the airport (one of small_airport, medium_airport, or large_airport).
          * @param lat  The latitude of the airport (in degrees).
          * @param lon  The longitude of the airport (in degrees).
+         * @param continent The continent code of the airport (e.g. NA).
          */
         Airport(const std::string& id, const std::string& name, const std::string& type, 
-                double lat, double lon);
+                double lat, double lon, const std::string& continent = "");
         
         /**
          * Empty constructor for Airport with no values.
@@ -0,0 +1,64 @@
+/**
+ * @file: AirportSearchIndex.h
+ * @author: 0Ykahil
+ *
+ * Declaration of AirportSearchIndex, a trigram index for finding airports by part of their code or name
+ */
+#pragma once
+
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "AirportTable.h"
+#include "StringArena.h"
+
+/**
+ * @class AirportSearchIndex
+ * Answers case-insensitive substring searches over the codes and names of airports without scanning them all.
+ *
+ * The codes and names are uppercased once, when the index is built, and every trigram (three consecutive characters)
+ * of each is recorded with the airports containing it, in a sorted posting list. Every trigram of a query is in each
+ * airport that contains the query, so a search intersects the posting lists of the query's trigrams, shortest first,
+ * and checks only the airports left. Queries of fewer than three characters scan the uppercased strings instead.
+ */
+class AirportSearchIndex {
+    public:
+        /**
+         * Indexes the codes and names of airports.
+         *
+         * @param airports The airports; vertex i of a graph is airport i of its table.
+         */
+        static AirportSearchIndex build(const AirportTable& airports);
+
+        /**
+         * Returns the index of every airport whose code or name contains text, ignoring case, in order of index.
+         *
+         * @param text The text to find.
+         * @param includeCodes If false, only names are searched.
+         */
+        std::vector<uint32_t> search(std::string_view text, bool includeCodes = true) const;
+
+        // Returns the code of airport i, uppercased.
+        std::string_view code(size_t i) const { return strings.view(codes[i]); }
+
+        // Returns the name of airport i, uppercased.
+        std::string_view name(size_t i) const { return strings.view(names[i]); }
+
+        // Returns the number of airports.
+        size_t size() const { return codes.size(); }
+
+        // Returns the number of bytes used by the index.
+        size_t memoryBytes() const;
+
+    private:
+        // Returns true if airport i matches the uppercased text.
+        bool matches(size_t i, std::string_view upperText, bool includeCodes) const;
+
+        StringArena strings;              // The uppercased codes and names.
+        std::vector<ArenaString> codes;   // The uppercased code of each airport.
+        std::vector<ArenaString> names;   // The uppercased name of each airport.
+        std::vector<uint32_t> trigrams;   // Every trigram found, packed into 24 bits, in ascending order.
+        std::vector<uint32_t> offsets;    // The posting list of trigrams[k] is [offsets[k], offsets[k + 1]).
+        std::vector<uint32_t> postings;   // The airports containing each trigram, in ascending order.
+};
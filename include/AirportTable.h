@@ -0,0 +1,100 @@
+/**
+ * @file: AirportTable.h
+ * @author: 0Ykahil
+ *
+ * Declaration of AirportTable, the compact in-memory form of an airport dataset
+ */
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <nlohmann/json.hpp>
+#include "Airport.h"
+#include "StringArena.h"
+
+/**
+ * @class AirportTable
+ * The airports of a dataset stored column by column, with coordinates already parsed to doubles.
+ * Every string lives in one StringArena and the type is a one byte enum, so an airport costs a
+ * 28 byte record, its coordinates and its characters, and reading one never copies a string.
+ *
+ * load() streams the dataset through a SAX parser straight into the table, so the whole JSON
+ * document is never held in memory, and the coordinates are converted once with std::from_chars
+ * instead of on every graph build.
+ */
+class AirportTable {
+    public:
+        // Constructs an empty table.
+        AirportTable() = default;
+
+        /**
+         * Streams an airport dataset (a JSON array of airport objects) into a table.
+         * Throws std::runtime_error if the file cannot be opened or an airport is malformed.
+         *
+         * @param filename The path of the dataset (e.g. ./datasets/airports.json).
+         */
+        static AirportTable load(const std::string& filename);
+
+        // Same as load, reading the dataset from a stream.
+        static AirportTable load(std::istream& input);
+
+        /**
+         * Builds a table from an already parsed dataset.
+         * Throws std::runtime_error if an airport is malformed.
+         *
+         * @param jsonData The JSON array of airport objects.
+         */
+        static AirportTable fromJson(const nlohmann::json& jsonData);
+
+        // Builds a table from airport objects (e.g. the airports of a graph loaded from a snapshot).
+        static AirportTable fromAirports(const std::vector<Airport>& airports);
+
+        /**
+         * Parses a coordinate written as text (e.g. "45.3225") with std::from_chars.
+         * Returns false if the text is not a number.
+         */
+        static bool parseCoordinate(const std::string& text, double& value);
+
+        // Adds an airport to the end of the table.
+        void add(std::string_view id, std::string_view name, AirportType type,
+                 std::string_view continent, double latitude, double longitude);
+
+        // Adds an Airport object to the end of the table.
+        void add(const Airport& airport);
+
+        // Reserves space for n airports.
+        void reserve(size_t n);
+
+        // Returns the number of airports.
+        size_t size() const { return records.size(); }
+
+        // The fields of airport i. The views point into the table and are valid until the next add.
+        std::string_view id(size_t i) const { return strings.view(records[i].id); }
+        std::string_view name(size_t i) const { return strings.view(records[i].name); }
+        std::string_view continent(size_t i) const { return strings.view(records[i].continent); }
+        AirportType type(size_t i) const { return records[i].type; }
+        double latitude(size_t i) const { return latitudes[i]; }
+        double longitude(size_t i) const { return longitudes[i]; }
+
+        // Returns airport i as an Airport object (a copy).
+        Airport airport(size_t i) const;
+
+        // Returns the number of bytes allocated by the table.
+        size_t memoryBytes() const;
+
+    private:
+        // The strings and type of an airport.
+        struct Record {
+            ArenaString id;        // Identifier (the dataset's ident).
+            ArenaString name;      // Name.
+            ArenaString continent; // Continent code (interned, empty if unknown).
+            AirportType type;      // Type.
+        };
+
+        StringArena strings;             // Every string of every airport.
+        std::vector<Record> records;     // One record per airport.
+        std::vector<double> latitudes;   // Latitude of each airport (in degrees).
+        std::vector<double> longitudes;  // Longitude of each airport (in degrees).
+};
@@ -0,0 +1,56 @@
+/**
+ * @file: BidirectionalSearch.h
+ * @author: 0Ykahil
+ *
+ * Declaration of BidirectionalSearch, a Dijkstra that searches from both ends of a route at once
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+
+/**
+ * @class BidirectionalSearch
+ * Finds a route by running Dijkstra forward from the start and backward from the destination until the two
+ * searches meet. Each search only has to cover a disk of about half the route's length around its end, so
+ * long routes settle far fewer airports than a search from the start alone.
+ *
+ * Flights are stored in both directions, so the backward search reads the same adjacency as the forward one.
+ * Every edge relaxed next to a vertex the other search has reached gives a candidate route; the searches stop
+ * once the sum of the smallest keys left in their queues is at least the best candidate, at which point no
+ * shorter route can exist.
+ *
+ * Routes are costed as weight + landingPenalty per edge: 0 finds the shortest route, and a positive penalty
+ * trades up to that many miles for each landing saved.
+ *
+ * The per-vertex arrays of both directions are kept by the calling thread and reused by its next search, and
+ * each thread that runs two-thread searches keeps one helper thread for their backward halves.
+ */
+class BidirectionalSearch {
+    public:
+        // The landing penalty that matches the fewest-landings mode, which accepts 50nm more for a landing less.
+        static constexpr int FEWEST_LANDINGS_PENALTY = 50;
+
+        /**
+         * @param adjacency The graph's adjacency; it must outlive the search.
+         */
+        explicit BidirectionalSearch(const CompressedAdjacency& adjacency);
+
+        /**
+         * Returns the route from src to dest in the format of Graph::findShortestPath (vertices from dest back to src,
+         * and the route's total weight), or an empty route if dest cannot be reached.
+         *
+         * @param src The index of the starting vertex.
+         * @param dest The index of the destination vertex.
+         * @param range The range of the aircraft; only edges with minRange <= range are flown.
+         * @param landingPenalty The cost added to each edge (see the class comment).
+         * @param useTwoThreads If true, the backward search runs on the calling thread's helper alongside the forward one.
+         */
+        std::pair<std::vector<int>, double> findPath(int src, int dest, uint32_t range, int landingPenalty = 0,
+                                                     bool useTwoThreads = false) const;
+
+    private:
+        const CompressedAdjacency& adjacency;
+};
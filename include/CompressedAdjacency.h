@@ -0,0 +1,124 @@
+/**
+ * @file: CompressedAdjacency.h
+ * @author: 0Ykahil
+ *
+ * Declaration of CompressedAdjacency, the frozen compressed sparse row (CSR)
+ * form of a graph's adjacency list.
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Edge.h"
+#include "FlatArray.h"
+
+/**
+ * @class CompressedAdjacency
+ * Stores every vertex's edges back to back in two flat arrays of 32-bit neighbours and weights,
+ * with one offsets array marking where each vertex's edges start. Compared to a list of Edge objects
+ * this is one contiguous allocation, 8 bytes per edge instead of a heap node per edge, and relaxing
+ * a vertex's edges in Dijkstra is a linear scan.
+ *
+ * Each vertex's edges are sorted by weight, so a search for an aircraft with a shorter range than
+ * the graph was built for can stop scanning a vertex's edges at the first one beyond its range.
+ * Weights are stored packed (see packWeight) so that cut-off is exact.
+ */
+class CompressedAdjacency {
+    public:
+        // Constructs an adjacency with no vertices.
+        CompressedAdjacency() = default;
+
+        /**
+         * Builds the adjacency of numVertices vertices from a list of directed edges.
+         *
+         * @param numVertices The number of vertices.
+         * @param edges The directed edges (edge.source -> edge.dest), with weights packed by packWeight.
+         */
+        CompressedAdjacency(size_t numVertices, const std::vector<Edge>& edges);
+
+        /**
+         * Builds an adjacency from already laid out arrays, each vertex's edges sorted with sortByWeight.
+         *
+         * @param offsets numVertices + 1 offsets, vertex v's edges are [offsets[v], offsets[v + 1]).
+         * @param neighbors The destination of each edge.
+         * @param weights The weight of each edge, packed by packWeight.
+         */
+        CompressedAdjacency(std::vector<uint32_t> offsets, std::vector<uint32_t> neighbors, std::vector<uint32_t> weights);
+
+        /**
+         * Returns an adjacency that reads laid out arrays in place (e.g. from a mapped snapshot) instead
+         * of copying them. The arrays must outlive it and be laid out as for the constructor above.
+         *
+         * @param numVertices The number of vertices (offsets has numVertices + 1 entries).
+         * @param numEdges The number of edges (neighbors and weights have numEdges entries).
+         */
+        static CompressedAdjacency borrow(size_t numVertices, size_t numEdges, const uint32_t* offsets,
+                                          const uint32_t* neighbors, const uint32_t* weights);
+
+        /**
+         * Packs a distance into a stored weight: the truncated distance (the edge's weight), shifted left
+         * once, with the low bit set if the distance has a fractional part.
+         *
+         * @param distance The distance between the edge's airports in nautical miles.
+         */
+        static uint32_t packWeight(double distance);
+
+        // Returns the weight (truncated distance) of a packed weight.
+        static int unpackWeight(uint32_t packed) { return static_cast<int>(packed >> 1); }
+
+        /**
+         * Sorts count edges (neighbors[i], weights[i]) by packed weight, then by neighbour.
+         */
+        static void sortByWeight(uint32_t* neighbors, uint32_t* weights, size_t count);
+
+        // Returns the number of vertices.
+        size_t numVertices() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+        // Returns the number of (directed) edges.
+        size_t numEdges() const { return neighbors.size(); }
+
+        // Returns the index of vertex v's first edge.
+        uint32_t begin(size_t v) const { return offsets[v]; }
+
+        // Returns the index one past vertex v's last edge.
+        uint32_t end(size_t v) const { return offsets[v + 1]; }
+
+        // Returns the destination of edge e.
+        uint32_t neighbor(uint32_t e) const { return neighbors[e]; }
+
+        // Returns the weight (distance in nm, truncated) of edge e.
+        uint32_t weight(uint32_t e) const { return weights[e] >> 1; }
+
+        /**
+         * Returns the smallest range (in nm) that includes edge e, i.e. its distance rounded up.
+         * An aircraft with range r can fly edge e iff minRange(e) <= r, and since a vertex's edges are
+         * sorted by weight, every edge after the first one beyond r is beyond r as well.
+         */
+        uint32_t minRange(uint32_t e) const { return (weights[e] >> 1) + (weights[e] & 1); }
+
+        /**
+         * Returns the index one past vertex v's last edge within range, found by binary search, so
+         * [begin(v), rangeEnd(v, range)) are the edges an aircraft with that range can fly from v.
+         */
+        uint32_t rangeEnd(size_t v, uint32_t range) const;
+
+        /**
+         * Appends the edges of this adjacency to out as directed Edge objects (with packed weights),
+         * vertex by vertex, so it can be rebuilt with more edges.
+         */
+        void appendEdges(std::vector<Edge>& out) const;
+
+        // Returns the number of bytes used by the arrays.
+        size_t memoryBytes() const;
+
+        // The raw arrays, for writing them out (see the constructor for their layout).
+        const uint32_t* offsetsData() const { return offsets.data(); }
+        const uint32_t* neighborsData() const { return neighbors.data(); }
+        const uint32_t* weightsData() const { return weights.data(); }
+
+    private:
+        FlatArray<uint32_t> offsets;   // Vertex v's edges are [offsets[v], offsets[v + 1]).
+        FlatArray<uint32_t> neighbors; // Destination vertex of each edge.
+        FlatArray<uint32_t> weights;   // Packed weight (see packWeight) of each edge.
+};
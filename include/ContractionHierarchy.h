@@ -0,0 +1,109 @@
+/**
+ * @file: ContractionHierarchy.h
+ * @author: 0Ykahil
+ *
+ * Declaration of ContractionHierarchy, a preprocessed form of the graph for one range that answers
+ * shortest route queries by searching only upwards in a node order
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+#include "DistanceMatrix.h"
+#include "WorkStealing.h"
+
+/**
+ * @class ContractionHierarchy
+ * Contraction Hierarchies (Geisberger et al.) over the edges of a graph within one range.
+ *
+ * Preprocessing removes the airports one at a time in order of importance. Removing ("contracting") an airport
+ * adds a shortcut between two of its neighbours when the route through it is the only shortest one, so the
+ * distances between the remaining airports never change. A query then runs Dijkstra from both ends using only
+ * edges towards airports contracted later, which settles a few hundred airports instead of the whole continent,
+ * and shortcuts are unpacked back into the flights they stand for.
+ *
+ * Routes minimise (distance, landings) in that order, so among routes of the same distance the one with the
+ * fewest landings is returned.
+ *
+ * Building is parallel: each round picks a set of airports that are not neighbours and are less important than
+ * all of their neighbours, finds their shortcuts on several threads, and then contracts them together.
+ */
+class ContractionHierarchy {
+    public:
+        /**
+         * Builds the hierarchy of the edges of adjacency an aircraft with the given range can fly.
+         *
+         * @param adjacency The graph's adjacency.
+         * @param range The range of the aircraft in nautical miles.
+         * @param numThreads The number of threads used (0 uses every hardware thread).
+         */
+        static ContractionHierarchy build(const CompressedAdjacency& adjacency, uint32_t range, size_t numThreads = 0);
+
+        /**
+         * Returns the shortest route from src to dest in the format of Graph::findShortestPath (vertices from dest
+         * back to src, and the route's total weight), or an empty route if dest cannot be reached. The searches'
+         * working memory is kept by the calling thread for its next query.
+         */
+        std::pair<std::vector<int>, double> findPath(int src, int dest) const;
+
+        /**
+         * Returns the shortest routes from every source to every target (many-to-many with buckets, Knopp et al.).
+         * An upward search from each target leaves its cost at every vertex it settles in that vertex's bucket;
+         * an upward search from each source then scans the buckets of the vertices it settles, where it meets
+         * every target's search. That is one search per source and per target instead of one per pair, and the
+         * searches of each side run in parallel on pool, each worker thread keeping its searches' working memory
+         * for the next matrix.
+         *
+         * @param sources The indices of the source vertices.
+         * @param targets The indices of the target vertices.
+         * @param includePaths If true, the matrix keeps the route of each pair.
+         * @param pool The workers the searches run on (not to be called from one of them).
+         */
+        DistanceMatrix distanceMatrix(const std::vector<int>& sources, const std::vector<int>& targets, bool includePaths,
+                                      WorkStealingPool& pool) const;
+
+        // Returns the range the hierarchy was built for.
+        uint32_t getRange() const { return range; }
+
+        // Returns the number of shortcuts added by contraction.
+        size_t shortcutCount() const { return shortcuts; }
+
+        // Returns the number of bytes used by the hierarchy.
+        size_t memoryBytes() const;
+
+    private:
+        // An edge from a vertex to one contracted after it: a flight, or a shortcut standing for two edges through middle.
+        struct UpwardEdge {
+            uint32_t to;
+            uint32_t middle; // NO_MIDDLE for a flight.
+            uint64_t cost;   // (weight << HOP_BITS) + landings, see ContractionHierarchy.cpp.
+        };
+
+        // A vertex settled by an upward search, with its cost from the root and the vertex before it (NO_MIDDLE at the root).
+        struct Settled {
+            uint32_t vertex;
+            uint32_t prev;
+            uint64_t cost;
+        };
+
+        static constexpr uint32_t NO_MIDDLE = UINT32_MAX;
+
+        /**
+         * Appends the vertices the upward search from root settles without stalling them to settled.
+         * cost and prev are the search's working memory, one entry per vertex; cost must hold only INFINITE_COST
+         * and is left so, while prev keeps the vertex before each vertex reached until the next search.
+         */
+        void searchUpwards(uint32_t root, std::vector<uint64_t>& cost, std::vector<uint32_t>& prev,
+                           std::vector<Settled>& settled) const;
+        const UpwardEdge* findEdge(uint32_t lower, uint32_t higher) const;
+        void unpack(uint32_t from, uint32_t to, std::vector<int>& path) const;
+
+        uint32_t range = 0;
+        size_t shortcuts = 0;
+        std::vector<uint32_t> rank;       // Position of each vertex in the contraction order.
+        std::vector<uint32_t> offsets;    // Vertex v's upward edges are [offsets[v], offsets[v + 1]).
+        std::vector<UpwardEdge> edges;    // The upward edges of every vertex.
+};
@@ -0,0 +1,53 @@
+/**
+ * @file: CoordinateTable.h
+ * @author: 0Ykahil
+ *
+ * Declaration of CoordinateTable, a structure-of-arrays copy of airport coordinates
+ * used by the batched distance kernel.
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "AirportTable.h"
+
+/**
+ * @class CoordinateTable
+ * Stores the coordinates of a list of airports as separate contiguous arrays (one per component)
+ * with the radians and unit sphere position precomputed, so distance tests over many airports can
+ * be done a block at a time without touching the Airport objects or doing any trig.
+ */
+class CoordinateTable {
+    public:
+        std::vector<double> latRad; // Latitudes in radians.
+        std::vector<double> lonRad; // Longitudes in radians.
+        std::vector<double> x;      // Unit sphere x (towards lat 0, lon 0).
+        std::vector<double> y;      // Unit sphere y (towards lat 0, lon 90).
+        std::vector<double> z;      // Unit sphere z (towards the north pole).
+
+        // Constructs an empty table.
+        CoordinateTable() = default;
+
+        // Constructs a table holding the coordinates of the given airports in the same order.
+        explicit CoordinateTable(const std::vector<Airport>& airports);
+
+        // Constructs a table holding the coordinates of the airports of an AirportTable in the same order.
+        explicit CoordinateTable(const AirportTable& airports);
+
+        /**
+         * Appends a coordinate to the table.
+         *
+         * @param lat The latitude (in degrees).
+         * @param lon The longitude (in degrees).
+         */
+        void add(double lat, double lon);
+
+        // Reserves space for n coordinates.
+        void reserve(size_t n);
+
+        // Removes every coordinate.
+        void clear();
+
+        // Returns the number of coordinates in the table.
+        size_t size() const { return x.size(); }
+};
@@ -0,0 +1,54 @@
+/**
+ * @file: DeltaStepping.h
+ * @author: 0Ykahil
+ *
+ * Declaration of DeltaStepping, a parallel search for the shortest distances from one airport to every airport
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+
+/**
+ * @class DeltaStepping
+ * Finds the shortest distance from one airport to every other (one-to-all) on several threads with delta-stepping,
+ * for jobs like coverage maps that need every distance rather than one route.
+ *
+ * Tentative distances are kept in buckets of bucketWidth nm, and the buckets are settled in order. Settling a bucket
+ * relaxes the light edges (no longer than bucketWidth) of every airport in it in parallel, in rounds until no airport
+ * falls back into the bucket; then its airports' heavy edges, which always land in later buckets, are relaxed once.
+ * Threads lower distances with compare-and-swap and keep their own buckets, so the only synchronisation is a
+ * barrier between rounds. The distances are sums of edge weights like Dijkstra's, so they are exactly the same.
+ *
+ * Wide buckets mean fewer rounds but more airports relaxed before their distance is final; narrow buckets approach
+ * Dijkstra with a barrier per airport.
+ *
+ * Its speedup on more threads has not been measured (see the thread sweep of graphBenchmark).
+ */
+class DeltaStepping {
+    public:
+        static constexpr int UNREACHABLE = -1; // The distance of an airport with no route from the source.
+
+        /**
+         * @param adjacency The graph's adjacency; it must outlive the search.
+         * @param bucketWidth The width of a bucket in nm (0 picks one from the range of each search).
+         * @param numThreads The number of threads each search uses (0 uses every hardware thread).
+         */
+        DeltaStepping(const CompressedAdjacency& adjacency, uint32_t bucketWidth = 0, size_t numThreads = 0);
+
+        /**
+         * Returns the shortest distance in nm from source to every vertex, by vertex index (UNREACHABLE where there
+         * is no route), over the edges with minRange <= range.
+         */
+        std::vector<int> distancesFrom(int source, uint32_t range) const;
+
+        // Returns the bucket width searches over range use.
+        uint32_t bucketWidthFor(uint32_t range) const;
+
+    private:
+        const CompressedAdjacency& adjacency;
+        uint32_t bucketWidth;
+        size_t numThreads;
+};
@@ -0,0 +1,56 @@
+/**
+ * @file: DistanceKernel.h
+ * @author: 0Ykahil
+ *
+ * Declaration of the batched distance kernel: tests one point against a block of points
+ * stored as structure-of-arrays unit sphere coordinates (see CoordinateTable).
+ *
+ * Distances are compared as squared chord lengths on the unit sphere, which grow with the great
+ * circle distance, so thresholds can be converted once with chordForDistance() and no trig is
+ * needed per pair. Uses AVX2 when compiled with it (ENABLE_AVX2), SSE2 otherwise, and falls back
+ * to scalar code on other targets.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Returns the chord length on the unit sphere between two points distanceNm apart along the great circle,
+ * padded up very slightly so that comparing against it never rejects a pair that is within distanceNm.
+ *
+ * @param distanceNm The great circle distance in nautical miles.
+ */
+double chordForDistance(double distanceNm);
+
+/**
+ * Tests a point against count points and writes the offsets (0 .. count - 1) of every point whose
+ * squared chord distance to it is <= maxChord2, in increasing order.
+ *
+ * @param xs The x components of the block of points.
+ * @param ys The y components of the block of points.
+ * @param zs The z components of the block of points.
+ * @param count The number of points in the block.
+ * @param q The unit sphere position (x, y, z) of the point being tested.
+ * @param maxChord2 The squared chord threshold.
+ * @param out The offsets of the matching points (must have room for count entries).
+ * @return The number of offsets written to out.
+ */
+size_t chordWithin(const double* xs, const double* ys, const double* zs, size_t count,
+                   const double q[3], double maxChord2, uint32_t* out);
+
+/**
+ * Writes the squared chord distance between a point and each of count points to out.
+ *
+ * @param xs The x components of the block of points.
+ * @param ys The y components of the block of points.
+ * @param zs The z components of the block of points.
+ * @param count The number of points in the block.
+ * @param q The unit sphere position (x, y, z) of the point being tested.
+ * @param out The squared chord distances (must have room for count entries).
+ */
+void chordDistances2(const double* xs, const double* ys, const double* zs, size_t count,
+                     const double q[3], double* out);
+
+// Returns the name of the instruction set the kernel was compiled for ("avx2", "sse2" or "scalar").
+const char* distanceKernelName();
@@ -0,0 +1,63 @@
+/**
+ * @file: DistanceMatrix.h
+ * @author: 0Ykahil
+ *
+ * Declaration of DistanceMatrix, the routes between every source and every target of a many-to-many query
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @class DistanceMatrix
+ * The shortest route (by distance, then landings) from each of a list of sources to each of a list of targets,
+ * stored densely in row-major order (row = source, column = target).
+ */
+class DistanceMatrix {
+    public:
+        static constexpr double UNREACHABLE = -1; // The distance of a pair with no route.
+
+        DistanceMatrix() = default;
+
+        /**
+         * An empty matrix (every pair unreachable) of the given size.
+         *
+         * @param withPaths If true, a path is kept for every pair.
+         */
+        DistanceMatrix(size_t numSources, size_t numTargets, bool withPaths)
+            : sources(numSources), targets(numTargets), distances(numSources * numTargets, UNREACHABLE),
+              hopCounts(numSources * numTargets, -1), paths(withPaths ? numSources * numTargets : 0) {}
+
+        size_t numSources() const { return sources; }
+        size_t numTargets() const { return targets; }
+        bool hasPaths() const { return !paths.empty(); }
+
+        // Returns the distance from source to target in nm, or UNREACHABLE.
+        double distance(size_t source, size_t target) const { return distances[source * targets + target]; }
+
+        // Returns the number of flights from source to target, or -1 if it is unreachable.
+        int hops(size_t source, size_t target) const { return hopCounts[source * targets + target]; }
+
+        /**
+         * Returns the route from source to target in the format of Graph::findShortestPath (vertices from the target
+         * back to the source); empty if it is unreachable or the matrix keeps no paths.
+         */
+        const std::vector<int>& path(size_t source, size_t target) const { return paths[source * targets + target]; }
+
+        // Sets the distance and number of flights of a pair.
+        void set(size_t source, size_t target, double distance, int hops) {
+            distances[source * targets + target] = distance;
+            hopCounts[source * targets + target] = hops;
+        }
+
+        // Returns the path of a pair, to be filled in (only if hasPaths()).
+        std::vector<int>& pathAt(size_t source, size_t target) { return paths[source * targets + target]; }
+
+    private:
+        size_t sources = 0;
+        size_t targets = 0;
+        std::vector<double> distances;
+        std::vector<int> hopCounts;
+        std::vector<std::vector<int>> paths;
+};
@@ -0,0 +1,78 @@
+/**
+ * @file: FlatArray.h
+ * @author: 0Ykahil
+ *
+ * Declaration of FlatArray, a read-only array that either owns its elements
+ * or borrows them from memory owned elsewhere (like a memory-mapped snapshot).
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @class FlatArray
+ * A read-only array of T. It either owns a std::vector<T>, or points at count elements it does not own,
+ * so data loaded from a mapped file can be read in place instead of being copied into a vector.
+ */
+template <typename T>
+class FlatArray {
+    public:
+        // Constructs an empty array.
+        FlatArray() = default;
+
+        // Constructs an array owning values.
+        FlatArray(std::vector<T> values) : owned(std::move(values)), items(owned.data()), count(owned.size()) {}
+
+        /**
+         * Returns an array reading count elements at data, which must outlive it.
+         *
+         * @param data The first element.
+         * @param count The number of elements.
+         */
+        static FlatArray borrow(const T* data, size_t count) {
+            FlatArray array;
+            array.items = data;
+            array.count = count;
+            return array;
+        }
+
+        FlatArray(const FlatArray& other) { *this = other; }
+        FlatArray(FlatArray&& other) noexcept { *this = std::move(other); }
+
+        FlatArray& operator=(const FlatArray& other) {
+            if (this != &other) {
+                owned = other.owned;
+                items = other.isBorrowed() ? other.items : owned.data();
+                count = other.count;
+            }
+            return *this;
+        }
+
+        FlatArray& operator=(FlatArray&& other) noexcept {
+            if (this != &other) {
+                bool borrowed = other.isBorrowed();
+                owned = std::move(other.owned);
+                items = borrowed ? other.items : owned.data();
+                count = other.count;
+                other.owned.clear();
+                other.items = nullptr;
+                other.count = 0;
+            }
+            return *this;
+        }
+
+        const T& operator[](size_t i) const { return items[i]; }
+        const T* data() const { return items; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        // Returns true if the elements are borrowed rather than owned.
+        bool isBorrowed() const { return count != 0 && items != owned.data(); }
+
+    private:
+        std::vector<T> owned;     // The elements, when the array owns them.
+        const T* items = nullptr; // The first element (owned.data() or borrowed memory).
+        size_t count = 0;         // The number of elements.
+};
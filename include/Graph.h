@@ -10,17 +10,39 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <queue>
 #include <limits>
-#include <list>
+#include <atomic>
 #include <utility>
 #include <thread>
 #include <mutex>
+#include <memory>
 #include "utility_functions.h"
 #include "Airport.h"
+#include "AirportTable.h"
 #include "Edge.h"
+#include "CompressedAdjacency.h"
+#include "CoordinateTable.h"
+#include "GraphBuilder.h"
+#include "KdTree.h"
+#include "BidirectionalSearch.h"
+#include "ContractionHierarchy.h"
+#include "LandmarkTable.h"
+#include "SearchContext.h"
+#include "KShortestPaths.h"
+#include "HopConstrainedSearch.h"
+#include "DistanceMatrix.h"
+#include "MinimumRangeTree.h"
+#include "ReachableAirports.h"
+#include "DeltaStepping.h"
+#include "AirportSearchIndex.h"
+#include "RangeCache.h"
+#include "WorkStealing.h"
 #include <nlohmann/json.hpp>
 
+class MappedFile;
+
 typedef std::pair<int, int> iPair;
 
 #define YELLOW "\033[33m"
@@ -30,12 +52,52 @@ typedef std::pair<int, int> iPair;
 #define BOLD    "\033[1m"
 #define RED     "\033[31m"
 
+/**
+ * The search used to find a route.
+ *
+ * FewestLandings: Dijkstra that accepts a slightly longer route if it has fewer landings (the default).
+ * Distance: Dijkstra that always takes the shorter route (findShortestPathMIN).
+ * AStar: the shortest route, found with A* guided by the great-circle distance left to the destination,
+ *        which settles far fewer airports than Dijkstra on long routes.
+ * Bidirectional: the shortest route, found by searching from both ends at once (see BidirectionalSearch).
+ * BidirectionalFewestLandings: the route with the least distance + 50nm per landing, searched from both ends.
+ * ContractionHierarchy: the shortest route (with the fewest landings among equally short ones), found on the
+ *                       contraction hierarchy of the range if one was built with prepareContractionHierarchy
+ *                       (otherwise the Distance search answers, rather than a search waiting minutes for a build).
+ * Landmarks: the shortest route, found with A* guided by landmark distances (ALT, see LandmarkTable), which
+ *            unlike the great-circle distance accounts for the detours a short range forces. The landmarks of
+ *            the range must have been chosen with prepareLandmarks (otherwise AStar answers).
+ */
+enum class RouteAlgorithm {
+    FewestLandings,
+    Distance,
+    AStar,
+    Bidirectional,
+    BidirectionalFewestLandings,
+    ContractionHierarchy,
+    Landmarks
+};
+
+// Returns the algorithm named name ("fewest-landings", "distance", "astar", "bidirectional",
+// "bidirectional-fewest-landings", "ch" or "alt"); false if there is none.
+bool parseRouteAlgorithm(const std::string& name, RouteAlgorithm& algorithm);
+
+// Returns the name of an algorithm, as accepted by parseRouteAlgorithm.
+std::string routeAlgorithmName(RouteAlgorithm algorithm);
+
 /**
  * @class Graph 
  * Represents a Graph of airports represented by an adjacency list of airports.
  */
 class Graph {
     public:
+        // Passed as a range to search every edge of the graph, whatever its length.
+        static constexpr int UNLIMITED_RANGE = std::numeric_limits<int>::max();
+
+        // The most ranges whose contraction hierarchies (and, separately, landmark tables and component labels)
+        // are kept; preparing another drops the least recently used.
+        static constexpr size_t MAX_PREPARED_RANGES = 8;
+
         /**
          * Constructs an empty graph with given numVertices and if it is weighted.
          * 
@@ -58,6 +120,21 @@ class Graph {
          */
         void addEdge(const Airport& source, const Airport& dest);
 
+        /**
+         * Freezes the edges added so far into the graph's compressed (CSR) adjacency, which every query reads.
+         * generateAirportGraph freezes the graph when it is done, and queries freeze any edges added with addEdge since.
+         */
+        void freeze();
+
+        // Returns the number of edges, counting each direction of a flight separately.
+        size_t edgeCount() const;
+
+        // Returns the number of bytes used by the graph's adjacency (frozen and not yet frozen edges).
+        size_t adjacencyMemoryBytes() const;
+
+        // Returns the threshold the graph was generated with (UNLIMITED_RANGE if it was built by hand).
+        int getMaxRange() const;
+
         /**
          * Prints out the graph in the format "Airport n (identifier) -> ..."
          * and displays it in the console.
@@ -74,8 +151,18 @@ class Graph {
          * @param jsonData The JsonData containing airport identifier, name, location, etc. data to be parsed.
          * @param threshold The threshold in nautical miles, where edges will be created if below it (realistic range of aircraft).
          * @param useMultithreading If True, the function will use multithreading when creating the edge list, this is to speed up the generating for dense sets
+         * @param mode Whether to compare all pairs of airports or only the pairs found in neighbouring cells of a SpatialGrid
+         * @param numThreads The number of threads used when useMultithreading is true (0 uses every hardware thread)
          */
-        void generateAirportGraph(const nlohmann::json& jsonData, const int threshold, bool useMultithreading);
+        void generateAirportGraph(const nlohmann::json& jsonData, const int threshold, bool useMultithreading,
+                                  BuildMode mode = BuildMode::AllPairs, size_t numThreads = 0);
+
+        /**
+         * Same as above, generating the graph from the airports of a table (see AirportTable::load)
+         * instead of a parsed JSON dataset.
+         */
+        void generateAirportGraph(const AirportTable& airportTable, const int threshold, bool useMultithreading,
+                                  BuildMode mode = BuildMode::AllPairs, size_t numThreads = 0);
 
         /**
          * Finds the shortest path from start airport to destination airport using a highly modified version of Dijkstra's algorithm
@@ -84,11 +171,165 @@ class Graph {
          * THIS VERSION WILL RECCOMMEND SLIGHTLY LONGER ROUTES WITH LESS LANDINGS IF THEY EXIST
          * @param start The starting Airport
          * @param destination The destination Airport
+         * @param range The range of the aircraft in nautical miles; only edges no longer than it are flown.
+         *              A graph generated at a large threshold answers routes for any range up to it.
+         * @param algorithm The search to use (see RouteAlgorithm); the path has the same format for each.
+         */
+        std::pair <std::vector<int>, double> findShortestPath(const Airport& start, const Airport& destination,
+                                                              int range = UNLIMITED_RANGE,
+                                                              RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings);
+
+        /**
+         * Same as findShortestPath, keeping the search's working memory in context instead of the calling thread's
+         * own context. A thread that answers many routes (or a pool that hands contexts out) keeps one context per
+         * search in flight; the FewestLandings and Distance searches then allocate nothing but the path.
          */
-        std::pair <std::vector<int>, double> findShortestPath(const Airport& start, const Airport& destination);
+        std::pair <std::vector<int>, double> findShortestPath(const Airport& start, const Airport& destination,
+                                                              SearchContext& context, int range = UNLIMITED_RANGE,
+                                                              RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings);
 
         // THIS VERSION DOES THE SAME AS ABOVE, BUT WILL ALWAYS RECOMMEND THE SHORTEST ROUTE WITH A VERY LOW AMOUNT OF LANDINGS
-        std::pair <std::vector<int>, double> findShortestPathMIN(const Airport& start, const Airport& destination);
+        std::pair <std::vector<int>, double> findShortestPathMIN(const Airport& start, const Airport& destination,
+                                                                 int range = UNLIMITED_RANGE);
+
+        /**
+         * Same as findShortestPath, searching forward from start and backward from destination at once (see BidirectionalSearch).
+         *
+         * @param fewestLandings If true, minimises distance + 50nm per landing instead of the distance alone.
+         * @param useTwoThreads If true, the two searches run on two threads.
+         */
+        std::pair <std::vector<int>, double> findShortestPathBidirectional(const Airport& start, const Airport& destination,
+                                                                           int range = UNLIMITED_RANGE, bool fewestLandings = false,
+                                                                           bool useTwoThreads = false);
+
+        /**
+         * Returns the shortest route (by distance) from start airport to destination airport that lands at most
+         * maxStops times on the way, in the format of findShortestPath; empty if there is none (see HopConstrainedSearch).
+         * Unlike the fewest-landings search, the limit is exact.
+         *
+         * @param maxStops The most airports the route may land at between start and destination.
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         */
+        std::pair<std::vector<int>, double> findShortestPathWithStops(const Airport& start, const Airport& destination,
+                                                                      int maxStops, int range = UNLIMITED_RANGE);
+
+        /**
+         * Returns up to k routes from start airport to destination airport that visit no airport twice, shortest
+         * (by distance) first, each in the format of findShortestPath (see KShortestPaths).
+         *
+         * @param start The starting Airport
+         * @param destination The destination Airport
+         * @param k The number of routes; fewer are returned if there are no more.
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         * @param numThreads The number of threads the searches run on (0 uses every hardware thread).
+         */
+        std::vector<std::pair<std::vector<int>, double>> findKShortestPaths(const Airport& start, const Airport& destination,
+                                                                            size_t k, int range = UNLIMITED_RANGE,
+                                                                            size_t numThreads = 0);
+
+        /**
+         * Returns the shortest route (by distance, then landings) from every airport in sourceIDs to every airport
+         * in targetIDs. If the contraction hierarchy of range has already been built (see prepareContractionHierarchy),
+         * it answers the matrix with buckets; otherwise one Dijkstra per source runs until it has settled every
+         * target. Either way the sources are spread over numThreads threads.
+         * Throws std::invalid_argument if an id is not an airport.
+         *
+         * @param sourceIDs The ids of the airports the routes start from (the rows of the matrix).
+         * @param targetIDs The ids of the airports the routes go to (the columns of the matrix).
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         * @param includePaths If true, the matrix keeps the route of each pair, in the format of findShortestPath.
+         * @param numThreads The number of threads used (0 uses every hardware thread).
+         */
+        DistanceMatrix distanceMatrix(const std::vector<std::string>& sourceIDs, const std::vector<std::string>& targetIDs,
+                                      int range = UNLIMITED_RANGE, bool includePaths = false, size_t numThreads = 0);
+
+        // Same as distanceMatrix, running the searches on pool's workers, each with its thread's search context.
+        DistanceMatrix distanceMatrix(const std::vector<std::string>& sourceIDs, const std::vector<std::string>& targetIDs,
+                                      WorkStealingPool& pool, int range = UNLIMITED_RANGE, bool includePaths = false);
+
+        /**
+         * Returns every airport reachable from startID within maxHops flights and maxDistance nm, with the distance
+         * of the shortest route to it within both limits. With only a distance limit it is a Dijkstra that stops
+         * past maxDistance; with a flight limit the search runs in layers of one flight each, relaxing only the
+         * airports (kept in a bitset) whose distance improved in the layer before.
+         * Throws std::invalid_argument if startID is not an airport.
+         *
+         * @param startID The id of the airport the routes start from.
+         * @param maxHops The most flights a route may take (ReachableAirports::NO_LIMIT for any number).
+         * @param maxDistance The longest a route may be in nm (ReachableAirports::NO_LIMIT for any distance).
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         */
+        ReachableAirports reachableAirports(const std::string& startID, int maxHops,
+                                            int maxDistance = ReachableAirports::NO_LIMIT, int range = UNLIMITED_RANGE);
+
+        /**
+         * Returns the shortest distance in nm from startID to every airport, in the order of getAirports()
+         * (DeltaStepping::UNREACHABLE where there is no route). The search is a parallel delta-stepping, and the
+         * distances are exactly those of a Dijkstra from startID.
+         * Throws std::invalid_argument if startID is not an airport.
+         *
+         * @param startID The id of the airport the routes start from.
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         * @param numThreads The number of threads the search uses (0 uses every hardware thread).
+         * @param bucketWidth The width of the search's buckets in nm (0 picks one from the range; see DeltaStepping).
+         */
+        std::vector<int> distancesFrom(const std::string& startID, int range = UNLIMITED_RANGE, size_t numThreads = 0,
+                                       uint32_t bucketWidth = 0);
+
+        /**
+         * Returns the smallest aircraft range (in whole nm) at which any route connects startID to destID, measured
+         * over every pair of airports as generateAirportGraph connects them (so it can exceed the graph's threshold).
+         * Returns -1 if either id is not an airport. O(log n) once the tree is built (see prepareMinimumRangeTree).
+         *
+         * @param startID The id of the starting Airport (e.g. CYYZ, CYOW)
+         * @param destID The id of the destination Airport
+         */
+        int minimumRange(const std::string& startID, const std::string& destID);
+
+        /**
+         * Returns the tree minimumRange answers from, building it first if the airports changed since it was built.
+         * getShortestPath checks it before searching, so a route between airports that no route connects at the
+         * range is rejected in O(log n) without a search, whatever the range. The tree also names the component of
+         * each airport at any range (see MinimumRangeTree::component).
+         */
+        std::shared_ptr<const MinimumRangeTree> prepareMinimumRangeTree();
+
+        /**
+         * Returns the trigram index searchAirportCodeByName answers from, building it first if the airports changed
+         * since it was built.
+         */
+        std::shared_ptr<const AirportSearchIndex> prepareSearchIndex() const;
+
+        // Sets whether the bidirectional algorithms run their two searches on two threads (off by default).
+        void setBidirectionalThreads(bool useTwoThreads);
+
+        /**
+         * Returns the contraction hierarchy used by RouteAlgorithm::ContractionHierarchy for range, building it
+         * first if it has not been built since the graph last changed. Every range long enough for every edge
+         * shares one hierarchy. Routes are only searched on hierarchies built here, and those of other
+         * ranges keep being answered while one is built. At most MAX_PREPARED_RANGES hierarchies are kept.
+         *
+         * @param range The range of the aircraft in nautical miles.
+         * @param numThreads The number of threads the build uses (0 uses every hardware thread).
+         */
+        std::shared_ptr<const ContractionHierarchy> prepareContractionHierarchy(int range = UNLIMITED_RANGE,
+                                                                                size_t numThreads = 0);
+
+        // Returns true if the contraction hierarchy of range has been built (so RouteAlgorithm::ContractionHierarchy uses it).
+        bool hasContractionHierarchy(int range);
+
+        /**
+         * Returns the landmark table used by RouteAlgorithm::Landmarks for range, building it first if it has not
+         * been built since the graph last changed. Every range long enough for every edge shares one table.
+         * Routes are only searched with tables built here, and at most MAX_PREPARED_RANGES tables are kept.
+         *
+         * @param range The range of the aircraft in nautical miles.
+         * @param numThreads The number of threads the build uses (0 uses every hardware thread).
+         */
+        std::shared_ptr<const LandmarkTable> prepareLandmarks(int range = UNLIMITED_RANGE, size_t numThreads = 0);
+
+        // Returns true if the landmark table of range has been built (so RouteAlgorithm::Landmarks uses it).
+        bool hasLandmarks(int range);
         /**
          * Converts startID and destID to their corresponding airports, and 
          * Maps the elements of the resulting array of findShortestPath() on the given ids
@@ -107,8 +348,93 @@ class Graph {
          * @param startID The id of the starting Airport (e.g. CYYZ, CYOW)
          * @param destID The id of the destination Airport
          * @param mode 0 returns airport ids, 1 returns airport names; otherwise defaults to ids
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         * @param algorithm The search to use (see RouteAlgorithm)
+         */
+        std::pair<std::vector<std::string>, double> getShortestPath(const std::string startID, const std::string destID, int mode = 0,
+                                                                    int range = UNLIMITED_RANGE,
+                                                                    RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings);
+
+        // Same as getShortestPath, keeping the search's working memory in context (see findShortestPath).
+        std::pair<std::vector<std::string>, double> getShortestPath(const std::string startID, const std::string destID,
+                                                                    SearchContext& context, int mode = 0,
+                                                                    int range = UNLIMITED_RANGE,
+                                                                    RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings);
+
+        /**
+         * Returns the shortest route from startID to destID that lands at most maxStops times on the way, in the
+         * format of getShortestPath (see findShortestPathWithStops). Returns an empty route if there is none or
+         * either id is not an airport.
+         *
+         * @param startID The id of the starting Airport (e.g. CYYZ, CYOW)
+         * @param destID The id of the destination Airport
+         * @param maxStops The most airports the route may land at between start and destination.
+         * @param mode 0 returns airport ids, 1 returns airport names; otherwise defaults to ids
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         */
+        std::pair<std::vector<std::string>, double> getShortestPathWithStops(const std::string startID, const std::string destID,
+                                                                             int maxStops, int mode = 0,
+                                                                             int range = UNLIMITED_RANGE);
+
+        // Same as getShortestPathWithStops, keeping the search's working memory in context (see findShortestPath).
+        std::pair<std::vector<std::string>, double> getShortestPathWithStops(const std::string startID, const std::string destID,
+                                                                             SearchContext& context, int maxStops,
+                                                                             int mode = 0, int range = UNLIMITED_RANGE);
+
+        /**
+         * Returns the shortest route from startID to destID with at most each number of stops up to maxStops at which
+         * the route gets shorter, fewest stops first, each in the format of getShortestPath: the last is the shortest
+         * route within maxStops (see findShortestPathWithStops). Returns no routes if either id is not an airport.
+         *
+         * @param startID The id of the starting Airport (e.g. CYYZ, CYOW)
+         * @param destID The id of the destination Airport
+         * @param maxStops The most airports a route may land at between start and destination.
+         * @param mode 0 returns airport ids, 1 returns airport names; otherwise defaults to ids
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         */
+        std::vector<std::pair<std::vector<std::string>, double>> getShortestPathsByStops(const std::string startID,
+                                                                                         const std::string destID, int maxStops,
+                                                                                         int mode = 0, int range = UNLIMITED_RANGE);
+
+        /**
+         * Returns up to k routes from startID to destID, shortest first, each in the format of getShortestPath.
+         * Returns no routes if either id is not an airport.
+         *
+         * @param startID The id of the starting Airport (e.g. CYYZ, CYOW)
+         * @param destID The id of the destination Airport
+         * @param k The number of routes (see findKShortestPaths)
+         * @param mode 0 returns airport ids, 1 returns airport names; otherwise defaults to ids
+         * @param range The range of the aircraft in nautical miles (see findShortestPath)
+         * @param numThreads The number of threads the searches run on (0 uses every hardware thread).
+         */
+        std::vector<std::pair<std::vector<std::string>, double>> getKShortestPaths(const std::string startID,
+                                                                                   const std::string destID, size_t k,
+                                                                                   int mode = 0, int range = UNLIMITED_RANGE,
+                                                                                   size_t numThreads = 0);
+
+        // Same as getKShortestPaths, running the searches on pool's workers rather than threads of their own.
+        std::vector<std::pair<std::vector<std::string>, double>> getKShortestPaths(const std::string startID,
+                                                                                   const std::string destID, size_t k,
+                                                                                   WorkStealingPool& pool, int mode = 0,
+                                                                                   int range = UNLIMITED_RANGE);
+
+        /**
+         * Writes the graph (airports, an index of their ids and the adjacency) to a binary snapshot file
+         * that loadSnapshot can map. See GraphSnapshot.h for the layout.
+         * Throws std::runtime_error if the file cannot be written.
+         *
+         * @param filename The path of the snapshot file.
          */
-        std::pair<std::vector<std::string>, double> getShortestPath(const std::string startID, const std::string destID, int mode = 0);
+        void saveSnapshot(const std::string& filename);
+
+        /**
+         * Replaces the graph with the one in a snapshot written by saveSnapshot. The file is memory-mapped and
+         * queries read the adjacency straight from the mapped pages, so nothing is parsed or rebuilt.
+         * Throws std::runtime_error if the file is missing, truncated, or from another snapshot version.
+         *
+         * @param filename The path of the snapshot file.
+         */
+        void loadSnapshot(const std::string& filename);
 
         // Creates a dot diagram to be used with graphviz for visualizing the graphs
         void toDOT(const std::string& filename) const;
@@ -116,6 +442,15 @@ class Graph {
         // Returns the list containing the airport objects
         std::vector<Airport> getAirports() const;
 
+        /**
+         * Returns the graph's airports without copying them. Vertex i of the graph is airport i of the table,
+         * so the indices returned by findShortestPath index it directly.
+         */
+        const AirportTable& getAirportTable() const;
+
+        // Returns the vertex index of the airport with the given code, or -1 if it is not in the graph
+        int getAirportIndex(const std::string& code) const;
+
         // returns true if airport code is valid (in the airport graph); false otherwise
         bool isValidAirport(const std::string& code) const;
 
@@ -132,19 +467,93 @@ class Graph {
         /**
          * Takes a substring of an airport's name (e.g. Ottawa inter)
          * and returns the list of the airports containing the phrase in the form of a string (ICAO : Name)
+         * Case is ignored, and the airports are found with the trigram index (see prepareSearchIndex).
          * 
          * @param substr The substring of the airport name
          */
         std::vector<std::string> searchAirportCodeByName(const std::string substr) const;
 
+        /**
+         * Returns the k airports closest to a position along with their distance in nautical miles, closest first.
+         * Uses the graph's spatial index (built once with the graph) instead of scanning every airport.
+         *
+         * @param lat The latitude of the position (in degrees).
+         * @param lon The longitude of the position (in degrees).
+         * @param k The number of airports to return.
+         */
+        std::vector<std::pair<Airport, double>> nearestAirports(double lat, double lon, size_t k) const;
+
+        /**
+         * Returns every airport within radiusNm of a position along with its distance in nautical miles, closest first.
+         *
+         * @param lat The latitude of the position (in degrees).
+         * @param lon The longitude of the position (in degrees).
+         * @param radiusNm The search radius in nautical miles.
+         */
+        std::vector<std::pair<Airport, double>> airportsWithinRadius(double lat, double lon, double radiusNm) const;
+
 
     private:
         std::vector<int> reconstructPath(int last, const std::vector<int>& prev) const;
-        std::pair<std::vector<int>, double> findShortestPathImpl(const Airport& start, const Airport& destination, bool minimizeHops);
+        void ensureFrozen();
+        std::vector<std::vector<std::pair<size_t, int>>> edgesForPrinting() const;
+        std::pair<std::vector<int>, double> findRoute(int srcIdx, int destIdx, int range, RouteAlgorithm algorithm,
+                                                      SearchContext& context);
+        std::pair<std::vector<int>, double> findShortestPathImpl(int srcIdx, int destIdx, bool minimizeHops, int range);
+        std::pair<std::vector<int>, double> findShortestPathImpl(int srcIdx, int destIdx, bool minimizeHops, int range,
+                                                                 SearchContext& context);
+        static SearchContext& threadSearchContext(); // The calling thread's context, used when none is passed
+        std::pair<std::vector<int>, double> findShortestPathAStar(int srcIdx, int destIdx, int range, SearchContext& context);
+        std::pair<std::vector<int>, double> findShortestPathBidirectional(int srcIdx, int destIdx, int range, bool fewestLandings,
+                                                                          bool useTwoThreads);
+        std::pair<std::vector<int>, double> findShortestPathCH(int srcIdx, int destIdx, int range, SearchContext& context);
+        std::pair<std::vector<int>, double> findShortestPathLandmarks(int srcIdx, int destIdx, int range, SearchContext& context);
+        std::pair<std::vector<int>, double> findShortestPathWithStops(int srcIdx, int destIdx, int maxStops, int range,
+                                                                      SearchContext& context);
+        std::vector<std::pair<std::vector<int>, double>> findKShortestPaths(int srcIdx, int destIdx, size_t k, int range,
+                                                                            WorkStealingPool& pool);
+        std::shared_ptr<const ContractionHierarchy> builtContractionHierarchy(int range); // null if not built yet
+        int rangeKey(int range) const; // The key of range in the per-range caches
+        bool mayConnect(int startIdx, int destIdx, int range); // false if no route connects them at range
+        std::vector<std::string> pathToStrings(const std::vector<int>& path, int mode) const; // dest-first path to start-first ids or names
+        void computeHeuristicBounds();
+        void clearDerivedData(); // Drops what was computed from the previous adjacency (heuristic bounds, hierarchies, landmarks, ...)
+        const KdTree& getSpatialIndex() const;
+        std::vector<std::pair<Airport, double>> toAirports(const std::vector<KdTree::Result>& found) const;
 
         size_t numVertices; // The current number of vertices in the graph.
-        std::vector<std::list<Edge>> adjList; // the adjacency list containing the edges.
-        std::vector<Airport> vertices; // The vertices (airports) in the graph.
+        int maxRange = UNLIMITED_RANGE; // The threshold the graph was generated with.
+        int everyEdgeRange = 0; // The shortest range that flies every edge of adjacency (at most maxRange unless addEdge added longer ones).
+        CompressedAdjacency adjacency; // the frozen adjacency list (CSR) containing the edges.
+        std::vector<Edge> pendingEdges; // edges added with addEdge since the last freeze, in insertion order (packed weights).
+        std::atomic<bool> frozen{true}; // false while there are vertices or edges that are not in adjacency yet.
+        AirportTable vertices; // The vertices (airports) in the graph, their strings in one arena.
+        CoordinateTable coordinates; // Structure-of-arrays copy of the vertices' coordinates (same order as vertices).
         std::unordered_map<std::string, size_t> airportToIndex; // Maps airport id to an index
-        std::mutex mtx; // Mutex for thread-safe operations
+        mutable std::mutex mtx; // Mutex for thread-safe operations
+        mutable std::unique_ptr<KdTree> spatialIndex; // k-d tree over the vertices' coordinates (rebuilt if vertices are added)
+        mutable std::mutex spatialIndexMutex; // Guards building spatialIndex
+        std::shared_ptr<const MappedFile> snapshotFile; // The snapshot adjacency reads from, if loaded with loadSnapshot
+
+        // The A* heuristic is heuristicScale * (great-circle distance to the destination) - heuristicSlack, which never
+        // overestimates the sum of the truncated edge weights (see computeHeuristicBounds).
+        std::atomic<bool> heuristicBoundsReady{false}; // false until computed for the current adjacency
+        double heuristicScale = 0;
+        double heuristicSlack = 0;
+
+        std::atomic<bool> twoThreadBidirectional{false}; // Whether the bidirectional algorithms use two threads.
+
+        // Contraction hierarchies built for the current adjacency, by rangeKey.
+        RangeCache<ContractionHierarchy> hierarchies{MAX_PREPARED_RANGES};
+
+        // Landmark tables built for the current adjacency, by rangeKey.
+        RangeCache<LandmarkTable> landmarkTables{MAX_PREPARED_RANGES};
+
+        // Built for the current airports, or null. Published and read with std::atomic_load/atomic_store, so the
+        // searches that check it never take a lock once it is built.
+        std::shared_ptr<const MinimumRangeTree> minimumRangeTree;
+        std::mutex minimumRangeTreeMutex; // Held while minimumRangeTree is built, so it is built once
+
+        mutable std::shared_ptr<const AirportSearchIndex> searchIndex; // Built for the current airports, or null
+        mutable std::mutex searchIndexMutex; // Guards searchIndex; held while it is built so it is built once
 };
@@ -0,0 +1,113 @@
+/**
+ * @file: GraphBuilder.h
+ * @author: 0Ykahil
+ *
+ * Declaration of GraphBuilder, which finds the pairs of airports within the threshold
+ * for Graph::generateAirportGraph, optionally on several threads.
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "AirportTable.h"
+#include "CoordinateTable.h"
+#include "CompressedAdjacency.h"
+
+class SpatialGrid;
+
+// How generateAirportGraph finds the pairs of airports within the threshold
+enum class BuildMode {
+    AllPairs,    // compare every airport against every other airport
+    SpatialGrid  // only compare airports in neighbouring cells of a lat/lon grid (same edges, far fewer comparisons)
+};
+
+// An undirected edge found by the builder, u < v
+struct BuiltEdge {
+    uint32_t u;
+    uint32_t v;
+    uint32_t weight; // packed with CompressedAdjacency::packWeight
+};
+
+/**
+ * @class GraphBuilder
+ * Finds every pair of airports i < j whose haversine distance is <= threshold.
+ *
+ * The rows i are split into blocks of roughly equal cost (the triangular number of pairs each row
+ * compares for AllPairs) which workers pull from a work-stealing queue. Each worker appends the edges
+ * it finds to its own buffer, so no locks are taken per edge. Edges are handed back block by block in
+ * row order, which is the same order the single threaded loop finds them in.
+ */
+class GraphBuilder {
+    public:
+        /**
+         * @param airports The airports to connect.
+         * @param coordinates The coordinates of the same airports, in the same order.
+         * @param threshold The maximum distance (in nautical miles) of an edge.
+         * @param mode Whether to compare all pairs or use a SpatialGrid.
+         */
+        GraphBuilder(const AirportTable& airports, const CoordinateTable& coordinates,
+                     int threshold, BuildMode mode);
+        ~GraphBuilder();
+
+        /**
+         * Finds the edges using numThreads workers (1 runs on the calling thread only).
+         *
+         * @param numThreads The number of workers (0 uses every hardware thread).
+         */
+        void run(size_t numThreads);
+
+        // Returns the number of edges found.
+        size_t edgeCount() const;
+
+        /**
+         * Calls visit(edge) for every edge found, in (u, v) order.
+         */
+        template <typename Visit>
+        void forEachEdge(Visit&& visit) const {
+            for (const Segment& segment : segments) {
+                const std::vector<BuiltEdge>& buffer = buffers[segment.worker];
+                for (size_t e = segment.begin; e < segment.end; ++e) {
+                    visit(buffer[e]);
+                }
+            }
+        }
+
+        // Returns the number of blocks the rows were split into (valid after run).
+        size_t blockCount() const { return segments.size(); }
+
+        /**
+         * Calls visit(edge) for every edge found in one block, so blocks can be visited on different threads.
+         */
+        template <typename Visit>
+        void forEachEdgeInBlock(size_t block, Visit&& visit) const {
+            const Segment& segment = segments[block];
+            const std::vector<BuiltEdge>& buffer = buffers[segment.worker];
+            for (size_t e = segment.begin; e < segment.end; ++e) {
+                visit(buffer[e]);
+            }
+        }
+
+    private:
+        // The edges found for one block, stored in a worker's buffer
+        struct Segment {
+            size_t block;
+            size_t worker;
+            size_t begin, end;
+        };
+
+        void planBlocks(size_t numThreads);
+        void buildRow(size_t i, std::vector<BuiltEdge>& out, std::vector<size_t>& candidates,
+                      std::vector<uint32_t>& scratch) const;
+
+        const AirportTable& airports;
+        const CoordinateTable& coordinates;
+        int threshold;
+        BuildMode mode;
+        double maxChord2;                       // Squared chord of the threshold, for the distance kernel.
+        std::unique_ptr<SpatialGrid> grid;      // Only built for BuildMode::SpatialGrid.
+        std::vector<size_t> blockStart;         // Rows [blockStart[b], blockStart[b + 1]) make up block b.
+        std::vector<std::vector<BuiltEdge>> buffers; // One edge buffer per worker.
+        std::vector<Segment> segments;          // Every block's edges, sorted by block.
+};
@@ -0,0 +1,60 @@
+/**
+ * @file: GraphSnapshot.h
+ * @author: 0Ykahil
+ *
+ * On-disk layout of a graph snapshot, written by Graph::saveSnapshot (see buildSnapshot)
+ * and mapped by Graph::loadSnapshot.
+ *
+ * A snapshot is a SnapshotHeader followed by its sections, each starting at an 8 byte aligned offset
+ * recorded in the header. Numbers are stored in the byte order of the machine that wrote the file;
+ * loading a file written with another byte order (or another version) is rejected.
+ */
+#pragma once
+
+#include <cstdint>
+
+// Identifies a graph snapshot file.
+const char SNAPSHOT_MAGIC[8] = {'F', 'P', 'O', 'G', 'R', 'A', 'P', 'H'};
+
+// Bumped whenever the layout changes; snapshots with another version must be rebuilt.
+const uint32_t SNAPSHOT_VERSION = 2;
+
+// Written as-is, reads back differently on a machine with the other byte order.
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// A string in the snapshot's string section.
+struct SnapshotString {
+    uint32_t offset; // Offset from the start of the string section.
+    uint32_t length; // Length in bytes.
+};
+
+// An airport (vertex) record, in vertex order.
+struct SnapshotAirport {
+    SnapshotString id;
+    SnapshotString name;
+    SnapshotString continent;
+    double latitude;
+    double longitude;
+    uint8_t type;        // AirportType
+    uint8_t padding[7];  // Zero.
+};
+
+struct SnapshotHeader {
+    char magic[8];            // SNAPSHOT_MAGIC
+    uint32_t version;         // SNAPSHOT_VERSION
+    uint32_t byteOrder;       // SNAPSHOT_BYTE_ORDER
+    int32_t maxRange;         // The threshold the graph was generated with.
+    uint32_t numAirports;     // The number of vertices.
+    uint64_t numEdges;        // The number of directed edges.
+    uint64_t airportsOffset;  // SnapshotAirport[numAirports]
+    uint64_t idIndexOffset;   // uint32_t[numAirports], the vertices ordered by airport id
+    uint64_t offsetsOffset;   // uint32_t[numAirports + 1], CompressedAdjacency offsets
+    uint64_t neighborsOffset; // uint32_t[numEdges], CompressedAdjacency neighbours
+    uint64_t weightsOffset;   // uint32_t[numEdges], CompressedAdjacency packed weights
+    uint64_t stringsOffset;   // char[stringsSize]
+    uint64_t stringsSize;     // The size of the string section.
+    uint64_t fileSize;        // The size of the whole file, to detect truncated files.
+};
+
+static_assert(sizeof(SnapshotAirport) == 48, "SnapshotAirport must have no padding");
+static_assert(sizeof(SnapshotHeader) == 96, "SnapshotHeader must have no padding");
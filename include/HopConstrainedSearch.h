@@ -0,0 +1,79 @@
+/**
+ * @file: HopConstrainedSearch.h
+ * @author: 0Ykahil
+ *
+ * Declaration of HopConstrainedSearch, which finds the shortest route between two airports with at most N flights
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+#include "SearchContext.h"
+
+/**
+ * @class HopConstrainedSearch
+ * Finds the exact shortest route from one airport to another with at most a given number of flights (e.g. a crew
+ * duty limit on landings), which neither the fewest-landings search nor a plain shortest route guarantees.
+ *
+ * The search runs in layers, layer k holding one label (distance, parent label) per airport reached with exactly
+ * k flights. A label is only kept if it is shorter than every label of the airport in earlier layers: a label with
+ * more flights and no less distance is dominated, as every route it leads to is matched by one with fewer flights.
+ * Layer k is built from layer k - 1 alone, so one pass finds the shortest route for every limit up to the largest.
+ *
+ * Two searches from the destination bound the layers: a breadth-first search gives the fewest flights from each
+ * airport to it, dropping labels that cannot arrive within the limit, and a Dijkstra gives each airport's distance
+ * to it, dropping labels that cannot beat the shortest route found so far.
+ *
+ * The Dijkstra runs on the caller's SearchContext, and the per-airport state of the other searches is kept by the
+ * calling thread between searches, stamped with a generation like the context's, so a search costs the airports it
+ * reaches rather than the size of the graph.
+ */
+class HopConstrainedSearch {
+    public:
+        /**
+         * @param adjacency The graph's adjacency; it must outlive the search.
+         * @param context The working memory of the Dijkstra from the destination; it must outlive the search.
+         */
+        HopConstrainedSearch(const CompressedAdjacency& adjacency, SearchContext& context);
+
+        /**
+         * Returns the shortest route from src to dest with at most maxFlights flights in the format of
+         * Graph::findShortestPath (vertices from dest back to src, and the route's total weight); empty if there is
+         * none. A route from an airport to itself is {{src}, 0}, which takes no flights. If the route the Dijkstra
+         * from dest finds to src is within the limit, it is returned without layers.
+         *
+         * @param src The index of the starting vertex.
+         * @param dest The index of the destination vertex.
+         * @param maxFlights The most flights a route may take.
+         * @param range The range of the aircraft; only edges with minRange <= range are flown.
+         */
+        std::pair<std::vector<int>, double> findPath(int src, int dest, int maxFlights, uint32_t range);
+
+        /**
+         * Returns the shortest routes from src to dest with at most maxFlights flights, one for each number of
+         * flights at which the route gets shorter, fewest flights first: the last is as short as findPath's.
+         * Each is in the format of findPath. Empty if dest cannot be reached within the limit; only {{src}, 0} if
+         * dest is src.
+         */
+        std::vector<std::pair<std::vector<int>, double>> findPaths(int src, int dest, int maxFlights, uint32_t range);
+
+    private:
+        struct Workspace; // The per-airport state of the breadth-first search and the layers.
+
+        // Returns the calling thread's workspace.
+        static Workspace& threadWorkspace();
+
+        // Runs the two searches from dest. Returns false if src is more than maxFlights flights from dest.
+        bool boundFromDestination(int src, int dest, int maxFlights, uint32_t range);
+
+        // The layered search, after boundFromDestination (see findPaths).
+        std::vector<std::pair<std::vector<int>, double>> searchLayers(int src, int dest, int maxFlights, uint32_t range);
+
+        const CompressedAdjacency& adjacency;
+        SearchContext& context; // The Dijkstra from dest; its dist is the distance to dest of what it settled.
+        Workspace& work;        // The calling thread's workspace.
+        int srcToDest = 0;      // The distance from src to dest, and a lower bound for what the Dijkstra left.
+};
@@ -0,0 +1,58 @@
+/**
+ * @file: KShortestPaths.h
+ * @author: 0Ykahil
+ *
+ * Declaration of KShortestPaths, which finds the K shortest distinct routes between two airports (Yen's algorithm)
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+#include "SearchContext.h"
+#include "WorkStealing.h"
+
+/**
+ * @class KShortestPaths
+ * Finds the K shortest routes from one airport to another that visit no airport twice, shortest first (Yen).
+ *
+ * Each route after the first leaves the previous one at some airport (its spur): it follows the previous route
+ * up to the spur, then takes the shortest path to the destination that avoids the airports before the spur and
+ * the next flight of every route found so far that shares that same start. The searches from each spur of a
+ * route are independent, so they run in parallel on a WorkStealingPool, each worker thread keeping one
+ * SearchContext for all its searches, from one search to the next.
+ * Only the spurs at or after the one a route left its own predecessor at are searched (Lawler), as the routes
+ * through earlier spurs were already found from the predecessor.
+ *
+ * A search from the destination first gives every airport's distance to it. What a spur search avoids only makes
+ * routes longer, so these distances guide each spur search as an A* bound, exact wherever the shortest route
+ * avoids nothing; most spur searches settle little more than the route they return.
+ *
+ * Routes are costed by distance alone, so the first route is the shortest one.
+ */
+class KShortestPaths {
+    public:
+        /**
+         * @param adjacency The graph's adjacency; it must outlive the search.
+         * @param pool The workers the spur searches run on; it must outlive the search, and the search must not run
+         *             on one of its workers.
+         */
+        KShortestPaths(const CompressedAdjacency& adjacency, WorkStealingPool& pool) : adjacency(adjacency), pool(pool) {}
+
+        /**
+         * Returns up to k routes from src to dest, shortest first, each in the format of Graph::findShortestPath
+         * (vertices from dest back to src, and the route's total weight). Returns fewer if there are no more.
+         *
+         * @param src The index of the starting vertex.
+         * @param dest The index of the destination vertex.
+         * @param k The number of routes.
+         * @param range The range of the aircraft; only edges with minRange <= range are flown.
+         */
+        std::vector<std::pair<std::vector<int>, double>> findPaths(int src, int dest, size_t k, uint32_t range);
+
+    private:
+        const CompressedAdjacency& adjacency;
+        WorkStealingPool& pool;
+};
@@ -0,0 +1,76 @@
+/**
+ * @file: KdTree.h
+ * @author: 0Ykahil
+ *
+ * Declaration of KdTree, a spatial index over airport coordinates used for
+ * nearest airport and radius queries.
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "AirportTable.h"
+#include "CoordinateTable.h"
+
+/**
+ * @class KdTree
+ * A 3-d tree over the airports' positions on the unit sphere. Straight line (chord) distance
+ * between two points on the sphere grows with their great circle distance, so nearest neighbours
+ * in 3-d are nearest neighbours on the globe, with no special cases at the poles or antimeridian.
+ */
+class KdTree {
+    public:
+        // An airport index in the vector the tree was built from, and its distance in nautical miles
+        typedef std::pair<size_t, double> Result;
+
+        /**
+         * Builds the tree over the given airports.
+         *
+         * @param airports The airports to index, referenced by their index in this table.
+         * @param coordinates The coordinates of the same airports, in the same order.
+         */
+        KdTree(const AirportTable& airports, const CoordinateTable& coordinates);
+
+        /**
+         * Returns the k airports closest to the given position, closest first.
+         *
+         * @param lat The latitude of the position (in degrees).
+         * @param lon The longitude of the position (in degrees).
+         * @param k The number of airports to return (fewer if the tree is smaller).
+         */
+        std::vector<Result> nearest(double lat, double lon, size_t k) const;
+
+        /**
+         * Returns every airport within radiusNm of the given position, closest first.
+         *
+         * @param lat The latitude of the position (in degrees).
+         * @param lon The longitude of the position (in degrees).
+         * @param radiusNm The search radius in nautical miles.
+         */
+        std::vector<Result> withinRadius(double lat, double lon, double radiusNm) const;
+
+        // Returns the number of airports in the tree
+        size_t size() const { return order.size(); }
+
+    private:
+        struct Node {
+            uint32_t begin, end; // range of points in order[] under this node
+            uint32_t left, right; // child nodes (0 for a leaf)
+            int axis;            // axis the node is split on (0 = x, 1 = y, 2 = z)
+            double split;        // coordinate of the splitting plane
+        };
+
+        uint32_t build(uint32_t begin, uint32_t end, const CoordinateTable& coordinates);
+        void nearestImpl(uint32_t node, const double q[3], size_t k,
+                         std::vector<std::pair<double, uint32_t>>& heap) const;
+        void radiusImpl(uint32_t node, const double q[3], double maxChord2,
+                        std::vector<std::pair<double, uint32_t>>& out) const;
+        std::vector<Result> toResults(std::vector<std::pair<double, uint32_t>>& found, double lat, double lon) const;
+
+        const AirportTable& airports; // The airports being indexed.
+        std::vector<uint32_t> order;          // Airport indices, permuted so every node owns a contiguous range.
+        std::vector<double> xs, ys, zs;       // Unit sphere coordinates of order[i], so a leaf is one block for the distance kernel.
+        std::vector<Node> nodes;              // Tree nodes, nodes[0] is the root.
+};
@@ -0,0 +1,91 @@
+/**
+ * @file: LandmarkTable.h
+ * @author: 0Ykahil
+ *
+ * Declaration of LandmarkTable, the distances from a few landmark airports used as A* lower bounds (ALT)
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "CompressedAdjacency.h"
+
+/**
+ * How landmarks are chosen.
+ *
+ * Farthest: each landmark is the airport farthest (by route) from the ones already chosen.
+ * Avoid: each landmark is the end of the branch of a shortest path tree whose airports the chosen landmarks
+ *        bound worst (Goldberg and Werneck), so new landmarks cover the regions the others miss.
+ */
+enum class LandmarkSelection {
+    Farthest,
+    Avoid
+};
+
+/**
+ * @class LandmarkTable
+ * The route distance from each of K landmark airports to every airport, for the edges within one range.
+ *
+ * By the triangle inequality the distance from v to t is at least |d(L, t) - d(L, v)| for any landmark L
+ * (flights go both ways, so one table serves both directions). Unlike the great-circle distance, this bound
+ * knows about the detours a short range forces around oceans and empty regions, so an A* guided by it
+ * heads for the gap the route must take instead of filling the coastline first.
+ *
+ * Each part of the network that the range cannot connect to the others (e.g. a continent) gets landmarks in
+ * proportion to its size, since a landmark bounds nothing outside its own part.
+ *
+ * Only the distances are stored, vertex by vertex (the K distances of an airport share a cache line);
+ * searches run on the graph's own adjacency.
+ */
+class LandmarkTable {
+    public:
+        static constexpr uint32_t UNREACHED = UINT32_MAX;
+        static constexpr size_t DEFAULT_LANDMARKS = 16;
+
+        /**
+         * Chooses landmarks and computes their distances over the edges of adjacency within range.
+         * The one-to-all searches of each round of landmarks run in parallel.
+         *
+         * @param adjacency The graph's adjacency.
+         * @param range The range of the aircraft in nautical miles.
+         * @param numLandmarks The number of landmarks (at most the number of airports).
+         * @param selection How landmarks are chosen (see LandmarkSelection).
+         * @param numThreads The number of threads used (0 uses every hardware thread).
+         */
+        static LandmarkTable build(const CompressedAdjacency& adjacency, uint32_t range,
+                                   size_t numLandmarks = DEFAULT_LANDMARKS,
+                                   LandmarkSelection selection = LandmarkSelection::Avoid, size_t numThreads = 0);
+
+        // Returns the number of landmarks.
+        size_t numLandmarks() const { return landmarks.size(); }
+
+        // Returns the vertex of each landmark.
+        const std::vector<uint32_t>& getLandmarks() const { return landmarks; }
+
+        // Returns the distance from landmark to v (UNREACHED if there is no route).
+        uint32_t distance(size_t landmark, size_t v) const { return distances[v * landmarks.size() + landmark]; }
+
+        /**
+         * Returns the indices of the count landmarks giving the best lower bound from src to dest; a search
+         * only needs these, as the bound of the others is rarely better along the way.
+         */
+        std::vector<uint32_t> bestLandmarks(int src, int dest, size_t count) const;
+
+        /**
+         * Returns a lower bound on the distance from u to v using the given landmarks.
+         * Returns UNREACHED if a landmark proves there is no route between them.
+         */
+        uint32_t lowerBound(int u, int v, const std::vector<uint32_t>& active) const;
+
+        // Returns the range the table was built for.
+        uint32_t getRange() const { return range; }
+
+        // Returns the number of bytes used by the table.
+        size_t memoryBytes() const;
+
+    private:
+        uint32_t range = 0;
+        std::vector<uint32_t> landmarks;
+        std::vector<uint32_t> distances; // distances[v * numLandmarks() + landmark]
+};
@@ -0,0 +1,43 @@
+/**
+ * @file: MappedFile.h
+ * @author: 0Ykahil
+ *
+ * Declaration of MappedFile, a read-only view of a whole file
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @class MappedFile
+ * Maps a file read-only into memory with mmap, so its pages are only read from disk when touched
+ * and are shared between processes mapping the same file. On platforms without mmap the file is
+ * read into a buffer instead.
+ */
+class MappedFile {
+    public:
+        /**
+         * Maps the file. Throws std::runtime_error if it cannot be opened or mapped.
+         *
+         * @param filename The path of the file.
+         */
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns the first byte of the file.
+        const char* data() const { return bytes; }
+
+        // Returns the size of the file in bytes.
+        size_t size() const { return length; }
+
+    private:
+        const char* bytes = nullptr; // The file's contents.
+        size_t length = 0;           // The size of the file.
+        bool mapped = false;         // True if bytes was mapped (and must be unmapped).
+        std::vector<char> buffer;    // The file's contents when it could not be mapped.
+};
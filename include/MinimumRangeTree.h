@@ -0,0 +1,67 @@
+/**
+ * @file: MinimumRangeTree.h
+ * @author: 0Ykahil
+ *
+ * Declaration of MinimumRangeTree, which answers the smallest aircraft range that connects two airports
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "AirportTable.h"
+#include "CoordinateTable.h"
+
+/**
+ * @class MinimumRangeTree
+ * The smallest range at which two airports are connected by some route, for every pair.
+ *
+ * A route can be flown with range r iff its longest flight is at most r, so the answer is the longest flight of
+ * the route whose longest flight is shortest (the minimax route). Those routes all lie in a minimum spanning tree
+ * of the complete graph of distances between airports, which is built once with Prim's algorithm (O(n^2), using
+ * the batched distance kernel).
+ *
+ * The spanning tree's flights are then merged shortest first (Kruskal) into a reconstruction tree: each merge of
+ * two groups of airports becomes a node above both, holding the range of the flight that merged them. Two airports
+ * are first connected at the range of their lowest common ancestor, found in O(log n) by binary lifting. The
+ * airports connected to an airport at a range are those under its highest ancestor whose range is at most that
+ * range, which names their component.
+ */
+class MinimumRangeTree {
+    public:
+        /**
+         * Builds the tree for the airports of a graph.
+         *
+         * @param airports The airports (their distances are measured as generateAirportGraph measures them).
+         * @param coordinates The unit sphere coordinates of the same airports.
+         */
+        static MinimumRangeTree build(const AirportTable& airports, const CoordinateTable& coordinates);
+
+        /**
+         * Returns the smallest range (in whole nm) at which a route connects airports u and v, the first range
+         * findShortestPath finds one at in a graph generated with a threshold at least that large (0 if u == v).
+         */
+        uint32_t minimumRange(size_t u, size_t v) const;
+
+        /**
+         * Returns the component of airport v at range: the node of the tree above every airport a route within range
+         * connects to v, and no other. Two airports have the same component at a range iff they are connected at it.
+         */
+        uint32_t component(size_t v, uint32_t range) const;
+
+        // Returns the number of airports in component c (a node returned by component).
+        uint32_t componentSize(uint32_t c) const { return leaves[c]; }
+
+        // Returns the number of airports.
+        size_t numAirports() const { return numLeaves; }
+
+        // Returns the number of bytes used by the tree.
+        size_t memoryBytes() const;
+
+    private:
+        size_t numLeaves = 0;               // Airports are the leaves 0 .. numLeaves - 1; merges follow them.
+        std::vector<uint32_t> range;        // The range of each node (0 for the airports).
+        std::vector<uint32_t> depth;        // The depth of each node (0 at the root).
+        std::vector<uint32_t> leaves;       // The number of airports under each node.
+        std::vector<std::vector<uint32_t>> ancestors; // ancestors[k][v] is v's 2^k-th ancestor (the root above the root).
+};
@@ -0,0 +1,93 @@
+/**
+ * @file: RangeCache.h
+ * @author: 0Ykahil
+ *
+ * Declaration of RangeCache, the bounded cache of what Graph builds for one aircraft range
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * @class RangeCache
+ * Keeps the structures a graph builds for one aircraft range (contraction hierarchies, landmark tables) for at most
+ * capacity ranges, dropping the least recently used range to make room for another.
+ *
+ * Lookups hold the cache's lock only to find an entry. Builds run outside it, so searches answered from ranges
+ * already built never wait for one; builds take a lock of their own so each range is still built once.
+ */
+template <typename T>
+class RangeCache {
+    public:
+        explicit RangeCache(size_t capacity) : capacity(capacity) {}
+
+        // Returns what was built for range, or null if it has not been built (or has been dropped).
+        std::shared_ptr<const T> find(int range) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto found = entries.find(range);
+            if (found == entries.end()) {
+                return nullptr;
+            }
+            found->second.lastUsed = ++clock;
+            return found->second.value;
+        }
+
+        /**
+         * Returns what was built for range, or builds it with build() first. Searches keep reading the cache while
+         * it is built; another build waits for this one.
+         */
+        template <typename Build>
+        std::shared_ptr<const T> findOrBuild(int range, Build&& build) {
+            if (std::shared_ptr<const T> found = find(range)) {
+                return found;
+            }
+            std::lock_guard<std::mutex> building(buildMtx);
+            // another thread may have built it while this one waited
+            if (std::shared_ptr<const T> found = find(range)) {
+                return found;
+            }
+            std::shared_ptr<const T> value = std::make_shared<const T>(build());
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!entries.empty() && entries.size() >= capacity) {
+                auto oldest = entries.begin();
+                for (auto it = entries.begin(); it != entries.end(); ++it) {
+                    if (it->second.lastUsed < oldest->second.lastUsed) {
+                        oldest = it;
+                    }
+                }
+                entries.erase(oldest);
+            }
+            entries[range] = Entry{value, ++clock};
+            return value;
+        }
+
+        // Drops every range, once any build running has finished (it was built from what the graph had before).
+        void clear() {
+            std::lock_guard<std::mutex> building(buildMtx);
+            std::lock_guard<std::mutex> lock(mtx);
+            entries.clear();
+        }
+
+        // Returns the number of ranges built.
+        size_t size() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return entries.size();
+        }
+
+    private:
+        struct Entry {
+            std::shared_ptr<const T> value;
+            uint64_t lastUsed; // The clock when it was last found or built.
+        };
+
+        const size_t capacity;
+        std::map<int, Entry> entries;
+        uint64_t clock = 0;
+        std::mutex mtx;      // Guards entries and clock; never held during a build.
+        std::mutex buildMtx; // Held while a range is built, so each is built once.
+};
@@ -0,0 +1,54 @@
+/**
+ * @file: ReachableAirports.h
+ * @author: 0Ykahil
+ *
+ * Declaration of ReachableAirports, the airports an aircraft can reach from a base within a number of flights or a distance
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @class ReachableAirports
+ * The airports reachable from a start (not including it), each with the distance of its shortest route within the
+ * limits and the number of flights on that route. They are kept in three parallel arrays ordered by distance, then
+ * flights, so thousands of airports cost three allocations and can be written out column by column.
+ */
+class ReachableAirports {
+    public:
+        static constexpr int NO_LIMIT = std::numeric_limits<int>::max(); // A limit that is not set.
+
+        // Returns the number of airports reached.
+        size_t size() const { return airports.size(); }
+
+        // Returns the index (in the graph) of the i-th airport reached.
+        uint32_t airport(size_t i) const { return airports[i]; }
+
+        // Returns the distance in nm of the shortest route to the i-th airport within the limits.
+        int distance(size_t i) const { return distances[i]; }
+
+        // Returns the number of flights of that route.
+        int hops(size_t i) const { return hopCounts[i]; }
+
+        // Adds an airport; add() them in order.
+        void add(uint32_t airport, int distance, int hops) {
+            airports.push_back(airport);
+            distances.push_back(distance);
+            hopCounts.push_back(hops);
+        }
+
+        // Reserves room for n airports.
+        void reserve(size_t n) {
+            airports.reserve(n);
+            distances.reserve(n);
+            hopCounts.reserve(n);
+        }
+
+    private:
+        std::vector<uint32_t> airports;
+        std::vector<int> distances;
+        std::vector<int> hopCounts;
+};
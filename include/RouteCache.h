@@ -0,0 +1,116 @@
+/**
+ * @file: RouteCache.h
+ * @author: 0Ykahil
+ *
+ * Declaration of RouteCache, a bounded cache of route results shared by the API's workers
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RouteCache
+ * Keeps the results of route searches (in the format of Graph::getShortestPath, including "no route") so popular
+ * pairs are searched once, evicting the least recently used results once they use more than a memory budget.
+ *
+ * The keys are spread over shards, each with its own lock, budget (an equal share) and LRU list, so workers
+ * answering different pairs rarely wait for each other. A miss is registered in its shard before the search runs,
+ * and identical requests that arrive during the search wait on its future instead of searching again
+ * (single-flight). Sizes are estimates of the heap memory of a key and its route.
+ */
+class RouteCache {
+    public:
+        using Route = std::pair<std::vector<std::string>, double>;
+
+        // What a cached route depends on.
+        struct Key {
+            std::string start;
+            std::string dest;
+            int range;
+            int mode;
+            int algorithm; // A RouteAlgorithm, as an int.
+            int maxStops = -1; // The limit on stops of Graph::getShortestPathWithStops, or -1 for none.
+
+            bool operator==(const Key& other) const {
+                return range == other.range && mode == other.mode && algorithm == other.algorithm &&
+                       maxStops == other.maxStops && start == other.start && dest == other.dest;
+            }
+        };
+
+        // The counters of every shard, summed.
+        struct Stats {
+            uint64_t hits = 0;      // Requests answered from a cached result.
+            uint64_t misses = 0;    // Requests that ran a search.
+            uint64_t coalesced = 0; // Requests that waited for an identical request's search instead of running one.
+            uint64_t evictions = 0; // Results dropped to stay within the budget.
+            size_t entries = 0;     // Results cached now.
+            size_t bytes = 0;       // Their estimated size.
+        };
+
+        /**
+         * An empty cache.
+         *
+         * @param budgetBytes The most memory the cached results may use (0 caches nothing, but identical requests
+         *                    still share searches that are running).
+         * @param numShards The number of independently locked shards.
+         */
+        explicit RouteCache(size_t budgetBytes, size_t numShards = 16);
+
+        /**
+         * Returns the route cached for key, or computes, caches and returns it. If the same key is being computed
+         * by another thread, waits for that result instead. If compute throws, nothing is cached and the exception
+         * is rethrown to this caller and every caller waiting on it.
+         */
+        std::shared_ptr<const Route> getOrCompute(const Key& key, const std::function<Route()>& compute);
+
+        // Returns the counters and size of the cache.
+        Stats stats() const;
+
+        // Returns the memory budget in bytes.
+        size_t getBudget() const { return budget; }
+
+        // Drops every cached result (searches still running are cached when they finish).
+        void clear();
+
+    private:
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry {
+            std::shared_future<std::shared_ptr<const Route>> result;
+            std::list<Key>::iterator position; // In the shard's recent list, once ready.
+            size_t bytes = 0;
+            bool ready = false;
+        };
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_map<Key, Entry, KeyHash> entries;
+            std::list<Key> recent; // The ready keys, most recently used first.
+            size_t bytes = 0;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t coalesced = 0;
+            uint64_t evictions = 0;
+        };
+
+        Shard& shardOf(const Key& key) { return shards[KeyHash()(key) % shards.size()]; }
+
+        // Returns the estimated heap memory of a cached route and its key.
+        static size_t entryBytes(const Key& key, const Route& route);
+
+        size_t budget;
+        size_t shardBudget;
+        std::vector<Shard> shards;
+};
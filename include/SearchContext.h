@@ -0,0 +1,88 @@
+/**
+ * @file: SearchContext.h
+ * @author: 0Ykahil
+ *
+ * Declaration of SearchContext, the reusable working memory of a route search
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include "SearchQueues.h"
+
+/**
+ * @class SearchContext
+ * The per-vertex arrays and queue of a Dijkstra search, kept between searches so a thread (e.g. a cpprest
+ * worker) pays for them once instead of allocating and clearing four arrays the size of the graph per route.
+ *
+ * Every vertex entry carries the generation it was written in. reset() starts a new generation, so entries
+ * from earlier searches read as unreached without touching them, and empties the queue without freeing it.
+ * A context grows to the largest graph it is used with and can be shared by graphs, but not by two searches
+ * at once. Searches run on the context's choice of queue (see SearchQueue).
+ */
+class SearchContext {
+    public:
+        explicit SearchContext(SearchQueue queue = SearchQueue::QuaternaryHeap) : queueKind(queue) {}
+
+        // Returns or changes the queue searches run on.
+        SearchQueue getQueue() const { return queueKind; }
+        void setQueue(SearchQueue queue) { queueKind = queue; }
+
+        // Prepares the context for a search over numVertices vertices (O(1) unless the graph is larger than before).
+        void reset(size_t numVertices);
+
+        // The state of v in the current search: INT32_MAX distance and landings, -1 prev and unvisited until set.
+        int dist(int v) const { return isCurrent(v) ? entries[v].dist : INT32_MAX; }
+        int hops(int v) const { return isCurrent(v) ? entries[v].hops : INT32_MAX; }
+        int prev(int v) const { return isCurrent(v) ? entries[v].prev : -1; }
+        bool visited(int v) const { return isCurrent(v) && entries[v].visited; }
+
+        // Sets the distance, landings and previous vertex of v.
+        void reach(int v, int dist, int hops, int prev) {
+            Entry& entry = current(v);
+            entry.dist = dist;
+            entry.hops = hops;
+            entry.prev = prev;
+        }
+
+        // Marks v as visited.
+        void visit(int v) { current(v).visited = true; }
+
+        // The queues of the search; only the one chosen by getQueue() is emptied by reset().
+        BinaryHeapQueue& binaryHeap() { return binary; }
+        QuaternaryHeapQueue& quaternaryHeap() { return quaternary; }
+        RadixHeapQueue& radixHeap() { return radix; }
+
+        // Returns the vertices from last back to the start of the search, following prev.
+        std::vector<int> pathTo(int last) const;
+
+    private:
+        // One vertex's state, together in one 20 byte entry so a relaxation touches one cache line.
+        struct Entry {
+            uint32_t generation;
+            int dist;
+            int hops;
+            int prev;
+            bool visited;
+        };
+
+        bool isCurrent(int v) const { return entries[v].generation == generation; }
+
+        // Returns v's entry, cleared first if it was last written by an earlier search.
+        Entry& current(int v) {
+            Entry& entry = entries[v];
+            if (entry.generation != generation) {
+                entry = Entry{generation, INT32_MAX, INT32_MAX, -1, false};
+            }
+            return entry;
+        }
+
+        std::vector<Entry> entries;
+        uint32_t generation = 0;
+        SearchQueue queueKind;
+        BinaryHeapQueue binary;
+        QuaternaryHeapQueue quaternary;
+        RadixHeapQueue radix;
+};
@@ -0,0 +1,173 @@
+/**
+ * @file: SearchQueues.h
+ * @author: 0Ykahil
+ *
+ * Declaration of the priority queues the route searches can run on
+ */
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+/**
+ * The queue a Dijkstra search keeps its reached vertices in. Every queue pops entries in the same order
+ * (by distance, then vertex, then landings), so the choice changes only the speed, never the route.
+ *
+ * BinaryHeap: a binary heap of every entry pushed; entries made stale by a better one stay until popped.
+ * QuaternaryHeap: a 4-ary heap holding one entry per vertex, lowered in place when a better one is pushed.
+ *                 It never holds stale entries and is shallower than a binary heap.
+ * RadixHeap: buckets by the highest bit in which a distance differs from the last one popped. Pushing is O(1),
+ *            and each entry moves down at most 32 buckets over its life. Only for searches whose pushes are
+ *            never below the last distance popped (true of Dijkstra with non-negative weights).
+ */
+enum class SearchQueue {
+    BinaryHeap,
+    QuaternaryHeap,
+    RadixHeap
+};
+
+// Returns the queue named name ("binary", "4-ary" or "radix"); false if there is none.
+bool parseSearchQueue(const std::string& name, SearchQueue& queue);
+
+// Returns the name of a queue, as accepted by parseSearchQueue.
+std::string searchQueueName(SearchQueue queue);
+
+using QueueEntry = std::tuple<int, int, int>; // (distance, vertex, landings)
+
+// The binary heap (see SearchQueue), ordered as a std::priority_queue with std::greater.
+class BinaryHeapQueue {
+    public:
+        void clear(size_t) { heap.clear(); }
+        bool empty() const { return heap.empty(); }
+
+        void push(int dist, int v, int hops) {
+            heap.emplace_back(dist, v, hops);
+            std::push_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+        }
+
+        QueueEntry pop() {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+            QueueEntry top = heap.back();
+            heap.pop_back();
+            return top;
+        }
+
+    private:
+        std::vector<QueueEntry> heap;
+};
+
+/**
+ * The indexed 4-ary heap (see SearchQueue). A push for a vertex already in the heap keeps the smaller of the
+ * two entries, and a push for a vertex already popped is dropped: a heap of every entry would pop those later
+ * only for the search to skip them.
+ */
+class QuaternaryHeapQueue {
+    public:
+        void clear(size_t numVertices);
+        bool empty() const { return heap.empty(); }
+
+        void push(int dist, int v, int hops) {
+            if (stamp[v] != generation) {
+                stamp[v] = generation;
+                heap.emplace_back(dist, v, hops);
+                siftUp(heap.size() - 1);
+                return;
+            }
+            uint32_t at = position[v];
+            if (at != POPPED && QueueEntry(dist, v, hops) < heap[at]) {
+                heap[at] = QueueEntry(dist, v, hops);
+                siftUp(at);
+            }
+        }
+
+        QueueEntry pop() {
+            QueueEntry top = heap.front();
+            position[std::get<1>(top)] = POPPED;
+            heap.front() = heap.back();
+            heap.pop_back();
+            if (!heap.empty()) {
+                siftDown(0);
+            }
+            return top;
+        }
+
+    private:
+        static constexpr uint32_t POPPED = UINT32_MAX;
+
+        void place(size_t at, const QueueEntry& entry) {
+            heap[at] = entry;
+            position[std::get<1>(entry)] = static_cast<uint32_t>(at);
+        }
+
+        void siftUp(size_t at) {
+            QueueEntry entry = heap[at];
+            while (at > 0 && entry < heap[(at - 1) / 4]) {
+                place(at, heap[(at - 1) / 4]);
+                at = (at - 1) / 4;
+            }
+            place(at, entry);
+        }
+
+        void siftDown(size_t at) {
+            QueueEntry entry = heap[at];
+            while (true) {
+                size_t first = 4 * at + 1;
+                if (first >= heap.size()) {
+                    break;
+                }
+                size_t best = first;
+                for (size_t child = first + 1; child < std::min(first + 4, heap.size()); ++child) {
+                    if (heap[child] < heap[best]) {
+                        best = child;
+                    }
+                }
+                if (!(heap[best] < entry)) {
+                    break;
+                }
+                place(at, heap[best]);
+                at = best;
+            }
+            place(at, entry);
+        }
+
+        std::vector<QueueEntry> heap;
+        std::vector<uint32_t> position; // Index of each vertex's entry in heap, or POPPED.
+        std::vector<uint32_t> stamp;    // The generation in which each vertex was last pushed.
+        uint32_t generation = 0;
+};
+
+/**
+ * The radix heap (see SearchQueue). Bucket 0 holds the entries at the last distance popped, as a binary heap
+ * by (vertex, landings) so that ties pop in the same order as the other queues.
+ */
+class RadixHeapQueue {
+    public:
+        void clear(size_t);
+        bool empty() const { return count == 0; }
+
+        void push(int dist, int v, int hops) {
+            buckets[bucketOf(static_cast<uint32_t>(dist))].emplace_back(dist, v, hops);
+            if (static_cast<uint32_t>(dist) == last) {
+                std::push_heap(buckets[0].begin(), buckets[0].end(), std::greater<QueueEntry>());
+            }
+            ++count;
+        }
+
+        QueueEntry pop();
+
+    private:
+        static constexpr size_t NUM_BUCKETS = 33;
+
+        size_t bucketOf(uint32_t dist) const {
+            return dist == last ? 0 : 32 - __builtin_clz(dist ^ last);
+        }
+
+        std::vector<QueueEntry> buckets[NUM_BUCKETS];
+        uint32_t last = 0;
+        size_t count = 0;
+};
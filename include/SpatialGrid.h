@@ -0,0 +1,59 @@
+/**
+ * @file: SpatialGrid.h
+ * @author: 0Ykahil
+ *
+ * Declaration of SpatialGrid, a latitude/longitude bucketing of airports used to
+ * avoid comparing every pair of airports when generating the graph.
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "CoordinateTable.h"
+
+/**
+ * @class SpatialGrid
+ * Buckets airports into latitude/longitude cells sized to a search radius, so that every
+ * airport within that radius of a given airport is found by only looking at nearby cells.
+ *
+ * Rows near the poles and columns across the antimeridian are handled when querying, and each
+ * cell's coordinates are stored contiguously so they can be filtered with the batched distance
+ * kernel. The candidates returned are always a superset of the airports within the radius.
+ */
+class SpatialGrid {
+    public:
+        /**
+         * Buckets the given airports into cells at least radiusNm wide.
+         *
+         * @param coordinates The coordinates of the airports to bucket, referenced by their index in the table.
+         * @param radiusNm The search radius in nautical miles the grid will be queried with.
+         */
+        SpatialGrid(const CoordinateTable& coordinates, double radiusNm);
+
+        /**
+         * Fills out with the indices of every airport that may be within the radius of airport i,
+         * only keeping indices greater than i, in increasing order.
+         *
+         * @param i The index of the airport being queried.
+         * @param out The vector the candidate indices are written to (cleared first).
+         * @param scratch Scratch space for the distance kernel, kept by the caller so queries don't allocate
+         *                (and so several threads can query the same grid).
+         */
+        void candidatesAfter(size_t i, std::vector<size_t>& out, std::vector<uint32_t>& scratch) const;
+
+    private:
+        size_t rowOf(double lat) const;
+        size_t colOf(double lon) const;
+
+        const CoordinateTable& coordinates; // The coordinates being bucketed.
+        double radius;                      // The search radius as an angle in radians (slightly padded).
+        double maxChord2;                   // The squared chord length of the search radius.
+        size_t numRows;                     // Number of latitude rows.
+        size_t numCols;                     // Number of longitude columns in every row.
+        double rowHeight;                   // Height of a row in radians of latitude.
+        double colWidth;                    // Width of a column in radians of longitude.
+        std::vector<size_t> cellStart;      // Offset of each cell's first airport in cellItems (row major).
+        std::vector<size_t> cellItems;      // Airport indices grouped by cell.
+        std::vector<double> xs, ys, zs;     // Unit sphere coordinates of cellItems[i], for the distance kernel.
+};
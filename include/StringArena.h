@@ -0,0 +1,51 @@
+/**
+ * @file: StringArena.h
+ * @author: 0Ykahil
+ *
+ * Declaration of StringArena, one contiguous buffer holding many strings
+ */
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// A string stored in a StringArena: where it starts in the arena's buffer and its length.
+struct ArenaString {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+/**
+ * @class StringArena
+ * Stores strings back to back in a single buffer and hands out ArenaString offsets to them, so a table
+ * of strings is one allocation instead of one per string (plus the 32 bytes of every std::string).
+ * Offsets stay valid as the arena grows; views returned by view() are valid until the next add.
+ */
+class StringArena {
+    public:
+        // Appends s to the arena and returns its offset.
+        ArenaString add(std::string_view s);
+
+        // Same as add, but returns the earlier copy if the same string was already interned.
+        ArenaString intern(std::string_view s);
+
+        // Returns the string at ref.
+        std::string_view view(ArenaString ref) const { return std::string_view(buffer.data() + ref.offset, ref.length); }
+
+        // Returns the number of bytes used by the strings.
+        size_t size() const { return buffer.size(); }
+
+        // Returns the number of bytes allocated by the arena (its buffer and intern index).
+        size_t memoryBytes() const;
+
+        // Removes every string.
+        void clear();
+
+    private:
+        std::string buffer;                                    // Every string, back to back.
+        std::unordered_multimap<size_t, ArenaString> interned; // Hash of an interned string -> its offset.
+};
@@ -0,0 +1,103 @@
+/**
+ * @file: WorkStealing.h
+ * @author: 0Ykahil
+ *
+ * Declaration of a small work-stealing scheduler used to spread uneven work
+ * (like the rows of the graph build) across threads.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingDeque
+ * A queue of task ids owned by one worker. The owner takes tasks from the front,
+ * other workers steal from the back so they take the work furthest from the owner's.
+ */
+class WorkStealingDeque {
+    public:
+        // Adds a task to the back of the queue.
+        void push(size_t task);
+
+        // Takes the next task from the front (owner side). Returns false if the queue is empty.
+        bool pop(size_t& task);
+
+        // Takes a task from the back (thief side). Returns false if the queue is empty.
+        bool steal(size_t& task);
+
+    private:
+        std::deque<size_t> tasks;
+        std::mutex mtx;
+};
+
+/**
+ * Runs body(task, worker) for every task in [0, numTasks) using numThreads workers.
+ *
+ * Worker w starts with the contiguous run of tasks [w * numTasks / numThreads, (w + 1) * numTasks / numThreads),
+ * so tasks should be sized to roughly equal cost. A worker that runs out steals from the back of
+ * the other workers' queues. The calling thread runs worker 0, and with one thread no threads are started.
+ *
+ * @param numTasks The number of tasks.
+ * @param numThreads The number of workers (0 uses std::thread::hardware_concurrency()).
+ * @param body The function run for each task, given the task id and the id of the worker running it.
+ */
+void runWorkStealing(size_t numTasks, size_t numThreads, const std::function<void(size_t task, size_t worker)>& body);
+
+/**
+ * @class WorkStealingPool
+ * Runs jobs like runWorkStealing on workers started once, rather than starting threads for every job. Worker w is
+ * always the same thread, so state kept per worker (like a search context) is reused from job to job.
+ *
+ * Jobs submitted from several threads run one at a time, in turn; the caller of run waits while the workers run its
+ * job.
+ */
+class WorkStealingPool {
+    public:
+        // @param numThreads The number of workers (0 uses std::thread::hardware_concurrency()).
+        explicit WorkStealingPool(size_t numThreads);
+
+        // Stops the workers, once the job running (if any) has finished.
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        /**
+         * Runs body(task, worker) for every task in [0, numTasks), dealt out and stolen as in runWorkStealing.
+         * If body throws, the tasks not yet started are skipped and the first exception is rethrown here.
+         */
+        void run(size_t numTasks, const std::function<void(size_t task, size_t worker)>& body);
+
+        // Returns the number of workers.
+        size_t size() const { return numThreads; }
+
+    private:
+        // The loop of worker w: waits for a job, runs its share, and reports when it has run out of tasks.
+        void work(size_t worker);
+
+        const size_t numThreads;
+        std::vector<WorkStealingDeque> queues;
+        std::mutex submitMtx; // Held by run for the whole job, so jobs run one at a time.
+        std::mutex mtx;       // Guards the fields below.
+        std::condition_variable started;
+        std::condition_variable finished;
+        const std::function<void(size_t, size_t)>* body = nullptr; // The job's body, null between jobs.
+        uint64_t job = 0;       // The number of jobs submitted.
+        size_t working = 0;     // The workers still running the current job.
+        bool stopping = false;
+        std::exception_ptr error; // The first exception the current job threw.
+        std::atomic<bool> failed{false}; // Whether the current job has thrown, so the workers skip its other tasks.
+        std::vector<std::thread> threads; // Last, so the workers start once the rest has been constructed.
+};
+
+// Returns numThreads, or the number of hardware threads (at least 1) when numThreads is 0.
+size_t resolveThreadCount(size_t numThreads);
@@ -56,6 +56,15 @@ bool isInteger(const std::string& string);
  */
 int toInteger(const std::string& string);
 
+/**
+ * Reads a number from the start of string into out, as std::stod does. Returns false, leaving out unchanged, if
+ * string does not start with a number or the number is not finite (e.g. "nan", "inf" or "1e999").
+ *
+ * @param string The text of the number (e.g. "45.3225").
+ * @param out The number read.
+ */
+bool toFiniteDouble(const std::string& string, double& out);
+
 // Returns true if a file already exists in the director; false otherwise.
 bool fileExists(const std::string& filename);
 
@@ -89,6 +98,15 @@ bool prompt(const std::string& question);
 std::string toUpperCase(std::string str);
 
 
+/**
+ * Returns the shortest text that reads back as the same coordinate (std::to_chars), e.g. "45.3225" or "-90".
+ * The datasets write coordinates this way, so the text of a coordinate read from them is given back unchanged.
+ *
+ * @param degrees The latitude or longitude in degrees
+ */
+std::string formatCoordinate(double degrees);
+
+
 /**
  * Checks config.json for user.range and returns its value. If it does not exist, prompts for user entered aircraft range
  * and returns it if it is valid
@@ -7,10 +7,6 @@
 
 #include "Airport.h"
 
-
-// Earth's radius in nm
-const double EARTH_RADIUS_NM = 3440.065;
-
 // Convert deg to rad
 double toRadians(double deg) {
     return deg * M_PI / 180;
@@ -28,11 +24,27 @@ double haversine(double lat1, double lon1, double lat2, double lon2) {
     return EARTH_RADIUS_NM*2*atan2(sqrt(inside), sqrt(1 - inside));
 }
 
+AirportType parseAirportType(std::string_view name) {
+    if (name == "small_airport") return AirportType::Small;
+    if (name == "medium_airport") return AirportType::Medium;
+    if (name == "large_airport") return AirportType::Large;
+    return AirportType::Unknown;
+}
+
+std::string_view airportTypeName(AirportType type) {
+    switch (type) {
+        case AirportType::Small: return "small_airport";
+        case AirportType::Medium: return "medium_airport";
+        case AirportType::Large: return "large_airport";
+        default: return "unknown";
+    }
+}
+
 Airport::Airport(const std::string& id, const std::string& name, const std::string& t, 
-                double lat, double lon)
-                : id(id), name(name), type(t), latitude(lat), longitude(lon) {}
+                double lat, double lon, const std::string& continent)
+                : id(id), name(name), type(parseAirportType(t)), continent(continent), latitude(lat), longitude(lon) {}
 
-Airport::Airport() : id("CODE"), name("NAME"), type("TYPE"), latitude(-1), longitude(-1) {}
+Airport::Airport() : id("CODE"), name("NAME"), type(AirportType::Unknown), latitude(-1), longitude(-1) {}
 
 
 double Airport::distanceTo(const Airport& other) const {
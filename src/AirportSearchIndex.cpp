@@ -0,0 +1,145 @@
+/**
+ * @file: AirportSearchIndex.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of AirportSearchIndex
+ */
+#include "AirportSearchIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+namespace {
+
+// Returns s in upper case, as toUpperCase does for the airports' ASCII codes and names.
+std::string upper(std::string_view s) {
+    std::string out(s);
+    for (char& c : out) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+// Returns the trigram of s starting at i, its three bytes packed into 24 bits.
+inline uint32_t trigramAt(std::string_view s, size_t i) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(s[i])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(s[i + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(s[i + 2]));
+}
+
+// Appends the trigrams of s to out.
+void appendTrigrams(std::string_view s, std::vector<uint32_t>& out) {
+    for (size_t i = 0; i + 3 <= s.size(); ++i) {
+        out.push_back(trigramAt(s, i));
+    }
+}
+
+}
+
+AirportSearchIndex AirportSearchIndex::build(const AirportTable& airports) {
+    AirportSearchIndex index;
+    const size_t n = airports.size();
+    index.codes.reserve(n);
+    index.names.reserve(n);
+
+    // (trigram, airport) pairs, packed so one sort groups them by trigram with the airports in order
+    std::vector<uint64_t> pairs;
+    std::vector<uint32_t> own;
+    for (size_t i = 0; i < n; ++i) {
+        index.codes.push_back(index.strings.add(upper(airports.id(i))));
+        index.names.push_back(index.strings.add(upper(airports.name(i))));
+
+        // each trigram is posted once per airport, whether it is in the code, the name or both
+        own.clear();
+        appendTrigrams(index.strings.view(index.codes.back()), own);
+        appendTrigrams(index.strings.view(index.names.back()), own);
+        std::sort(own.begin(), own.end());
+        own.erase(std::unique(own.begin(), own.end()), own.end());
+        for (uint32_t trigram : own) {
+            pairs.push_back((static_cast<uint64_t>(trigram) << 32) | i);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    index.postings.reserve(pairs.size());
+    for (uint64_t pair : pairs) {
+        uint32_t trigram = static_cast<uint32_t>(pair >> 32);
+        if (index.trigrams.empty() || index.trigrams.back() != trigram) {
+            index.trigrams.push_back(trigram);
+            index.offsets.push_back(static_cast<uint32_t>(index.postings.size()));
+        }
+        index.postings.push_back(static_cast<uint32_t>(pair));
+    }
+    index.offsets.push_back(static_cast<uint32_t>(index.postings.size()));
+    return index;
+}
+
+bool AirportSearchIndex::matches(size_t i, std::string_view upperText, bool includeCodes) const {
+    return name(i).find(upperText) != std::string_view::npos ||
+           (includeCodes && code(i).find(upperText) != std::string_view::npos);
+}
+
+std::vector<uint32_t> AirportSearchIndex::search(std::string_view text, bool includeCodes) const {
+    std::string upperText = upper(text);
+    std::vector<uint32_t> result;
+
+    // too short to have a trigram: check every airport, without uppercasing anything
+    if (upperText.size() < 3) {
+        for (size_t i = 0; i < size(); ++i) {
+            if (matches(i, upperText, includeCodes)) {
+                result.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return result;
+    }
+
+    // the posting list of each of the text's trigrams; a trigram no airport has means no airport matches
+    std::vector<std::pair<uint32_t, uint32_t>> lists;
+    std::vector<uint32_t> queryTrigrams;
+    appendTrigrams(upperText, queryTrigrams);
+    std::sort(queryTrigrams.begin(), queryTrigrams.end());
+    queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()), queryTrigrams.end());
+    for (uint32_t trigram : queryTrigrams) {
+        auto found = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+        if (found == trigrams.end() || *found != trigram) {
+            return result;
+        }
+        size_t k = found - trigrams.begin();
+        lists.push_back({offsets[k], offsets[k + 1]});
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) {
+        return a.second - a.first < b.second - b.first;
+    });
+
+    // intersect, starting from the shortest list so the candidates only shrink; the longer lists are searched
+    // forward from where the previous candidate was found
+    std::vector<uint32_t> candidates(postings.begin() + lists[0].first, postings.begin() + lists[0].second);
+    for (size_t l = 1; l < lists.size() && !candidates.empty(); ++l) {
+        auto position = postings.begin() + lists[l].first;
+        auto last = postings.begin() + lists[l].second;
+        size_t kept = 0;
+        for (uint32_t airport : candidates) {
+            position = std::lower_bound(position, last, airport);
+            if (position == last) {
+                break;
+            }
+            if (*position == airport) {
+                candidates[kept++] = airport;
+            }
+        }
+        candidates.resize(kept);
+    }
+
+    // having every trigram does not mean having them in a row (or in the same string)
+    for (uint32_t airport : candidates) {
+        if (matches(airport, upperText, includeCodes)) {
+            result.push_back(airport);
+        }
+    }
+    return result;
+}
+
+size_t AirportSearchIndex::memoryBytes() const {
+    return strings.memoryBytes() + (codes.capacity() + names.capacity()) * sizeof(ArenaString) +
+           (trigrams.capacity() + offsets.capacity() + postings.capacity()) * sizeof(uint32_t);
+}
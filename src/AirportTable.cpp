@@ -0,0 +1,204 @@
+/**
+ * @file: AirportTable.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of AirportTable
+ */
+#include "AirportTable.h"
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * SAX handler that fills a table from a JSON array of airport objects. Only the fields of the
+ * objects directly inside the array are kept; anything nested deeper is skipped.
+ */
+class AirportTableSax {
+    public:
+        explicit AirportTableSax(AirportTable& table) : table(table) {}
+
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number_integer(nlohmann::json::number_integer_t value) { return number(static_cast<double>(value)); }
+        bool number_unsigned(nlohmann::json::number_unsigned_t value) { return number(static_cast<double>(value)); }
+        bool number_float(nlohmann::json::number_float_t value, const std::string&) { return number(value); }
+        bool binary(nlohmann::json::binary_t&) { return true; }
+
+        bool string(std::string& value) {
+            if (depth != 2) {
+                return true;
+            }
+            if (currentKey == "ident") {
+                id = std::move(value);
+                hasId = true;
+            } else if (currentKey == "name") {
+                name = std::move(value);
+                hasName = true;
+            } else if (currentKey == "type") {
+                type = std::move(value);
+                hasType = true;
+            } else if (currentKey == "continent") {
+                continent = std::move(value);
+            } else if (currentKey == "latitude") {
+                hasLatitude = AirportTable::parseCoordinate(value, latitude) || fail("latitude \"" + value + "\"");
+            } else if (currentKey == "longitude") {
+                hasLongitude = AirportTable::parseCoordinate(value, longitude) || fail("longitude \"" + value + "\"");
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            if (++depth == 1) {
+                fail("expected an array of airports");
+            }
+            if (depth == 2) {
+                id.clear();
+                name.clear();
+                type.clear();
+                continent.clear();
+                hasId = hasName = hasType = hasLatitude = hasLongitude = false;
+            }
+            return true;
+        }
+
+        bool end_object() {
+            if (depth-- == 2) {
+                if (!(hasId && hasName && hasType && hasLatitude && hasLongitude)) {
+                    fail("missing ident, name, type, latitude or longitude");
+                }
+                table.add(id, name, parseAirportType(type), continent, latitude, longitude);
+            }
+            return true;
+        }
+
+        bool start_array(std::size_t) {
+            if (++depth == 1) {
+                return true;
+            }
+            return depth > 2 || fail("expected an airport object");
+        }
+
+        bool end_array() {
+            --depth;
+            return true;
+        }
+
+        bool key(std::string& value) {
+            if (depth == 2) {
+                currentKey = std::move(value);
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+            throw std::runtime_error(std::string("Invalid airport dataset: ") + ex.what());
+        }
+
+    private:
+        bool number(double value) {
+            if (depth == 2 && currentKey == "latitude") {
+                latitude = value;
+                hasLatitude = true;
+            } else if (depth == 2 && currentKey == "longitude") {
+                longitude = value;
+                hasLongitude = true;
+            }
+            return true;
+        }
+
+        bool fail(const std::string& reason) {
+            throw std::runtime_error("Invalid airport " + std::to_string(table.size()) + " in dataset: " + reason);
+        }
+
+        AirportTable& table;
+        int depth = 0;
+        std::string currentKey;
+        std::string id, name, type, continent;
+        double latitude = 0, longitude = 0;
+        bool hasId = false, hasName = false, hasType = false, hasLatitude = false, hasLongitude = false;
+};
+
+}
+
+AirportTable AirportTable::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    return load(file);
+}
+
+AirportTable AirportTable::load(std::istream& input) {
+    AirportTable table;
+    AirportTableSax sax(table);
+    nlohmann::json::sax_parse(input, &sax);
+    return table;
+}
+
+AirportTable AirportTable::fromJson(const nlohmann::json& jsonData) {
+    AirportTable table;
+    for (const auto& item : jsonData) {
+        double latitude = 0;
+        double longitude = 0;
+        if (!parseCoordinate(item["latitude"].get<std::string>(), latitude) ||
+            !parseCoordinate(item["longitude"].get<std::string>(), longitude)) {
+            throw std::runtime_error("Invalid coordinates for airport " + item["ident"].get<std::string>());
+        }
+        table.add(item["ident"].get<std::string>(), item["name"].get<std::string>(),
+                  parseAirportType(item["type"].get<std::string>()), item.value("continent", ""), latitude, longitude);
+    }
+    return table;
+}
+
+AirportTable AirportTable::fromAirports(const std::vector<Airport>& airports) {
+    AirportTable table;
+    table.reserve(airports.size());
+    for (const Airport& airport : airports) {
+        table.add(airport);
+    }
+    return table;
+}
+
+bool AirportTable::parseCoordinate(const std::string& text, double& value) {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    while (first != last && (*first == ' ' || *first == '\t')) {
+        ++first;
+    }
+    if (first != last && *first == '+') {
+        ++first;
+    }
+
+    auto [end, error] = std::from_chars(first, last, value);
+    return error == std::errc() && end != first;
+}
+
+void AirportTable::add(std::string_view id, std::string_view name, AirportType type,
+                       std::string_view continent, double latitude, double longitude) {
+    records.push_back({strings.add(id), strings.add(name), strings.intern(continent), type});
+    latitudes.push_back(latitude);
+    longitudes.push_back(longitude);
+}
+
+void AirportTable::add(const Airport& airport) {
+    add(airport.id, airport.name, airport.type, airport.continent, airport.latitude, airport.longitude);
+}
+
+void AirportTable::reserve(size_t n) {
+    records.reserve(n);
+    latitudes.reserve(n);
+    longitudes.reserve(n);
+}
+
+Airport AirportTable::airport(size_t i) const {
+    Airport airport(std::string(id(i)), std::string(name(i)), "", latitude(i), longitude(i), std::string(continent(i)));
+    airport.type = type(i);
+    return airport;
+}
+
+size_t AirportTable::memoryBytes() const {
+    return strings.memoryBytes() + records.capacity() * sizeof(Record) +
+           (latitudes.capacity() + longitudes.capacity()) * sizeof(double);
+}
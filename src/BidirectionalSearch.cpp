@@ -0,0 +1,330 @@
+/**
+ * @file: BidirectionalSearch.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of BidirectionalSearch
+ */
+#include "BidirectionalSearch.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+const int UNREACHED = std::numeric_limits<int>::max();
+
+using Entry = std::pair<int, uint32_t>; // (cost, vertex)
+
+/**
+ * The search keeps its shared state (the costs, smallest keys and best meeting) in plain integers when both
+ * directions run on one thread, and in atomics when they run on two and read each other's state. Atomics keep
+ * the compiler from holding anything in registers across them, so the one thread search avoids them.
+ */
+template <bool Shared>
+using Value = std::conditional_t<Shared, std::atomic<int>, int>;
+template <bool Shared>
+using Stamped = std::conditional_t<Shared, std::atomic<uint64_t>, uint64_t>;
+
+inline int load(const int& value) { return value; }
+inline int load(const std::atomic<int>& value) { return value.load(); }
+inline uint64_t load(const uint64_t& value) { return value; }
+inline uint64_t load(const std::atomic<uint64_t>& value) { return value.load(); }
+inline void store(int& value, int newValue) { value = newValue; }
+inline void store(std::atomic<int>& value, int newValue) { value.store(newValue); }
+inline void store(uint64_t& value, uint64_t newValue) { value = newValue; }
+inline void store(std::atomic<uint64_t>& value, uint64_t newValue) { value.store(newValue); }
+
+/**
+ * One direction of the search. A frontier is kept by its thread between searches, so its arrays are allocated
+ * once rather than per route: each cost carries the generation of the search that wrote it in its top 32 bits,
+ * and costs from earlier generations read as unreached without being cleared (as in SearchContext).
+ */
+template <bool Shared>
+struct Frontier {
+    std::unique_ptr<Stamped<Shared>[]> cost; // Cost of the best route found to each vertex from this end.
+    size_t capacity = 0;                     // The number of vertices cost and prev have room for.
+    uint32_t generation = 0;                 // The generation of the current search.
+    std::vector<int> prev;                   // Previous vertex on that route (-1 for the root).
+    std::vector<Entry> queue;                // A min-heap of reached vertices waiting to be settled (stale entries are skipped).
+    Value<Shared> minKey{};                  // A lower bound on every key in queue (UNREACHED once it is empty).
+
+    // Starts a new search from root over numVertices vertices (O(1) unless the graph is larger than before).
+    void reset(size_t numVertices, uint32_t root) {
+        if (capacity < numVertices) {
+            cost.reset(new Stamped<Shared>[numVertices]);
+            capacity = numVertices;
+            prev.resize(numVertices);
+            generation = 0;
+        }
+        // generation 0 marks entries never written, so a wrapped counter clears them
+        if (generation == 0 || ++generation == 0) {
+            for (size_t v = 0; v < capacity; ++v) {
+                store(cost[v], 0);
+            }
+            generation = 1;
+        }
+        queue.clear();
+        setCost(root, 0);
+        prev[root] = -1;
+        push(0, root);
+        store(minKey, 0);
+    }
+
+    int costOf(uint32_t v) const {
+        uint64_t stamped = load(cost[v]);
+        return static_cast<uint32_t>(stamped >> 32) == generation ? static_cast<int>(static_cast<uint32_t>(stamped)) : UNREACHED;
+    }
+
+    void setCost(uint32_t v, int newCost) {
+        store(cost[v], (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(newCost));
+    }
+
+    void push(int key, uint32_t v) {
+        queue.push_back({key, v});
+        std::push_heap(queue.begin(), queue.end(), std::greater<Entry>());
+    }
+
+    Entry pop() {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Entry>());
+        Entry top = queue.back();
+        queue.pop_back();
+        return top;
+    }
+};
+
+// The frontiers of the calling thread's searches, one pair for each kind of search.
+template <bool Shared>
+struct Frontiers {
+    Frontier<Shared> forward;
+    Frontier<Shared> backward;
+};
+
+template <bool Shared>
+Frontiers<Shared>& threadFrontiers() {
+    thread_local Frontiers<Shared> frontiers;
+    return frontiers;
+}
+
+/**
+ * A thread kept for the backward halves of the two-thread searches of one calling thread, so a search hands its
+ * half to a waiting thread instead of starting one per route.
+ */
+class HelperThread {
+    public:
+        HelperThread() : thread([this] { loop(); }) {}
+
+        ~HelperThread() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stopping = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+
+        // Runs job on the helper thread.
+        void start(std::function<void()> job) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                pending = std::move(job);
+                busy = true;
+            }
+            wake.notify_one();
+        }
+
+        // Waits for the job to finish, and rethrows anything it threw.
+        void wait() {
+            std::unique_lock<std::mutex> lock(mtx);
+            done.wait(lock, [this] { return !busy; });
+            if (error) {
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+        }
+
+    private:
+        void loop() {
+            std::unique_lock<std::mutex> lock(mtx);
+            while (true) {
+                wake.wait(lock, [this] { return stopping || busy; });
+                if (!busy) {
+                    return;
+                }
+                std::function<void()> job = std::move(pending);
+                lock.unlock();
+                try {
+                    job();
+                } catch (...) {
+                    lock.lock();
+                    error = std::current_exception();
+                    lock.unlock();
+                }
+                lock.lock();
+                busy = false;
+                done.notify_one();
+            }
+        }
+
+        std::mutex mtx;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::function<void()> pending;
+        std::exception_ptr error;
+        bool busy = false;
+        bool stopping = false;
+        std::thread thread; // Declared last, so it starts once the rest is constructed.
+};
+
+// The cheapest route found so far, and the edge where its two halves meet.
+template <bool Shared>
+struct Meeting {
+    Meeting() { store(cost, UNREACHED); }
+
+    Value<Shared> cost;
+    std::mutex mtx;
+    int forwardVertex = -1;  // The last vertex of the forward half.
+    int backwardVertex = -1; // The first vertex of the backward half.
+
+    void offer(int routeCost, int forward, int backward) {
+        if (routeCost >= load(cost)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if (routeCost < load(cost)) {
+            store(cost, routeCost);
+            forwardVertex = forward;
+            backwardVertex = backward;
+        }
+    }
+};
+
+// True once no route cheaper than the best meeting can be found (or one direction has run out of vertices).
+template <bool Shared>
+bool finished(const Frontier<Shared>& forward, const Frontier<Shared>& backward, const Meeting<Shared>& best) {
+    int f = load(forward.minKey);
+    int b = load(backward.minKey);
+    return f == UNREACHED || b == UNREACHED || static_cast<int64_t>(f) + b >= load(best.cost);
+}
+
+/**
+ * Settles the next vertex of me, offering the route through each of its edges that reaches the other frontier.
+ * With two threads the costs are sequentially consistent, so of the two searches relaxing the edge between
+ * their frontiers, at least one sees the other's cost.
+ */
+template <bool Shared>
+void settleNext(const CompressedAdjacency& adjacency, uint32_t range, int landingPenalty, Frontier<Shared>& me,
+                const Frontier<Shared>& other, Meeting<Shared>& best, bool isForward) {
+    while (!me.queue.empty()) {
+        auto [key, u] = me.pop();
+        if (key > me.costOf(u)) {
+            continue;
+        }
+
+        for (uint32_t e = adjacency.begin(u), last = adjacency.rangeEnd(u, range); e < last; ++e) {
+            uint32_t v = adjacency.neighbor(e);
+            int nextCost = key + static_cast<int>(adjacency.weight(e)) + landingPenalty;
+
+            int otherCost = other.costOf(v);
+            if (otherCost != UNREACHED) {
+                best.offer(nextCost + otherCost, isForward ? u : v, isForward ? v : u);
+            }
+            if (nextCost < me.costOf(v)) {
+                me.setCost(v, nextCost);
+                me.prev[v] = u;
+                me.push(nextCost, v);
+            }
+        }
+        break;
+    }
+    store(me.minKey, me.queue.empty() ? UNREACHED : me.queue.front().first);
+}
+
+template <bool Shared>
+std::pair<std::vector<int>, double> search(const CompressedAdjacency& adjacency, int src, int dest, uint32_t range,
+                                           int landingPenalty) {
+    size_t numVertices = adjacency.numVertices();
+    Frontiers<Shared>& frontiers = threadFrontiers<Shared>();
+    Frontier<Shared>& forward = frontiers.forward;
+    Frontier<Shared>& backward = frontiers.backward;
+    forward.reset(numVertices, src);
+    backward.reset(numVertices, dest);
+    Meeting<Shared> best;
+
+    if constexpr (!Shared) {
+        // advance whichever frontier has the smaller key, so both grow at the same pace
+        while (!finished(forward, backward, best)) {
+            if (forward.minKey <= backward.minKey) {
+                settleNext(adjacency, range, landingPenalty, forward, backward, best, true);
+            } else {
+                settleNext(adjacency, range, landingPenalty, backward, forward, best, false);
+            }
+        }
+    } else {
+        // each direction settles vertices on its own thread until the sum of the smallest keys reaches the best meeting
+        auto run = [&](Frontier<Shared>& me, const Frontier<Shared>& other, bool isForward) {
+            while (!finished(forward, backward, best)) {
+                settleNext(adjacency, range, landingPenalty, me, other, best, isForward);
+            }
+        };
+        thread_local HelperThread helper;
+        helper.start([&] { run(backward, forward, false); });
+        try {
+            run(forward, backward, true);
+        } catch (...) {
+            // the backward half stops once the forward queue reads as empty
+            store(forward.minKey, UNREACHED);
+            helper.wait();
+            throw;
+        }
+        helper.wait();
+    }
+
+    if (load(best.cost) == UNREACHED) {
+        return {};
+    }
+
+    // dest ... backwardVertex, then forwardVertex ... src
+    std::vector<int> path;
+    for (int at = best.backwardVertex; at != -1; at = backward.prev[at]) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+    for (int at = best.forwardVertex; at != -1; at = forward.prev[at]) {
+        path.push_back(at);
+    }
+
+    // the route's weight without the landing penalties: the lightest in-range edge between each pair of vertices
+    double totalWeight = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        for (uint32_t e = adjacency.begin(path[i]), last = adjacency.rangeEnd(path[i], range); e < last; ++e) {
+            if (adjacency.neighbor(e) == static_cast<uint32_t>(path[i + 1])) {
+                totalWeight += adjacency.weight(e);
+                break;
+            }
+        }
+    }
+    return {path, totalWeight};
+}
+
+}
+
+BidirectionalSearch::BidirectionalSearch(const CompressedAdjacency& adjacency)
+    : adjacency(adjacency) {}
+
+std::pair<std::vector<int>, double> BidirectionalSearch::findPath(int src, int dest, uint32_t range, int landingPenalty,
+                                                                  bool useTwoThreads) const {
+    if (src == dest) {
+        return {{src}, 0};
+    }
+    if (useTwoThreads) {
+        return search<true>(adjacency, src, dest, range, landingPenalty);
+    }
+    return search<false>(adjacency, src, dest, range, landingPenalty);
+}
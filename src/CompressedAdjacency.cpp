@@ -0,0 +1,96 @@
+/**
+ * @file: CompressedAdjacency.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of CompressedAdjacency
+ */
+#include "CompressedAdjacency.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+CompressedAdjacency::CompressedAdjacency(size_t numVertices, const std::vector<Edge>& edges) {
+    // count the edges of each vertex, then turn the counts into offsets
+    std::vector<uint32_t> edgeOffsets(numVertices + 1, 0);
+    for (const Edge& edge : edges) {
+        edgeOffsets[edge.source + 1]++;
+    }
+    for (size_t v = 1; v <= numVertices; ++v) {
+        edgeOffsets[v] += edgeOffsets[v - 1];
+    }
+
+    std::vector<uint32_t> edgeNeighbors(edges.size());
+    std::vector<uint32_t> edgeWeights(edges.size());
+    std::vector<uint32_t> fill(edgeOffsets.begin(), edgeOffsets.end() - 1);
+    for (const Edge& edge : edges) {
+        uint32_t e = fill[edge.source]++;
+        edgeNeighbors[e] = static_cast<uint32_t>(edge.dest);
+        edgeWeights[e] = static_cast<uint32_t>(edge.weight);
+    }
+
+    for (size_t v = 0; v < numVertices; ++v) {
+        sortByWeight(edgeNeighbors.data() + edgeOffsets[v], edgeWeights.data() + edgeOffsets[v],
+                     edgeOffsets[v + 1] - edgeOffsets[v]);
+    }
+
+    offsets = FlatArray<uint32_t>(std::move(edgeOffsets));
+    neighbors = FlatArray<uint32_t>(std::move(edgeNeighbors));
+    weights = FlatArray<uint32_t>(std::move(edgeWeights));
+}
+
+CompressedAdjacency::CompressedAdjacency(std::vector<uint32_t> offsets, std::vector<uint32_t> neighbors,
+                                         std::vector<uint32_t> weights)
+    : offsets(std::move(offsets)), neighbors(std::move(neighbors)), weights(std::move(weights)) {}
+
+CompressedAdjacency CompressedAdjacency::borrow(size_t numVertices, size_t numEdges, const uint32_t* offsets,
+                                                const uint32_t* neighbors, const uint32_t* weights) {
+    CompressedAdjacency adjacency;
+    adjacency.offsets = FlatArray<uint32_t>::borrow(offsets, numVertices + 1);
+    adjacency.neighbors = FlatArray<uint32_t>::borrow(neighbors, numEdges);
+    adjacency.weights = FlatArray<uint32_t>::borrow(weights, numEdges);
+    return adjacency;
+}
+
+uint32_t CompressedAdjacency::packWeight(double distance) {
+    double truncated = std::floor(distance);
+    return (static_cast<uint32_t>(truncated) << 1) | (distance > truncated ? 1u : 0u);
+}
+
+void CompressedAdjacency::sortByWeight(uint32_t* neighbors, uint32_t* weights, size_t count) {
+    std::vector<std::pair<uint32_t, uint32_t>> row(count);
+    for (size_t i = 0; i < count; ++i) {
+        row[i] = {weights[i], neighbors[i]};
+    }
+    std::sort(row.begin(), row.end());
+    for (size_t i = 0; i < count; ++i) {
+        weights[i] = row[i].first;
+        neighbors[i] = row[i].second;
+    }
+}
+
+uint32_t CompressedAdjacency::rangeEnd(size_t v, uint32_t range) const {
+    uint32_t lo = begin(v);
+    uint32_t hi = end(v);
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (minRange(mid) <= range) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void CompressedAdjacency::appendEdges(std::vector<Edge>& out) const {
+    out.reserve(out.size() + numEdges());
+    for (size_t v = 0; v < numVertices(); ++v) {
+        for (uint32_t e = begin(v); e < end(v); ++e) {
+            out.push_back(Edge(v, neighbors[e], static_cast<int>(weights[e])));
+        }
+    }
+}
+
+size_t CompressedAdjacency::memoryBytes() const {
+    return (offsets.size() + neighbors.size() + weights.size()) * sizeof(uint32_t);
+}
@@ -0,0 +1,650 @@
+/**
+ * @file: ContractionHierarchy.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of ContractionHierarchy
+ */
+#include "ContractionHierarchy.h"
+#include "WorkStealing.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+
+/**
+ * Edges are costed as (weight << HOP_BITS) + landings, so comparing costs compares weights first and then the
+ * number of flights, and a sum of costs is the cost of the combined route. 20 bits allows a million flights.
+ */
+const int HOP_BITS = 20;
+const uint64_t INFINITE_COST = std::numeric_limits<uint64_t>::max();
+
+// Bounds the witness searches: a search that settles this many vertices gives up, keeping the shortcut.
+const size_t WITNESS_SETTLE_LIMIT = 500;
+
+uint64_t flightCost(uint32_t weight) {
+    return (static_cast<uint64_t>(weight) << HOP_BITS) + 1;
+}
+
+// An edge of the graph left during contraction.
+struct Arc {
+    uint32_t to;
+    uint32_t middle; // The contracted vertex a shortcut goes through (UINT32_MAX for a flight).
+    uint64_t cost;
+};
+
+// A shortcut found while contracting a vertex, to be added between from and to.
+struct Shortcut {
+    uint32_t from;
+    uint32_t to;
+    uint64_t cost;
+};
+
+using Entry = std::pair<uint64_t, uint32_t>; // (cost, vertex)
+using MinQueue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+/**
+ * The working memory of the two searches of findPath, kept by each thread between queries so a query touches only
+ * the vertices it reaches instead of allocating four arrays the size of the graph. As in SearchContext, every
+ * entry carries the generation that wrote it, and entries of earlier queries read as unreached.
+ */
+class QueryWorkspace {
+    public:
+        // Prepares for a query over numVertices vertices (O(1) unless the graph is larger than before).
+        void reset(size_t numVertices) {
+            if (entries[0].size() < numVertices) {
+                entries[0].assign(numVertices, Slot{});
+                entries[1].assign(numVertices, Slot{});
+                generation = 0;
+            }
+            // generation 0 marks entries never written, so a wrapped counter clears them
+            if (++generation == 0) {
+                std::fill(entries[0].begin(), entries[0].end(), Slot{});
+                std::fill(entries[1].begin(), entries[1].end(), Slot{});
+                generation = 1;
+            }
+            queues[0].clear();
+            queues[1].clear();
+        }
+
+        uint64_t cost(int side, uint32_t v) const {
+            const Slot& slot = entries[side][v];
+            return slot.generation == generation ? slot.cost : INFINITE_COST;
+        }
+
+        // The vertex v was reached from on side's best route to it (only read for vertices that were reached).
+        uint32_t prev(int side, uint32_t v) const { return entries[side][v].prev; }
+
+        void reach(int side, uint32_t v, uint64_t cost, uint32_t prev) {
+            entries[side][v] = Slot{cost, prev, generation};
+        }
+
+        // Side's queue, a min-heap kept with push and pop.
+        bool empty(int side) const { return queues[side].empty(); }
+        const Entry& top(int side) const { return queues[side].front(); }
+        void clear(int side) { queues[side].clear(); }
+
+        void push(int side, Entry entry) {
+            queues[side].push_back(entry);
+            std::push_heap(queues[side].begin(), queues[side].end(), std::greater<Entry>());
+        }
+
+        void pop(int side) {
+            std::pop_heap(queues[side].begin(), queues[side].end(), std::greater<Entry>());
+            queues[side].pop_back();
+        }
+
+    private:
+        struct Slot {
+            uint64_t cost = INFINITE_COST;
+            uint32_t prev = 0;
+            uint32_t generation = 0;
+        };
+
+        std::vector<Slot> entries[2];
+        std::vector<Entry> queues[2];
+        uint32_t generation = 0;
+};
+
+QueryWorkspace& threadQueryWorkspace() {
+    thread_local QueryWorkspace workspace;
+    return workspace;
+}
+
+/**
+ * The working memory of one thread's upward searches for distance matrices (see searchUpwards), kept from one
+ * matrix to the next. Each search leaves every cost at INFINITE_COST again.
+ */
+struct UpwardWorkspace {
+    std::vector<uint64_t> cost;
+    std::vector<uint32_t> prev;
+
+    // Grows the arrays to numVertices (the costs of a smaller graph's searches were all left infinite).
+    void reserve(size_t numVertices) {
+        if (cost.size() < numVertices) {
+            cost.resize(numVertices, INFINITE_COST);
+            prev.resize(numVertices);
+        }
+    }
+};
+
+// Returns the calling thread's upward search workspace, with room for numVertices vertices.
+UpwardWorkspace& threadUpwardWorkspace(size_t numVertices) {
+    thread_local UpwardWorkspace workspace;
+    workspace.reserve(numVertices);
+    return workspace;
+}
+
+/**
+ * A Dijkstra used by one thread to look for witnesses: routes between two neighbours of the vertex being
+ * contracted that avoid it and are no longer than the route through it. Only the costs it touched are reset,
+ * so a search costs the vertices it reaches rather than the size of the graph.
+ */
+class WitnessSearch {
+    public:
+        explicit WitnessSearch(size_t numVertices) : cost(numVertices, INFINITE_COST), isTarget(numVertices, 0) {}
+
+        /**
+         * Runs from source over graph until every target is settled, skipping excluded vertices and vertices
+         * costing more than maxCost, or until settleLimit vertices are settled.
+         */
+        template <typename Excluded>
+        void run(const std::vector<std::vector<Arc>>& graph, uint32_t source, const std::vector<uint32_t>& targets,
+                 uint64_t maxCost, size_t settleLimit, const Excluded& excluded) {
+            reset();
+            for (uint32_t target : targets) {
+                isTarget[target] = 1;
+            }
+            size_t targetsLeft = targets.size();
+            setCost(source, 0);
+            queue.push({0, source});
+
+            size_t settled = 0;
+            while (!queue.empty() && settled < settleLimit && targetsLeft > 0) {
+                auto [key, u] = queue.top();
+                queue.pop();
+                if (key > cost[u]) {
+                    continue;
+                }
+                ++settled;
+                if (isTarget[u]) {
+                    --targetsLeft;
+                }
+
+                for (const Arc& arc : graph[u]) {
+                    uint64_t nextCost = key + arc.cost;
+                    if (nextCost <= maxCost && nextCost < cost[arc.to] && !excluded(arc.to)) {
+                        setCost(arc.to, nextCost);
+                        queue.push({nextCost, arc.to});
+                    }
+                }
+            }
+            queue = MinQueue();
+            for (uint32_t target : targets) {
+                isTarget[target] = 0;
+            }
+        }
+
+        // Returns the cost of the best route the last run found to v (INFINITE_COST if none).
+        uint64_t costTo(uint32_t v) const { return cost[v]; }
+
+    private:
+        void setCost(uint32_t v, uint64_t newCost) {
+            if (cost[v] == INFINITE_COST) {
+                touched.push_back(v);
+            }
+            cost[v] = newCost;
+        }
+
+        void reset() {
+            for (uint32_t v : touched) {
+                cost[v] = INFINITE_COST;
+            }
+            touched.clear();
+        }
+
+        std::vector<uint64_t> cost;
+        std::vector<uint32_t> touched;
+        std::vector<char> isTarget;
+        MinQueue queue;
+};
+
+/**
+ * Finds the shortcuts needed to contract v: for each pair of its neighbours whose best route is through v.
+ * Witness searches skip v and the vertices excluded by skip (the others contracted in the same round).
+ */
+template <typename Skip>
+void findShortcuts(const std::vector<std::vector<Arc>>& graph, uint32_t v, WitnessSearch& witness, const Skip& skip,
+                   std::vector<Shortcut>& out) {
+    const std::vector<Arc>& arcs = graph[v];
+    if (arcs.size() < 2) {
+        return;
+    }
+    // the costliest arc after each one bounds how far the search from it has to look
+    std::vector<uint64_t> maxArcAfter(arcs.size(), 0);
+    for (size_t i = arcs.size() - 1; i > 0; --i) {
+        maxArcAfter[i - 1] = std::max(maxArcAfter[i], arcs[i].cost);
+    }
+
+    auto excluded = [&](uint32_t x) { return x == v || skip(x); };
+    std::vector<uint32_t> targets;
+    for (size_t i = 0; i + 1 < arcs.size(); ++i) {
+        targets.clear();
+        for (size_t j = i + 1; j < arcs.size(); ++j) {
+            targets.push_back(arcs[j].to);
+        }
+        witness.run(graph, arcs[i].to, targets, arcs[i].cost + maxArcAfter[i], WITNESS_SETTLE_LIMIT, excluded);
+        for (size_t j = i + 1; j < arcs.size(); ++j) {
+            uint64_t through = arcs[i].cost + arcs[j].cost;
+            if (witness.costTo(arcs[j].to) > through) {
+                out.push_back({arcs[i].to, arcs[j].to, through});
+            }
+        }
+    }
+}
+
+// Adds an arc from u to to, or lowers the cost of the existing one.
+void addArc(std::vector<Arc>& arcs, uint32_t to, uint32_t middle, uint64_t cost) {
+    for (Arc& arc : arcs) {
+        if (arc.to == to) {
+            if (cost < arc.cost) {
+                arc.cost = cost;
+                arc.middle = middle;
+            }
+            return;
+        }
+    }
+    arcs.push_back({to, middle, cost});
+}
+
+}
+
+ContractionHierarchy ContractionHierarchy::build(const CompressedAdjacency& adjacency, uint32_t range,
+                                                 size_t numThreads) {
+    numThreads = resolveThreadCount(numThreads);
+    const size_t numVertices = adjacency.numVertices();
+    std::vector<std::vector<Arc>> graph(numVertices);
+
+    // Copy the flights in range, dropping each one that two shorter flights can replace. Both parts of the
+    // replacement are cheaper than the flight, so by induction a route of kept flights is always as short.
+    // Most flights of a dense graph are dropped, which makes every witness search below cheaper.
+    std::vector<std::vector<uint64_t>> viaCost(numThreads, std::vector<uint64_t>(numVertices, INFINITE_COST));
+    runWorkStealing(numVertices, numThreads, [&](size_t u, size_t worker) {
+        std::vector<uint64_t>& cost = viaCost[worker];
+        uint32_t first = adjacency.begin(u);
+        uint32_t last = adjacency.rangeEnd(u, range);
+        for (uint32_t e = first; e < last; ++e) {
+            uint32_t y = adjacency.neighbor(e);
+            cost[y] = std::min(cost[y], flightCost(adjacency.weight(e)));
+        }
+
+        for (uint32_t e = first; e < last; ++e) {
+            uint32_t x = adjacency.neighbor(e);
+            uint64_t direct = flightCost(adjacency.weight(e));
+            if (x == u || direct > cost[x]) {
+                continue; // a loop, or a heavier duplicate of a flight
+            }
+
+            bool dominated = false;
+            for (uint32_t f = adjacency.begin(x), fLast = adjacency.rangeEnd(x, range); f < fLast && !dominated; ++f) {
+                uint32_t y = adjacency.neighbor(f);
+                dominated = cost[y] != INFINITE_COST && y != x && cost[y] + flightCost(adjacency.weight(f)) <= direct;
+            }
+            if (!dominated) {
+                addArc(graph[u], x, NO_MIDDLE, direct);
+            }
+        }
+
+        for (uint32_t e = first; e < last; ++e) {
+            cost[adjacency.neighbor(e)] = INFINITE_COST;
+        }
+    });
+
+    // Priority of contracting a vertex (lowest first): the shortcuts it could add less the edges it removes, plus
+    // how many of its neighbours are already contracted and how deep in the hierarchy it would sit. The last two
+    // spread contraction evenly over the map, which keeps the searches upward short. Counting the shortcuts with
+    // witness searches as well costs several times the build for a hierarchy that is no faster on these graphs.
+    std::vector<int> deletedNeighbours(numVertices, 0);
+    std::vector<int> level(numVertices, 0);
+    std::vector<int> priority(numVertices, 0);
+    auto updatePriority = [&](uint32_t v) {
+        int degree = static_cast<int>(graph[v].size());
+        priority[v] = degree * (degree - 1) / 2 - degree + deletedNeighbours[v] + 3 * level[v];
+    };
+    for (size_t v = 0; v < numVertices; ++v) {
+        updatePriority(static_cast<uint32_t>(v));
+    }
+
+    ContractionHierarchy hierarchy;
+    hierarchy.range = range;
+    hierarchy.rank.assign(numVertices, 0);
+    std::vector<WitnessSearch> witnesses(numThreads, WitnessSearch(numVertices));
+    std::vector<std::vector<Arc>> upward(numVertices);
+    std::vector<char> contracted(numVertices, 0);
+    std::vector<char> inRound(numVertices, 0);
+    std::vector<char> isTouched(numVertices, 0);
+
+    std::vector<uint32_t> remaining(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        remaining[v] = static_cast<uint32_t>(v);
+    }
+
+    uint32_t nextRank = 0;
+    while (!remaining.empty()) {
+        // contract every vertex less important than all of its neighbours; no two of them are neighbours
+        std::vector<uint32_t> round;
+        for (uint32_t v : remaining) {
+            bool isMinimum = true;
+            for (const Arc& arc : graph[v]) {
+                uint32_t u = arc.to;
+                if (priority[u] < priority[v] || (priority[u] == priority[v] && u < v)) {
+                    isMinimum = false;
+                    break;
+                }
+            }
+            if (isMinimum) {
+                round.push_back(v);
+                inRound[v] = 1;
+            }
+        }
+
+        std::vector<std::vector<Shortcut>> found(round.size());
+        auto skip = [&](uint32_t x) { return inRound[x] != 0; };
+        runWorkStealing(round.size(), numThreads, [&](size_t i, size_t worker) {
+            findShortcuts(graph, round[i], witnesses[worker], skip, found[i]);
+        });
+
+        // the vertex's remaining edges all lead to vertices contracted later
+        std::vector<uint32_t> touched;
+        for (uint32_t v : round) {
+            hierarchy.rank[v] = nextRank++;
+            contracted[v] = 1;
+            for (const Arc& arc : graph[v]) {
+                ++deletedNeighbours[arc.to];
+                level[arc.to] = std::max(level[arc.to], level[v] + 1);
+                if (!isTouched[arc.to]) {
+                    isTouched[arc.to] = 1;
+                    touched.push_back(arc.to);
+                }
+            }
+            upward[v] = std::move(graph[v]);
+            graph[v] = std::vector<Arc>();
+        }
+
+        runWorkStealing(touched.size(), numThreads, [&](size_t i, size_t) {
+            std::vector<Arc>& arcs = graph[touched[i]];
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [&](const Arc& arc) { return contracted[arc.to] != 0; }),
+                       arcs.end());
+        });
+        for (size_t i = 0; i < round.size(); ++i) {
+            for (const Shortcut& shortcut : found[i]) {
+                addArc(graph[shortcut.from], shortcut.to, round[i], shortcut.cost);
+                addArc(graph[shortcut.to], shortcut.from, round[i], shortcut.cost);
+            }
+        }
+
+        for (uint32_t u : touched) {
+            updatePriority(u);
+            isTouched[u] = 0;
+        }
+        for (uint32_t v : round) {
+            inRound[v] = 0;
+        }
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](uint32_t v) { return contracted[v] != 0; }),
+                        remaining.end());
+    }
+
+    // pack the upward edges of every vertex into one array
+    hierarchy.offsets.assign(numVertices + 1, 0);
+    for (size_t v = 0; v < numVertices; ++v) {
+        hierarchy.offsets[v + 1] = hierarchy.offsets[v] + static_cast<uint32_t>(upward[v].size());
+    }
+    hierarchy.edges.reserve(hierarchy.offsets[numVertices]);
+    for (size_t v = 0; v < numVertices; ++v) {
+        for (const Arc& arc : upward[v]) {
+            hierarchy.edges.push_back({arc.to, arc.middle, arc.cost});
+            if (arc.middle != NO_MIDDLE) {
+                ++hierarchy.shortcuts;
+            }
+        }
+        upward[v] = std::vector<Arc>();
+    }
+    return hierarchy;
+}
+
+std::pair<std::vector<int>, double> ContractionHierarchy::findPath(int src, int dest) const {
+    if (src == dest) {
+        return {{src}, 0};
+    }
+
+    // Dijkstra upwards from both ends. The shortest route climbs from src to its most important vertex and
+    // descends to dest, so it is found where the two searches meet; a search stops once its smallest key
+    // is no better than the best meeting.
+    QueryWorkspace& work = threadQueryWorkspace();
+    work.reset(rank.size());
+    work.reach(0, src, 0, NO_MIDDLE);
+    work.reach(1, dest, 0, NO_MIDDLE);
+    work.push(0, {0, static_cast<uint32_t>(src)});
+    work.push(1, {0, static_cast<uint32_t>(dest)});
+
+    uint64_t best = INFINITE_COST;
+    uint32_t meeting = NO_MIDDLE;
+    while (!work.empty(0) || !work.empty(1)) {
+        int side = work.empty(1) || (!work.empty(0) && work.top(0) < work.top(1)) ? 0 : 1;
+        auto [key, u] = work.top(side);
+        work.pop(side);
+        if (key >= best) {
+            work.clear(side);
+            continue;
+        }
+        if (key > work.cost(side, u)) {
+            continue;
+        }
+        uint64_t otherCost = work.cost(1 - side, u);
+        if (otherCost != INFINITE_COST && key + otherCost < best) {
+            best = key + otherCost;
+            meeting = u;
+        }
+
+        // stall on demand: a vertex reached more cheaply through a more important one (edges are symmetric, so
+        // those are its upward edges) is not on a shortest route that climbs, and need not be expanded
+        bool stalled = false;
+        for (uint32_t e = offsets[u]; e < offsets[u + 1] && !stalled; ++e) {
+            uint64_t above = work.cost(side, edges[e].to);
+            stalled = above != INFINITE_COST && above + edges[e].cost < key;
+        }
+        if (stalled) {
+            continue;
+        }
+
+        for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            uint64_t nextCost = key + edges[e].cost;
+            if (nextCost < work.cost(side, edges[e].to)) {
+                work.reach(side, edges[e].to, nextCost, u);
+                work.push(side, {nextCost, edges[e].to});
+            }
+        }
+    }
+
+    if (meeting == NO_MIDDLE) {
+        return {};
+    }
+
+    // src ... meeting ... dest, with every shortcut unpacked into its flights
+    std::vector<uint32_t> climb;
+    for (uint32_t at = meeting; at != NO_MIDDLE; at = work.prev(0, at)) {
+        climb.push_back(at);
+    }
+    std::reverse(climb.begin(), climb.end());
+    for (uint32_t at = work.prev(1, meeting); at != NO_MIDDLE; at = work.prev(1, at)) {
+        climb.push_back(at);
+    }
+
+    std::vector<int> path = {src};
+    for (size_t i = 0; i + 1 < climb.size(); ++i) {
+        unpack(climb[i], climb[i + 1], path);
+    }
+    std::reverse(path.begin(), path.end());
+    return {path, static_cast<double>(best >> HOP_BITS)};
+}
+
+void ContractionHierarchy::searchUpwards(uint32_t root, std::vector<uint64_t>& cost, std::vector<uint32_t>& prev,
+                                         std::vector<Settled>& settled) const {
+    std::vector<uint32_t> touched = {root};
+    MinQueue queue;
+    cost[root] = 0;
+    prev[root] = NO_MIDDLE;
+    queue.push({0, root});
+    while (!queue.empty()) {
+        auto [key, u] = queue.top();
+        queue.pop();
+        if (key > cost[u]) {
+            continue;
+        }
+
+        // stall on demand, as in findPath
+        bool stalled = false;
+        for (uint32_t e = offsets[u]; e < offsets[u + 1] && !stalled; ++e) {
+            uint64_t above = cost[edges[e].to];
+            stalled = above != INFINITE_COST && above + edges[e].cost < key;
+        }
+        if (stalled) {
+            continue;
+        }
+        settled.push_back({u, prev[u], key});
+
+        for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            uint32_t v = edges[e].to;
+            uint64_t nextCost = key + edges[e].cost;
+            if (nextCost < cost[v]) {
+                if (cost[v] == INFINITE_COST) {
+                    touched.push_back(v);
+                }
+                cost[v] = nextCost;
+                prev[v] = u;
+                queue.push({nextCost, v});
+            }
+        }
+    }
+
+    for (uint32_t v : touched) {
+        cost[v] = INFINITE_COST;
+    }
+}
+
+DistanceMatrix ContractionHierarchy::distanceMatrix(const std::vector<int>& sources, const std::vector<int>& targets,
+                                                    bool includePaths, WorkStealingPool& pool) const {
+    const size_t numVertices = rank.size();
+    DistanceMatrix matrix(sources.size(), targets.size(), includePaths);
+
+    // the search space of each target, sorted by vertex so the way down to the target can be looked up
+    std::vector<std::vector<Settled>> down(targets.size());
+    pool.run(targets.size(), [&](size_t t, size_t) {
+        UpwardWorkspace& work = threadUpwardWorkspace(numVertices);
+        searchUpwards(targets[t], work.cost, work.prev, down[t]);
+        std::sort(down[t].begin(), down[t].end(), [](const Settled& a, const Settled& b) { return a.vertex < b.vertex; });
+    });
+
+    // bucket v holds (target, cost from v down to the target) for every target whose search settled v
+    struct BucketEntry {
+        uint32_t target;
+        uint64_t cost;
+    };
+    std::vector<uint32_t> bucketOffsets(numVertices + 1, 0);
+    for (const std::vector<Settled>& space : down) {
+        for (const Settled& entry : space) {
+            ++bucketOffsets[entry.vertex + 1];
+        }
+    }
+    for (size_t v = 0; v < numVertices; ++v) {
+        bucketOffsets[v + 1] += bucketOffsets[v];
+    }
+    std::vector<BucketEntry> buckets(bucketOffsets[numVertices]);
+    std::vector<uint32_t> filled(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    for (size_t t = 0; t < targets.size(); ++t) {
+        for (const Settled& entry : down[t]) {
+            buckets[filled[entry.vertex]++] = {static_cast<uint32_t>(t), entry.cost};
+        }
+    }
+
+    pool.run(sources.size(), [&](size_t s, size_t) {
+        UpwardWorkspace& work = threadUpwardWorkspace(numVertices);
+        std::vector<Settled> up;
+        searchUpwards(sources[s], work.cost, work.prev, up);
+
+        std::vector<uint64_t> best(targets.size(), INFINITE_COST);
+        std::vector<uint32_t> meeting(targets.size(), NO_MIDDLE);
+        for (const Settled& entry : up) {
+            for (uint32_t b = bucketOffsets[entry.vertex]; b < bucketOffsets[entry.vertex + 1]; ++b) {
+                uint64_t total = entry.cost + buckets[b].cost;
+                if (total < best[buckets[b].target]) {
+                    best[buckets[b].target] = total;
+                    meeting[buckets[b].target] = entry.vertex;
+                }
+            }
+        }
+
+        for (size_t t = 0; t < targets.size(); ++t) {
+            if (best[t] == INFINITE_COST) {
+                continue;
+            }
+            matrix.set(s, t, static_cast<double>(best[t] >> HOP_BITS),
+                       static_cast<int>(best[t] & ((uint64_t(1) << HOP_BITS) - 1)));
+            if (!includePaths) {
+                continue;
+            }
+
+            // source ... meeting from the source's search (whose prev is still in this thread's memory),
+            // then meeting ... target from the target's, with every shortcut unpacked into its flights
+            std::vector<uint32_t> climb;
+            for (uint32_t at = meeting[t]; at != NO_MIDDLE; at = work.prev[at]) {
+                climb.push_back(at);
+            }
+            std::reverse(climb.begin(), climb.end());
+            for (uint32_t at = meeting[t]; ; ) {
+                auto found = std::lower_bound(down[t].begin(), down[t].end(), at,
+                                              [](const Settled& a, uint32_t v) { return a.vertex < v; });
+                at = found->prev;
+                if (at == NO_MIDDLE) {
+                    break;
+                }
+                climb.push_back(at);
+            }
+
+            std::vector<int>& path = matrix.pathAt(s, t);
+            path = {sources[s]};
+            for (size_t i = 0; i + 1 < climb.size(); ++i) {
+                unpack(climb[i], climb[i + 1], path);
+            }
+            std::reverse(path.begin(), path.end());
+        }
+    });
+    return matrix;
+}
+
+const ContractionHierarchy::UpwardEdge* ContractionHierarchy::findEdge(uint32_t lower, uint32_t higher) const {
+    for (uint32_t e = offsets[lower]; e < offsets[lower + 1]; ++e) {
+        if (edges[e].to == higher) {
+            return &edges[e];
+        }
+    }
+    return nullptr;
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, std::vector<int>& path) const {
+    // every edge is stored at the end contracted first, and a shortcut's middle was contracted before both ends
+    const UpwardEdge* edge = rank[from] < rank[to] ? findEdge(from, to) : findEdge(to, from);
+    if (edge->middle == NO_MIDDLE) {
+        path.push_back(static_cast<int>(to));
+        return;
+    }
+    uint32_t middle = edge->middle;
+    unpack(from, middle, path);
+    unpack(middle, to, path);
+}
+
+size_t ContractionHierarchy::memoryBytes() const {
+    return rank.capacity() * sizeof(uint32_t) + offsets.capacity() * sizeof(uint32_t) +
+           edges.capacity() * sizeof(UpwardEdge);
+}
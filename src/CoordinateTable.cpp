@@ -0,0 +1,48 @@
+/**
+ * @file: CoordinateTable.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of CoordinateTable
+ */
+#include "CoordinateTable.h"
+
+CoordinateTable::CoordinateTable(const std::vector<Airport>& airports) {
+    reserve(airports.size());
+    for (const Airport& airport : airports) {
+        add(airport.latitude, airport.longitude);
+    }
+}
+
+CoordinateTable::CoordinateTable(const AirportTable& airports) {
+    reserve(airports.size());
+    for (size_t i = 0; i < airports.size(); ++i) {
+        add(airports.latitude(i), airports.longitude(i));
+    }
+}
+
+void CoordinateTable::add(double lat, double lon) {
+    double phi = toRadians(lat);
+    double lambda = toRadians(lon);
+
+    latRad.push_back(phi);
+    lonRad.push_back(lambda);
+    x.push_back(std::cos(phi) * std::cos(lambda));
+    y.push_back(std::cos(phi) * std::sin(lambda));
+    z.push_back(std::sin(phi));
+}
+
+void CoordinateTable::reserve(size_t n) {
+    latRad.reserve(n);
+    lonRad.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+}
+
+void CoordinateTable::clear() {
+    latRad.clear();
+    lonRad.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+}
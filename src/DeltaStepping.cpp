@@ -0,0 +1,265 @@
+/**
+ * @file: DeltaStepping.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of DeltaStepping
+ */
+#include "DeltaStepping.h"
+#include "WorkStealing.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace {
+
+const uint32_t INFINITE = UINT32_MAX;
+
+// The default bucket width is the longest edge within range divided by this.
+const uint32_t BUCKETS_PER_EDGE = 8;
+
+// The airports of a round are claimed by the threads this many at a time.
+const size_t CHUNK_SIZE = 64;
+
+// A thread waiting at the barrier spins this many times before it starts yielding its core.
+const int SPINS_BEFORE_YIELD = 256;
+
+/**
+ * Holds every thread until all of them have arrived. The rounds are short, so threads spin rather than sleep, but
+ * they yield once they have spun for a while so a machine with fewer cores than threads still makes progress.
+ */
+class Barrier {
+    public:
+        explicit Barrier(size_t count) : count(count) {}
+
+        void wait() {
+            size_t generation = phase.load(std::memory_order_acquire);
+            if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                waiting.store(0, std::memory_order_relaxed);
+                phase.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            for (int spins = 0; phase.load(std::memory_order_acquire) == generation; ++spins) {
+                if (spins >= SPINS_BEFORE_YIELD) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        const size_t count;
+        std::atomic<size_t> waiting{0};
+        std::atomic<size_t> phase{0};
+};
+
+// Lowers value to candidate if it is smaller. Returns true if it did.
+inline bool lower(std::atomic<uint32_t>& value, uint32_t candidate) {
+    uint32_t current = value.load(std::memory_order_relaxed);
+    while (candidate < current) {
+        if (value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// What the threads do between two pairs of barriers.
+enum class Step { Light, Heavy, Done };
+
+// The state of one search, shared by its threads.
+struct Search {
+    const CompressedAdjacency& adj;
+    uint32_t range;
+    uint32_t width;
+    uint32_t lightRange; // Edges with minRange <= lightRange are light.
+    size_t numThreads;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> dist;
+    std::unique_ptr<std::atomic<uint32_t>[]> relaxedAt; // The distance each airport's light edges were last relaxed at.
+    std::vector<std::vector<std::vector<uint32_t>>> buckets; // Each thread's buckets of airports.
+    std::vector<std::vector<uint32_t>> settled;              // The airports each thread relaxed in the current bucket.
+
+    std::vector<uint32_t> frontier; // The airports of the current round.
+    std::atomic<size_t> next{0};    // The first airport of the frontier not yet claimed.
+    size_t current = 0;             // The bucket being settled.
+    Step step = Step::Light;
+    Barrier barrier;
+
+    Search(const CompressedAdjacency& adj, uint32_t range, uint32_t width, size_t numThreads)
+        : adj(adj), range(range), width(width), lightRange(std::min(range, width)), numThreads(numThreads),
+          dist(new std::atomic<uint32_t>[adj.numVertices()]), relaxedAt(new std::atomic<uint32_t>[adj.numVertices()]),
+          buckets(numThreads), settled(numThreads), barrier(numThreads) {
+        for (size_t v = 0; v < adj.numVertices(); ++v) {
+            dist[v].store(INFINITE, std::memory_order_relaxed);
+            relaxedAt[v].store(INFINITE, std::memory_order_relaxed);
+        }
+    }
+
+    // Puts v, now at distance d, in thread t's bucket for d.
+    void push(size_t t, uint32_t v, uint32_t d) {
+        size_t bucket = d / width;
+        if (buckets[t].size() <= bucket) {
+            buckets[t].resize(bucket + 1);
+        }
+        buckets[t][bucket].push_back(v);
+    }
+
+    // Moves every thread's bucket b into the frontier. Returns false if they were all empty.
+    bool gather(size_t b) {
+        frontier.clear();
+        for (auto& own : buckets) {
+            if (b < own.size()) {
+                frontier.insert(frontier.end(), own[b].begin(), own[b].end());
+                own[b].clear();
+            }
+        }
+        return !frontier.empty();
+    }
+
+    // Decides the next step, on one thread while the others wait.
+    void plan() {
+        next.store(0, std::memory_order_relaxed);
+        // the light rounds go on while they put airports back into the bucket
+        if (step == Step::Light) {
+            if (gather(current)) {
+                return;
+            }
+            frontier.clear();
+            for (auto& own : settled) {
+                frontier.insert(frontier.end(), own.begin(), own.end());
+                own.clear();
+            }
+            if (!frontier.empty()) {
+                step = Step::Heavy;
+                return;
+            }
+        }
+        // the bucket is settled; move on to the first bucket after it with airports in it
+        size_t last = 0;
+        for (const auto& own : buckets) {
+            last = std::max(last, own.size());
+        }
+        for (++current; current < last; ++current) {
+            if (gather(current)) {
+                step = Step::Light;
+                return;
+            }
+        }
+        step = Step::Done;
+    }
+
+    // Claims the next chunk of the frontier. Returns false once it has all been claimed.
+    bool claim(size_t& first, size_t& end) {
+        first = next.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+        end = std::min(first + CHUNK_SIZE, frontier.size());
+        return first < frontier.size();
+    }
+
+    // Relaxes the light edges of the frontier's airports that are still in the current bucket.
+    void relaxLight(size_t t) {
+        size_t first, end;
+        while (claim(first, end)) {
+            for (size_t i = first; i < end; ++i) {
+                uint32_t u = frontier[i];
+                uint32_t d = dist[u].load(std::memory_order_relaxed);
+                // u has been lowered into an earlier bucket since it was put in this one
+                if (d / width != current) {
+                    continue;
+                }
+                uint32_t previous = relaxedAt[u].exchange(d, std::memory_order_relaxed);
+                if (previous == d) {
+                    continue;
+                }
+                if (previous == INFINITE || previous / width != current) {
+                    settled[t].push_back(u);
+                }
+                for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, lightRange); e < last; ++e) {
+                    uint32_t v = adj.neighbor(e);
+                    uint32_t candidate = d + adj.weight(e);
+                    if (lower(dist[v], candidate)) {
+                        push(t, v, candidate);
+                    }
+                }
+            }
+        }
+    }
+
+    // Relaxes the heavy edges of the frontier's airports, whose distances are final; they land in later buckets.
+    void relaxHeavy(size_t t) {
+        size_t first, end;
+        while (claim(first, end)) {
+            for (size_t i = first; i < end; ++i) {
+                uint32_t u = frontier[i];
+                uint32_t d = dist[u].load(std::memory_order_relaxed);
+                for (uint32_t e = adj.rangeEnd(u, lightRange), last = adj.rangeEnd(u, range); e < last; ++e) {
+                    uint32_t v = adj.neighbor(e);
+                    uint32_t candidate = d + adj.weight(e);
+                    if (lower(dist[v], candidate)) {
+                        push(t, v, candidate);
+                    }
+                }
+            }
+        }
+    }
+
+    void work(size_t t) {
+        while (true) {
+            barrier.wait();
+            if (t == 0) {
+                plan();
+            }
+            barrier.wait();
+            if (step == Step::Done) {
+                return;
+            }
+            if (step == Step::Light) {
+                relaxLight(t);
+            } else {
+                relaxHeavy(t);
+            }
+        }
+    }
+};
+
+}
+
+DeltaStepping::DeltaStepping(const CompressedAdjacency& adjacency, uint32_t bucketWidth, size_t numThreads)
+    : adjacency(adjacency), bucketWidth(bucketWidth), numThreads(resolveThreadCount(numThreads)) {}
+
+uint32_t DeltaStepping::bucketWidthFor(uint32_t range) const {
+    if (bucketWidth > 0) {
+        return bucketWidth;
+    }
+    // each airport's edges are sorted by weight, so its longest edge within range is the last one
+    uint32_t longest = 0;
+    for (size_t v = 0; v < adjacency.numVertices(); ++v) {
+        uint32_t end = adjacency.rangeEnd(v, range);
+        if (end > adjacency.begin(v)) {
+            longest = std::max(longest, adjacency.weight(end - 1));
+        }
+    }
+    return std::max<uint32_t>(1, longest / BUCKETS_PER_EDGE);
+}
+
+std::vector<int> DeltaStepping::distancesFrom(int source, uint32_t range) const {
+    const size_t n = adjacency.numVertices();
+    Search search(adjacency, range, bucketWidthFor(range), numThreads);
+    search.dist[source].store(0, std::memory_order_relaxed);
+    search.push(0, source, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) {
+        threads.emplace_back(&Search::work, &search, t);
+    }
+    search.work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> distances(n);
+    for (size_t v = 0; v < n; ++v) {
+        uint32_t d = search.dist[v].load(std::memory_order_relaxed);
+        distances[v] = d == INFINITE ? UNREACHABLE : static_cast<int>(d);
+    }
+    return distances;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file: DistanceKernel.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of the batched distance kernel
+ */
+#include "DistanceKernel.h"
+#include <algorithm>
+#include "Airport.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FPO_KERNEL_SSE2
+#endif
+
+double chordForDistance(double distanceNm) {
+    double angle = std::min(std::max(distanceNm, 0.0) / EARTH_RADIUS_NM, M_PI);
+    return 2 * std::sin(angle / 2) * (1 + 1e-9) + 1e-12;
+}
+
+namespace {
+    inline double chord2At(const double* xs, const double* ys, const double* zs, size_t i, const double q[3]) {
+        double dx = xs[i] - q[0], dy = ys[i] - q[1], dz = zs[i] - q[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+}
+
+#if defined(__AVX2__)
+
+size_t chordWithin(const double* xs, const double* ys, const double* zs, size_t count,
+                   const double q[3], double maxChord2, uint32_t* out) {
+    const __m256d qx = _mm256_set1_pd(q[0]), qy = _mm256_set1_pd(q[1]), qz = _mm256_set1_pd(q[2]);
+    const __m256d limit = _mm256_set1_pd(maxChord2);
+    size_t found = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), qx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), qy);
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zs + i), qz);
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+
+        // one bit per lane that is within the threshold
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d2, limit, _CMP_LE_OQ));
+        for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) out[found++] = static_cast<uint32_t>(i + lane);
+        }
+    }
+
+    for (; i < count; ++i) {
+        if (chord2At(xs, ys, zs, i, q) <= maxChord2) {
+            out[found++] = static_cast<uint32_t>(i);
+        }
+    }
+    return found;
+}
+
+void chordDistances2(const double* xs, const double* ys, const double* zs, size_t count,
+                     const double q[3], double* out) {
+    const __m256d qx = _mm256_set1_pd(q[0]), qy = _mm256_set1_pd(q[1]), qz = _mm256_set1_pd(q[2]);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), qx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), qy);
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zs + i), qz);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)));
+    }
+
+    for (; i < count; ++i) {
+        out[i] = chord2At(xs, ys, zs, i, q);
+    }
+}
+
+const char* distanceKernelName() {
+    return "avx2";
+}
+
+#elif defined(FPO_KERNEL_SSE2)
+
+size_t chordWithin(const double* xs, const double* ys, const double* zs, size_t count,
+                   const double q[3], double maxChord2, uint32_t* out) {
+    const __m128d qx = _mm_set1_pd(q[0]), qy = _mm_set1_pd(q[1]), qz = _mm_set1_pd(q[2]);
+    const __m128d limit = _mm_set1_pd(maxChord2);
+    size_t found = 0;
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), qx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), qy);
+        __m128d dz = _mm_sub_pd(_mm_loadu_pd(zs + i), qz);
+        __m128d d2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+
+        // one bit per lane that is within the threshold
+        int mask = _mm_movemask_pd(_mm_cmple_pd(d2, limit));
+        if (mask & 1) out[found++] = static_cast<uint32_t>(i);
+        if (mask & 2) out[found++] = static_cast<uint32_t>(i + 1);
+    }
+
+    for (; i < count; ++i) {
+        if (chord2At(xs, ys, zs, i, q) <= maxChord2) {
+            out[found++] = static_cast<uint32_t>(i);
+        }
+    }
+    return found;
+}
+
+void chordDistances2(const double* xs, const double* ys, const double* zs, size_t count,
+                     const double q[3], double* out) {
+    const __m128d qx = _mm_set1_pd(q[0]), qy = _mm_set1_pd(q[1]), qz = _mm_set1_pd(q[2]);
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), qx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), qy);
+        __m128d dz = _mm_sub_pd(_mm_loadu_pd(zs + i), qz);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)));
+    }
+
+    for (; i < count; ++i) {
+        out[i] = chord2At(xs, ys, zs, i, q);
+    }
+}
+
+const char* distanceKernelName() {
+    return "sse2";
+}
+
+#else
+
+size_t chordWithin(const double* xs, const double* ys, const double* zs, size_t count,
+                   const double q[3], double maxChord2, uint32_t* out) {
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (chord2At(xs, ys, zs, i, q) <= maxChord2) {
+            out[found++] = static_cast<uint32_t>(i);
+        }
+    }
+    return found;
+}
+
+void chordDistances2(const double* xs, const double* ys, const double* zs, size_t count,
+                     const double q[3], double* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = chord2At(xs, ys, zs, i, q);
+    }
+}
+
+const char* distanceKernelName() {
+    return "scalar";
+}
+
+#endif
@@ -23,30 +23,48 @@
 int THRESHOLD = 0;
 
 
-int main() {
+int main(int argc, char* argv[]) {
     std::string filepath = "./datasets/airports.json";
     std::string fetchScriptpath = "./scripts/fetchAirportData.py";
 
-    // Ask to update the json dataset
-    askRunScript(fetchScriptpath, filepath);
+    Graph g(0);
 
-    // Read the json file into jsonData
-    std::cout << "reading file... ";
-    std::ifstream file(filepath);
-    nlohmann::json jsonData;
-    file >> jsonData; // read the airports file into json object
-    std::cout << "done\n" << std::endl;
+    if (argc > 1) {
+        // Start from a snapshot written by buildSnapshot, the range is the one it was built with
+        std::cout << "loading snapshot " << argv[1] << "... ";
+        try {
+            g.loadSnapshot(argv[1]);
+        } catch (const std::exception& e) {
+            std::cout << RED << "\n" << e.what() << RESET << std::endl;
+            return 1;
+        }
+        THRESHOLD = g.getMaxRange();
+        std::cout << "done" << std::endl;
+    } else {
+        // Ask to update the json dataset
+        askRunScript(fetchScriptpath, filepath);
+
+        // Stream the json file into a table of airports
+        std::cout << "reading file... ";
+        AirportTable airports;
+        try {
+            airports = AirportTable::load(filepath);
+        } catch (const std::exception& e) {
+            std::cout << RED << "\n" << e.what() << RESET << std::endl;
+            return 1;
+        }
+        std::cout << "done\n" << std::endl;
 
-    // // Prompt for aircraft range
-    THRESHOLD = promptRange();
+        // // Prompt for aircraft range
+        THRESHOLD = promptRange();
 
-    // Creating AirportGraph
+        // Creating AirportGraph
 
-    std::cout << "generating airport graph... ";
+        std::cout << "generating airport graph... ";
 
-    Graph g(jsonData.size());
-    g.generateAirportGraph(jsonData, THRESHOLD, true);
-    std::cout << "done" << std::endl;
+        g.generateAirportGraph(airports, THRESHOLD, true, BuildMode::SpatialGrid);
+        std::cout << "done" << std::endl;
+    }
 
     // Creating visual dot file of graph found in ./dot_files/
     g.toDOT("./dot_files/airports.dot");
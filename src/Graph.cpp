@@ -5,13 +5,55 @@
  * Implementation of graph ADT
  */
 #include "Graph.h"
+#include "WorkStealing.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+bool parseRouteAlgorithm(const std::string& name, RouteAlgorithm& algorithm) {
+    if (name == "fewest-landings") {
+        algorithm = RouteAlgorithm::FewestLandings;
+    } else if (name == "distance") {
+        algorithm = RouteAlgorithm::Distance;
+    } else if (name == "astar") {
+        algorithm = RouteAlgorithm::AStar;
+    } else if (name == "bidirectional") {
+        algorithm = RouteAlgorithm::Bidirectional;
+    } else if (name == "bidirectional-fewest-landings") {
+        algorithm = RouteAlgorithm::BidirectionalFewestLandings;
+    } else if (name == "ch") {
+        algorithm = RouteAlgorithm::ContractionHierarchy;
+    } else if (name == "alt") {
+        algorithm = RouteAlgorithm::Landmarks;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string routeAlgorithmName(RouteAlgorithm algorithm) {
+    switch (algorithm) {
+        case RouteAlgorithm::Distance: return "distance";
+        case RouteAlgorithm::AStar: return "astar";
+        case RouteAlgorithm::Bidirectional: return "bidirectional";
+        case RouteAlgorithm::BidirectionalFewestLandings: return "bidirectional-fewest-landings";
+        case RouteAlgorithm::ContractionHierarchy: return "ch";
+        case RouteAlgorithm::Landmarks: return "alt";
+        default: return "fewest-landings";
+    }
+}
 
 Graph::Graph(size_t numVertices)
-    : numVertices(numVertices), adjList(numVertices) {}
+    : numVertices(numVertices) {}
 
 
 void Graph::addVertex(const Airport& airport) {
-    vertices.push_back(airport);
+    vertices.add(airport);
+    coordinates.add(airport.latitude, airport.longitude);
+    spatialIndex.reset(); // the index no longer covers every vertex
+    frozen = false;
 
     // Map the vertex's id to the current index in vertices
     airportToIndex[airport.id] = vertices.size() - 1;
@@ -25,115 +67,205 @@ void Graph::addEdge(const Airport& source, const Airport& dest) {
     size_t destIdx = airportToIndex[dest.id];
 
     // Create edge from source to dest
-    int weight = source.distanceTo(dest);
+    int weight = CompressedAdjacency::packWeight(source.distanceTo(dest));
     Edge edge(srcIdx, destIdx, weight);
 
-    // add edge to the adjacency list mapped at its sources index
-    adjList[srcIdx].push_back(edge);
+    // add edge to the edges waiting to be frozen into the adjacency list
+    pendingEdges.push_back(edge);
     
     // adding the edges that go from dest to source (two-way)
     Edge reverseEdge(destIdx, srcIdx, weight);
-    adjList[destIdx].push_back(reverseEdge);
+    pendingEdges.push_back(reverseEdge);
+    frozen = false;
 }
 
-void Graph::printGraph() const {
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        // output current airport id and name
-        std::cout << "Airport " << vertices[i].id << " (" << vertices[i].name << ") -> ";
-        // iterate over edges for the current airport
-        for (const auto& edge : adjList[i]) {
-            // output destination airport id and name as well as the edge
-            std::cout << vertices[edge.dest].id << " (" << edge.weight << "), ";
+void Graph::freeze() {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t vertexCount = std::max(numVertices, vertices.size());
+    if (pendingEdges.empty() && adjacency.numVertices() == vertexCount) {
+        frozen = true;
+        return;
+    }
+
+    std::vector<Edge> edges;
+    adjacency.appendEdges(edges);
+    edges.insert(edges.end(), pendingEdges.begin(), pendingEdges.end());
+    adjacency = CompressedAdjacency(vertexCount, edges);
+    clearDerivedData();
+
+    pendingEdges.clear();
+    pendingEdges.shrink_to_fit();
+    frozen = true;
+}
+
+void Graph::ensureFrozen() {
+    if (!frozen) {
+        freeze();
+    }
+}
+
+size_t Graph::edgeCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return adjacency.numEdges() + pendingEdges.size();
+}
+
+size_t Graph::adjacencyMemoryBytes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return adjacency.memoryBytes() + pendingEdges.capacity() * sizeof(Edge);
+}
+
+int Graph::getMaxRange() const {
+    return maxRange;
+}
+
+std::vector<std::vector<std::pair<size_t, int>>> Graph::edgesForPrinting() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<std::vector<std::pair<size_t, int>>> rows(vertices.size());
+
+    // frozen edges by destination, then the ones added since in insertion order
+    for (size_t v = 0; v < rows.size() && v < adjacency.numVertices(); ++v) {
+        for (uint32_t e = adjacency.begin(v); e < adjacency.end(v); ++e) {
+            rows[v].push_back({adjacency.neighbor(e), static_cast<int>(adjacency.weight(e))});
         }
-        std::cout << std::endl;
+        std::sort(rows[v].begin(), rows[v].end());
     }
-    
+    for (const Edge& edge : pendingEdges) {
+        rows[edge.source].push_back({edge.dest, CompressedAdjacency::unpackWeight(edge.weight)});
+    }
+    return rows;
+}
+
+void Graph::printGraph() const {
+    printGraph(std::cout);
 }
 
 
 void Graph::printGraph(std::ostream& os) const {
+    std::vector<std::vector<std::pair<size_t, int>>> rows = edgesForPrinting();
     for (size_t i = 0; i < vertices.size(); ++i) {
-        os << "Airport " << vertices[i].id << " (" << vertices[i].name << ") -> ";
-        for (const auto& edge : adjList[i]) {
-            os << vertices[edge.dest].id << " (" << edge.weight << "), ";
+        // output current airport id and name
+        os << "Airport " << vertices.id(i) << " (" << vertices.name(i) << ") -> ";
+        // iterate over edges for the current airport
+        for (const auto& [dest, weight] : rows[i]) {
+            // output destination airport id as well as the edge
+            os << vertices.id(dest) << " (" << weight << "), ";
         }
         os << std::endl;
     }
 }
 
-void Graph::generateAirportGraph(const nlohmann::json& jsonData, const int threshold, bool useMultithreading) {
-    /* Parse airports from json to Airport objects and add them to graph*/ 
-    this->numVertices = jsonData.size(); // numVertices = num airports in airports.json
-    adjList.resize(numVertices); // create enough space for all our airports
-
-    std::vector<Airport> airports; // array will hold our parsed airport objects
+void Graph::generateAirportGraph(const nlohmann::json& jsonData, const int threshold, bool useMultithreading,
+                                 BuildMode mode, size_t numThreads) {
+    generateAirportGraph(AirportTable::fromJson(jsonData), threshold, useMultithreading, mode, numThreads);
+}
 
-    for (const auto& item: jsonData) {
-        Airport airport(
-            item["ident"],
-            item["name"],
-            item["type"],
-            // convert lon and lat from string to double
-            std::stod(item["latitude"].get<std::string>()),
-            std::stod(item["longitude"].get<std::string>())
-        );
+void Graph::generateAirportGraph(const AirportTable& airportTable, const int threshold, bool useMultithreading,
+                                 BuildMode mode, size_t numThreads) {
+    /* Add the table's airports to the graph */
+    this->numVertices = airportTable.size(); // numVertices = num airports in the dataset
+    this->maxRange = threshold;
 
-        airports.push_back(airport);
+    vertices.reserve(vertices.size() + airportTable.size());
+    for (size_t i = 0; i < airportTable.size(); ++i) {
+        vertices.add(airportTable.id(i), airportTable.name(i), airportTable.type(i), airportTable.continent(i),
+                     airportTable.latitude(i), airportTable.longitude(i));
+        coordinates.add(airportTable.latitude(i), airportTable.longitude(i));
 
-        // add the airport as a vertex to our graph
-        this->addVertex(airport);
+        // Map the vertex's id to its index in vertices
+        airportToIndex[std::string(airportTable.id(i))] = vertices.size() - 1;
+    }
+    spatialIndex.reset();
+    frozen = false;
+
+    /**
+     * Find every pair of airports within THRESHOLD. The builder filters pairs with the batched
+     * distance kernel before running haversine, and when multithreading splits the rows into
+     * blocks that threads pull from a work-stealing queue, collecting edges into their own buffers.
+     * It reads the graph's own tables, which now hold the table's airports, so the builder's indices
+     * are vertex indices and the coordinates are not copied a second time.
+     */
+    GraphBuilder builder(vertices, coordinates, threshold, mode);
+    numThreads = useMultithreading ? resolveThreadCount(numThreads) : 1;
+    builder.run(numThreads);
+
+    /**
+     * Scatter the edges into the compressed adjacency list. Every vertex's degree is counted to get
+     * its offset, then threads take blocks of edges and claim each edge's slot in its vertex's row
+     * with an atomic cursor, so every edge is read once whatever the number of threads. The order
+     * within a row depends on the threads, but each row is then sorted by weight and neighbour.
+     */
+    std::vector<Edge> existing;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        adjacency.appendEdges(existing);
+        existing.insert(existing.end(), pendingEdges.begin(), pendingEdges.end());
+        pendingEdges.clear();
     }
 
-    /* Multithreaded version (STILL IN TESTING BUT SHOULD WORK) */
-    if (useMultithreading == true) {
-        auto addEdges = [&](size_t start, size_t end) {
-            for (size_t i = start; i < end; ++i) {
-                for (size_t j = i + 1; j < airports.size(); ++j) {
-                    double distance = airports[i].distanceTo(airports[j]);
+    size_t vertexCount = std::max(numVertices, vertices.size());
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (const Edge& edge : existing) {
+        offsets[edge.source + 1]++;
+    }
+    builder.forEachEdge([&](const BuiltEdge& edge) {
+        offsets[edge.u + 1]++;
+        offsets[edge.v + 1]++;
+    });
+    for (size_t v = 1; v <= vertexCount; ++v) {
+        offsets[v] += offsets[v - 1];
+    }
 
-                    // ensure within THRESHOLD
-                    if (distance <= threshold) {
-                        this->addEdge(airports[i], airports[j]);
-                    }
-                }
-            }
-        };
-
-        // Get number of available threads
-        size_t numThreads = std::thread::hardware_concurrency(); 
-        std::vector<std::thread> threads;
-        size_t chunkSize = airports.size() / numThreads; // range of vertices each thread will be handling
-        
-        // Start the threads
-        for (size_t t = 0; t < numThreads; ++t) {
-            size_t start = t * chunkSize;
-            size_t end = (t = numThreads - 1) ? airports.size() : start + chunkSize;
-            threads.emplace_back(addEdges, start, end); // create thread
-        }
-        
-        for (auto& thread: threads) {
-            thread.join();
-        }
-    } else  {
-        /** 
-         * Iterating through pairs of airports and creating the
-         * edges with distances as the weights.
-         * 
-         * SINGLE THREADED VERSION
-         */ 
-        for (size_t i = 0; i < airports.size(); ++i) {
-            // start at i + 1 to prevent creating an edge to self
-            for (size_t j = i + 1; j < airports.size(); ++j) {
-                double distance = airports[i].distanceTo(airports[j]);
-
-                // ensure distance is within THRESHOLD
-                if (distance <= threshold) {
-                    this->addEdge(airports[i], airports[j]);
-                }
-            }
+    std::vector<uint32_t> neighbors(offsets.back());
+    std::vector<uint32_t> weights(offsets.back());
+    std::unique_ptr<std::atomic<uint32_t>[]> fill(new std::atomic<uint32_t>[vertexCount]);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        fill[v].store(offsets[v], std::memory_order_relaxed);
+    }
+    auto place = [&](size_t from, uint32_t to, uint32_t weight) {
+        uint32_t e = fill[from].fetch_add(1, std::memory_order_relaxed);
+        neighbors[e] = to;
+        weights[e] = weight;
+    };
+
+    // the edges already in the graph are split into blocks of EXISTING_EDGES_PER_TASK, after the builder's blocks
+    const size_t EXISTING_EDGES_PER_TASK = 1 << 16;
+    size_t builtTasks = builder.blockCount();
+    size_t existingTasks = (existing.size() + EXISTING_EDGES_PER_TASK - 1) / EXISTING_EDGES_PER_TASK;
+    runWorkStealing(builtTasks + existingTasks, numThreads, [&](size_t task, size_t) {
+        if (task < builtTasks) {
+            builder.forEachEdgeInBlock(task, [&](const BuiltEdge& edge) {
+                place(edge.u, edge.v, edge.weight);
+                place(edge.v, edge.u, edge.weight);
+            });
+            return;
+        }
+        size_t first = (task - builtTasks) * EXISTING_EDGES_PER_TASK;
+        size_t last = std::min(existing.size(), first + EXISTING_EDGES_PER_TASK);
+        for (size_t i = first; i < last; ++i) {
+            place(existing[i].source, static_cast<uint32_t>(existing[i].dest), static_cast<uint32_t>(existing[i].weight));
         }
+    });
+
+    // rows differ in length, so they are sorted in more blocks than threads and stolen
+    const size_t SORT_BLOCKS_PER_THREAD = 8;
+    size_t sortBlocks = numThreads * SORT_BLOCKS_PER_THREAD;
+    runWorkStealing(sortBlocks, numThreads, [&](size_t block, size_t) {
+        for (size_t v = block * vertexCount / sortBlocks, last = (block + 1) * vertexCount / sortBlocks; v < last; ++v) {
+            // data() + offset, since a graph without edges has nothing to index
+            CompressedAdjacency::sortByWeight(neighbors.data() + offsets[v], weights.data() + offsets[v],
+                                              offsets[v + 1] - offsets[v]);
+        }
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        adjacency = CompressedAdjacency(std::move(offsets), std::move(neighbors), std::move(weights));
+        clearDerivedData();
+        frozen = true;
     }
 
+    // Build the spatial index once up front so position queries never scan every vertex
+    getSpatialIndex();
 }
 
 std::vector<int> Graph::reconstructPath(int last, const std::vector<int>& prev) const {
@@ -144,115 +276,740 @@ std::vector<int> Graph::reconstructPath(int last, const std::vector<int>& prev)
     return path;
 }
 
-std::pair<std::vector<int>, double> Graph::findShortestPathImpl(const Airport& start, const Airport& destination, bool minimizeHops) {
+namespace {
+
+/**
+ * The search of findShortestPathImpl after its direct flight check, on one of the context's queues (templated
+ * so the queue's push and pop are inlined). The context must have been reset.
+ */
+template <typename Queue>
+std::pair<std::vector<int>, double> dijkstraFromSource(const CompressedAdjacency& adj, int srcIdx, int destIdx,
+                                                       bool minimizeHops, uint32_t maxEdgeRange, SearchContext& context,
+                                                       Queue& queue) {
     const int BUFFER = 50;
     int total_distance = 0;
+    // Edges are sorted by weight, so [begin(u), inRange(u)) are the edges of u within the aircraft's range
+    auto inRange = [&](int u) { return adj.rangeEnd(u, maxEdgeRange); };
 
-    int srcIdx = airportToIndex.at(start.id);
-    int destIdx = airportToIndex.at(destination.id);
-
-    // Check for a direct flight first to avoid unneeded landings
-    for (const auto& edge : adjList[srcIdx]) {
-        if (edge.dest == destIdx) {
-            total_distance = edge.weight;
-            return {{destIdx, srcIdx}, total_distance};
-        }
-    }
+    queue.push(0, srcIdx, 0);
+    context.reach(srcIdx, 0, 0, -1);
 
-    using Tuple = std::tuple<int, int, int>;
-    std::priority_queue<Tuple, std::vector<Tuple>, std::greater<Tuple>> pq;
+    while (!queue.empty()) {
+        auto [current_dist, u, current_hops] = queue.pop();
 
-    std::vector<int> dist(numVertices, INT32_MAX);
-    std::vector<int> hops(numVertices, INT32_MAX);
-    std::vector<bool> visited(numVertices, false);
-    std::vector<int> prev(numVertices, -1);
-
-    pq.push(std::make_tuple(0, srcIdx, 0));
-    dist[srcIdx] = 0;
-    hops[srcIdx] = 0;
-
-    while (!pq.empty()) {
-        auto [current_dist, u, current_hops] = pq.top();
-        pq.pop();
-
-        if (visited[u]) {
+        if (context.visited(u)) {
             continue;
         }
-        visited[u] = true;
-
-        for (const auto& edge : adjList[u]) {
-            if (edge.dest == destIdx) {
-                total_distance = dist[u] + edge.weight;
-                std::vector<int> path = reconstructPath(u, prev);
+        context.visit(u);
+        uint32_t last = inRange(u);
+        int distU = context.dist(u);
+
+        for (uint32_t e = adj.begin(u); e < last; ++e) {
+            if (adj.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+                total_distance = distU + adj.weight(e);
+                std::vector<int> path = context.pathTo(u);
                 path.insert(path.begin(), destIdx);
                 return {path, total_distance};
             }
         }
 
-        for (const auto& edge : adjList[u]) {
-            int v = edge.dest;
-            int weight = edge.weight;
+        for (uint32_t e = adj.begin(u); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int weight = adj.weight(e);
+            int distV = context.dist(v);
             bool shouldUpdate = false;
 
             if (minimizeHops) {
-                shouldUpdate = dist[v] > dist[u] + weight;
+                shouldUpdate = distV > distU + weight;
             } else {
-                shouldUpdate = dist[v] > dist[u] + weight ||
-                    (dist[v] <= dist[u] + weight + BUFFER && hops[v] > current_hops + 1);
+                shouldUpdate = distV > distU + weight ||
+                    (distV <= distU + weight + BUFFER && context.hops(v) > current_hops + 1);
             }
 
             if (shouldUpdate) {
-                dist[v] = dist[u] + weight;
                 int nextHops = current_hops + 1;
-                hops[v] = nextHops;
-                pq.push(std::make_tuple(dist[v], v, nextHops));
-                prev[v] = u;
+                context.reach(v, distU + weight, nextHops, u);
+                queue.push(distU + weight, v, nextHops);
             }
         }
     }
 
-    if (dist[destIdx] == INT32_MAX) {
+    if (context.dist(destIdx) == INT32_MAX) {
         return {};
     }
 
-    total_distance = dist[destIdx];
-    return {reconstructPath(destIdx, prev), total_distance};
+    total_distance = context.dist(destIdx);
+    return {context.pathTo(destIdx), total_distance};
+}
+
+// The distance matrix searches cost a route as (distance << MATRIX_HOP_BITS) + flights, so they find the
+// shortest route and, among those, the one with the fewest landings. 12 bits allows 4095 flights.
+const int MATRIX_HOP_BITS = 12;
+
+/**
+ * Dijkstra from src over the edges within maxEdgeRange, costed as above, until it has settled numTargets of the
+ * vertices marked in isTarget. The context must have been reset; its dist holds the costs.
+ */
+template <typename Queue>
+void settleTargets(const CompressedAdjacency& adj, int src, uint32_t maxEdgeRange, const std::vector<char>& isTarget,
+                   size_t numTargets, SearchContext& context, Queue& queue) {
+    context.reach(src, 0, 0, -1);
+    queue.push(0, src, 0);
+    while (!queue.empty() && numTargets > 0) {
+        auto [cost, u, hops] = queue.pop();
+        if (context.visited(u)) {
+            continue;
+        }
+        context.visit(u);
+        if (isTarget[u]) {
+            --numTargets;
+        }
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, maxEdgeRange); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int next = cost + (static_cast<int>(adj.weight(e)) << MATRIX_HOP_BITS) + 1;
+            if (next < context.dist(v)) {
+                context.reach(v, next, hops + 1, u);
+                queue.push(next, v, hops + 1);
+            }
+        }
+    }
+}
+
+/**
+ * Dijkstra from src over the edges within maxEdgeRange, costed as the matrix searches are, that does not go past
+ * maxDistance nm. Appends every vertex it reaches (other than src) to reached. The context must have been reset.
+ */
+template <typename Queue>
+void settleWithin(const CompressedAdjacency& adj, int src, uint32_t maxEdgeRange, int maxDistance, SearchContext& context,
+                  Queue& queue, std::vector<int>& reached) {
+    context.reach(src, 0, 0, -1);
+    queue.push(0, src, 0);
+    while (!queue.empty()) {
+        auto [cost, u, hops] = queue.pop();
+        if (context.visited(u)) {
+            continue;
+        }
+        context.visit(u);
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, maxEdgeRange); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int next = cost + (static_cast<int>(adj.weight(e)) << MATRIX_HOP_BITS) + 1;
+            if ((next >> MATRIX_HOP_BITS) > maxDistance || next >= context.dist(v)) {
+                continue;
+            }
+            if (context.dist(v) == INT32_MAX) {
+                reached.push_back(v);
+            }
+            context.reach(v, next, hops + 1, u);
+            queue.push(next, v, hops + 1);
+        }
+    }
+}
+
+/**
+ * The shortest distance from src to every vertex over at most maxHops edges within maxEdgeRange, no longer than
+ * maxDistance, Bellman-Ford style: layer k relaxes the edges of the vertices whose distance improved in layer
+ * k - 1, from their distances at the start of the layer, so a distance set in layer k uses at most k edges. The
+ * improved vertices are kept in a bitset, so each is relaxed once per layer and in index order. Appends every
+ * vertex it reaches (other than src) to reached. The context must have been reset; its dist holds the distances.
+ */
+void relaxInLayers(const CompressedAdjacency& adj, int src, uint32_t maxEdgeRange, int maxHops, int maxDistance,
+                   SearchContext& context, std::vector<int>& reached) {
+    const size_t numWords = (adj.numVertices() + 63) / 64;
+    std::vector<uint64_t> frontier(numWords, 0);
+    std::vector<uint64_t> improved(numWords, 0);
+    std::vector<std::pair<int, int>> layer; // the frontier's vertices and their distances when the layer starts
+
+    context.reach(src, 0, 0, -1);
+    frontier[src >> 6] |= uint64_t(1) << (src & 63);
+    for (int hops = 1; hops <= maxHops; ++hops) {
+        layer.clear();
+        for (size_t w = 0; w < numWords; ++w) {
+            for (uint64_t bits = frontier[w]; bits != 0; bits &= bits - 1) {
+                int u = static_cast<int>(w * 64 + __builtin_ctzll(bits));
+                layer.emplace_back(u, context.dist(u));
+            }
+            frontier[w] = 0;
+        }
+        if (layer.empty()) {
+            break;
+        }
+
+        for (const auto& [u, distU] : layer) {
+            for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, maxEdgeRange); e < last; ++e) {
+                int v = adj.neighbor(e);
+                int distV = distU + static_cast<int>(adj.weight(e));
+                if (distV > maxDistance || distV >= context.dist(v)) {
+                    continue;
+                }
+                if (context.dist(v) == INT32_MAX) {
+                    reached.push_back(v);
+                }
+                context.reach(v, distV, hops, u);
+                improved[v >> 6] |= uint64_t(1) << (v & 63);
+            }
+        }
+        frontier.swap(improved);
+    }
 }
 
-std::pair<std::vector<int>, double> Graph::findShortestPath(const Airport& start, const Airport& destination) {
-    return findShortestPathImpl(start, destination, false);
 }
 
-std::pair<std::vector<int>, double> Graph::findShortestPathMIN(const Airport& start, const Airport& destination) {
-    return findShortestPathImpl(start, destination, true);
+DistanceMatrix Graph::distanceMatrix(const std::vector<std::string>& sourceIDs, const std::vector<std::string>& targetIDs,
+                                     int range, bool includePaths, size_t numThreads) {
+    WorkStealingPool pool(numThreads);
+    return distanceMatrix(sourceIDs, targetIDs, pool, range, includePaths);
 }
 
+DistanceMatrix Graph::distanceMatrix(const std::vector<std::string>& sourceIDs, const std::vector<std::string>& targetIDs,
+                                     WorkStealingPool& pool, int range, bool includePaths) {
+    auto toIndices = [&](const std::vector<std::string>& ids) {
+        std::vector<int> indices;
+        for (const std::string& id : ids) {
+            int index = getAirportIndex(id);
+            if (index < 0) {
+                throw std::invalid_argument("'" + id + "' is not a valid airport id");
+            }
+            indices.push_back(index);
+        }
+        return indices;
+    };
+    std::vector<int> sources = toIndices(sourceIDs);
+    std::vector<int> targets = toIndices(targetIDs);
+
+    ensureFrozen();
+    if (std::shared_ptr<const ContractionHierarchy> hierarchy = builtContractionHierarchy(range)) {
+        return hierarchy->distanceMatrix(sources, targets, includePaths, pool);
+    }
 
-void Graph::printShortestPath(const std::string startID, const std::string destID, int mode) {
-    Airport startAirport;
-    Airport destAirport;
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    std::vector<char> isTarget(adjacency.numVertices(), 0);
+    size_t numTargets = 0;
+    for (int target : targets) {
+        numTargets += !isTarget[target];
+        isTarget[target] = 1;
+    }
 
-    // ENSURE AIRPORT IDs are valid
-    try
-    {
-        startAirport = vertices[airportToIndex.at(startID)];
+    DistanceMatrix matrix(sources.size(), targets.size(), includePaths);
+    pool.run(sources.size(), [&](size_t s, size_t) {
+        SearchContext& context = threadSearchContext();
+        context.reset(adjacency.numVertices());
+        switch (context.getQueue()) {
+            case SearchQueue::QuaternaryHeap:
+                settleTargets(adjacency, sources[s], maxEdgeRange, isTarget, numTargets, context, context.quaternaryHeap());
+                break;
+            case SearchQueue::RadixHeap:
+                settleTargets(adjacency, sources[s], maxEdgeRange, isTarget, numTargets, context, context.radixHeap());
+                break;
+            default:
+                settleTargets(adjacency, sources[s], maxEdgeRange, isTarget, numTargets, context, context.binaryHeap());
+                break;
+        }
+
+        for (size_t t = 0; t < targets.size(); ++t) {
+            if (!context.visited(targets[t])) {
+                continue;
+            }
+            int cost = context.dist(targets[t]);
+            matrix.set(s, t, static_cast<double>(cost >> MATRIX_HOP_BITS), cost & ((1 << MATRIX_HOP_BITS) - 1));
+            if (includePaths) {
+                matrix.pathAt(s, t) = context.pathTo(targets[t]);
+            }
+        }
+    });
+    return matrix;
+}
+
+ReachableAirports Graph::reachableAirports(const std::string& startID, int maxHops, int maxDistance, int range) {
+    int src = getAirportIndex(startID);
+    if (src < 0) {
+        throw std::invalid_argument("'" + startID + "' is not a valid airport id");
     }
-    catch(const std::exception& e)
-    {
-        std::cout << RED << "'" << startID << "' IS NOT A VALID ID\n";
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    SearchContext& context = threadSearchContext();
+    context.reset(adjacency.numVertices());
+
+    std::vector<int> reached;
+    bool matrixCosts = maxHops == ReachableAirports::NO_LIMIT;
+    if (!matrixCosts) {
+        relaxInLayers(adjacency, src, maxEdgeRange, maxHops, maxDistance, context, reached);
+    } else {
+        switch (context.getQueue()) {
+            case SearchQueue::QuaternaryHeap:
+                settleWithin(adjacency, src, maxEdgeRange, maxDistance, context, context.quaternaryHeap(), reached);
+                break;
+            case SearchQueue::RadixHeap:
+                settleWithin(adjacency, src, maxEdgeRange, maxDistance, context, context.radixHeap(), reached);
+                break;
+            default:
+                settleWithin(adjacency, src, maxEdgeRange, maxDistance, context, context.binaryHeap(), reached);
+                break;
+        }
     }
 
-    try
-    {
-        destAirport = vertices[airportToIndex.at(destID)];
+    // the Dijkstra's costs already order by distance, then flights
+    auto distanceOf = [&](int v) { return matrixCosts ? context.dist(v) >> MATRIX_HOP_BITS : context.dist(v); };
+    std::sort(reached.begin(), reached.end(), [&](int a, int b) {
+        return std::make_tuple(distanceOf(a), context.hops(a), a) < std::make_tuple(distanceOf(b), context.hops(b), b);
+    });
+
+    ReachableAirports airports;
+    airports.reserve(reached.size());
+    for (int v : reached) {
+        airports.add(static_cast<uint32_t>(v), distanceOf(v), context.hops(v));
+    }
+    return airports;
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathImpl(int srcIdx, int destIdx, bool minimizeHops, int range) {
+    return findShortestPathImpl(srcIdx, destIdx, minimizeHops, range, threadSearchContext());
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathImpl(int srcIdx, int destIdx, bool minimizeHops, int range,
+                                                                SearchContext& context) {
+    ensureFrozen();
+    const CompressedAdjacency& adj = adjacency;
+    // a route to the airport it starts at takes no flights, as in every other algorithm (not a round trip)
+    if (srcIdx == destIdx) {
+        return {{srcIdx}, 0};
+    }
+
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    // Edges are sorted by weight, so [begin(u), inRange(u)) are the edges of u within the aircraft's range
+    auto inRange = [&](int u) { return adj.rangeEnd(u, maxEdgeRange); };
+
+    // Check for a direct flight first to avoid unneeded landings
+    for (uint32_t e = adj.begin(srcIdx), last = inRange(srcIdx); e < last; ++e) {
+        if (adj.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+            return {{destIdx, srcIdx}, static_cast<double>(adj.weight(e))};
+        }
+    }
+
+    // the context's arrays read as unreached and its queue is empty, without clearing either
+    context.reset(adj.numVertices());
+    switch (context.getQueue()) {
+        case SearchQueue::QuaternaryHeap:
+            return dijkstraFromSource(adj, srcIdx, destIdx, minimizeHops, maxEdgeRange, context, context.quaternaryHeap());
+        case SearchQueue::RadixHeap:
+            return dijkstraFromSource(adj, srcIdx, destIdx, minimizeHops, maxEdgeRange, context, context.radixHeap());
+        default:
+            return dijkstraFromSource(adj, srcIdx, destIdx, minimizeHops, maxEdgeRange, context, context.binaryHeap());
+    }
+}
+
+SearchContext& Graph::threadSearchContext() {
+    thread_local SearchContext context;
+    return context;
+}
+
+void Graph::computeHeuristicBounds() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (heuristicBoundsReady) {
+        return;
+    }
+
+    /**
+     * An edge's weight is its length truncated to whole miles, so a route can weigh up to a mile per edge less
+     * than its length and the plain great-circle distance is not a lower bound on its weight. Instead, for a
+     * scale s < 1, an edge weighs at least s * length minus its deficit max(0, s * length - weight), which is
+     * only positive for edges shorter than 1 / (1 - s) miles. A route uses each flight at most once, so a route
+     * of length L weighs at least s * L - (the sum of every flight's deficit).
+     * The scale is picked to give the largest bound for a REFERENCE_ROUTE mile route.
+     */
+    const uint32_t SHORT_EDGE = 100; // edges of at least this weight have no deficit for any scale <= 0.99
+    const double REFERENCE_ROUTE = 1000;
+
+    std::vector<std::pair<double, uint32_t>> shortEdges; // (length, weight) of each short flight
+    for (uint32_t u = 0; u < adjacency.numVertices(); ++u) {
+        // rows are sorted by weight, so the short edges are at the start of each row
+        for (uint32_t e = adjacency.begin(u); e < adjacency.end(u) && adjacency.weight(e) < SHORT_EDGE; ++e) {
+            uint32_t v = adjacency.neighbor(e);
+            if (u < v) {
+                double dx = coordinates.x[u] - coordinates.x[v];
+                double dy = coordinates.y[u] - coordinates.y[v];
+                double dz = coordinates.z[u] - coordinates.z[v];
+                double length = 2 * EARTH_RADIUS_NM * std::asin(std::min(1.0, std::sqrt(dx * dx + dy * dy + dz * dz) / 2));
+                shortEdges.push_back({length, adjacency.weight(e)});
+            }
+        }
+    }
+
+    double bestScale = 0;
+    double bestSlack = 0;
+    for (int percent = 50; percent <= 99; ++percent) {
+        double scale = percent / 100.0;
+        double slack = 0;
+        for (const auto& [length, weight] : shortEdges) {
+            slack += std::max(0.0, scale * length - weight);
+        }
+        if (scale * REFERENCE_ROUTE - slack > bestScale * REFERENCE_ROUTE - bestSlack) {
+            bestScale = scale;
+            bestSlack = slack;
+        }
+    }
+
+    // leave room for rounding in the distance computations
+    heuristicScale = bestScale * (1 - 1e-9);
+    heuristicSlack = bestSlack + 1e-6;
+    heuristicBoundsReady = true;
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathAStar(int srcIdx, int destIdx, int range, SearchContext& context) {
+    ensureFrozen();
+    if (!heuristicBoundsReady) {
+        computeHeuristicBounds();
+    }
+    const CompressedAdjacency& adj = adjacency;
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+
+    // Check for a direct flight first to avoid unneeded landings (as the other modes do)
+    for (uint32_t e = adj.begin(srcIdx), last = adj.rangeEnd(srcIdx, maxEdgeRange); e < last; ++e) {
+        if (adj.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+            return {{destIdx, srcIdx}, static_cast<double>(adj.weight(e))};
+        }
+    }
+
+    // lower bound on the weight of the rest of the route from u, from the great-circle distance to the destination
+    const double destX = coordinates.x[destIdx];
+    const double destY = coordinates.y[destIdx];
+    const double destZ = coordinates.z[destIdx];
+    auto heuristic = [&](int u) {
+        double dx = coordinates.x[u] - destX;
+        double dy = coordinates.y[u] - destY;
+        double dz = coordinates.z[u] - destZ;
+        double remaining = 2 * EARTH_RADIUS_NM * std::asin(std::min(1.0, std::sqrt(dx * dx + dy * dy + dz * dz) / 2));
+        return std::max(0.0, heuristicScale * remaining - heuristicSlack);
+    };
+
+    // the context's arrays read as unreached without clearing them. Its binary heap takes any order of keys, which
+    // the other queues do not; reset only empties the queue the context is set to, so it is emptied here too
+    context.reset(adj.numVertices());
+    BinaryHeapQueue& queue = context.binaryHeap();
+    queue.clear(adj.numVertices());
+
+    // (estimated route weight, vertex, weight so far); the heuristic is rounded down, so the estimate stays a lower bound
+    context.reach(srcIdx, 0, 0, -1);
+    queue.push(static_cast<int>(heuristic(srcIdx)), srcIdx, 0);
+
+    while (!queue.empty()) {
+        auto [estimate, u, current_dist] = queue.pop();
+
+        // skip entries made stale by a shorter route to u. The heuristic can be inconsistent across edges
+        // under a mile, so a vertex is expanded again whenever a shorter route to it is found.
+        if (current_dist > context.dist(u)) {
+            continue;
+        }
+        if (u == destIdx) {
+            return {context.pathTo(destIdx), static_cast<double>(current_dist)};
+        }
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, maxEdgeRange); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int nextDist = current_dist + static_cast<int>(adj.weight(e));
+            if (nextDist < context.dist(v)) {
+                context.reach(v, nextDist, 0, u);
+                queue.push(nextDist + static_cast<int>(heuristic(v)), v, nextDist);
+            }
+        }
+    }
+
+    return {};
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathBidirectional(int srcIdx, int destIdx, int range, bool fewestLandings,
+                                                                         bool useTwoThreads) {
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+
+    // Check for a direct flight first to avoid unneeded landings (as the other modes do)
+    for (uint32_t e = adjacency.begin(srcIdx), last = adjacency.rangeEnd(srcIdx, maxEdgeRange); e < last; ++e) {
+        if (adjacency.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+            return {{destIdx, srcIdx}, static_cast<double>(adjacency.weight(e))};
+        }
+    }
+
+    BidirectionalSearch search(adjacency);
+    return search.findPath(srcIdx, destIdx, maxEdgeRange, fewestLandings ? BidirectionalSearch::FEWEST_LANDINGS_PENALTY : 0,
+                           useTwoThreads);
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathBidirectional(const Airport& start, const Airport& destination, int range,
+                                                                         bool fewestLandings, bool useTwoThreads) {
+    return findShortestPathBidirectional(airportToIndex.at(start.id), airportToIndex.at(destination.id), range, fewestLandings,
+                                         useTwoThreads);
+}
+
+std::vector<int> Graph::distancesFrom(const std::string& startID, int range, size_t numThreads, uint32_t bucketWidth) {
+    int src = getAirportIndex(startID);
+    if (src < 0) {
+        throw std::invalid_argument("'" + startID + "' is not a valid airport id");
+    }
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    DeltaStepping search(adjacency, bucketWidth, numThreads);
+    return search.distancesFrom(src, maxEdgeRange);
+}
+
+int Graph::rangeKey(int range) const {
+    // every range that flies every edge shares one key: any range at or above the threshold, unless addEdge added
+    // longer edges, which the ranges below them must not fly
+    return range >= everyEdgeRange ? UNLIMITED_RANGE : std::max(0, range);
+}
+
+bool Graph::mayConnect(int startIdx, int destIdx, int range) {
+    // every flight, added with addEdge or not, needs a range of at least its length, so airports the tree first
+    // connects at a longer range have no route. Up to the threshold the graph has every flight the tree measures,
+    // so the converse holds there too
+    return static_cast<int64_t>(prepareMinimumRangeTree()->minimumRange(startIdx, destIdx)) <= range;
+}
+
+std::shared_ptr<const MinimumRangeTree> Graph::prepareMinimumRangeTree() {
+    ensureFrozen();
+    if (std::shared_ptr<const MinimumRangeTree> tree = std::atomic_load(&minimumRangeTree)) {
+        return tree;
+    }
+    std::lock_guard<std::mutex> lock(minimumRangeTreeMutex);
+    // another thread may have built it while this one waited
+    std::shared_ptr<const MinimumRangeTree> tree = std::atomic_load(&minimumRangeTree);
+    if (!tree) {
+        tree = std::make_shared<const MinimumRangeTree>(MinimumRangeTree::build(vertices, coordinates));
+        std::atomic_store(&minimumRangeTree, tree);
+    }
+    return tree;
+}
+
+std::shared_ptr<const AirportSearchIndex> Graph::prepareSearchIndex() const {
+    std::lock_guard<std::mutex> lock(searchIndexMutex);
+    // airports are only ever added, so an index of as many airports is current
+    if (!searchIndex || searchIndex->size() != vertices.size()) {
+        searchIndex = std::make_shared<const AirportSearchIndex>(AirportSearchIndex::build(vertices));
+    }
+    return searchIndex;
+}
+
+int Graph::minimumRange(const std::string& startID, const std::string& destID) {
+    int startIdx = getAirportIndex(startID);
+    int destIdx = getAirportIndex(destID);
+    if (startIdx < 0 || destIdx < 0) {
+        return -1;
+    }
+    return static_cast<int>(prepareMinimumRangeTree()->minimumRange(startIdx, destIdx));
+}
+
+std::vector<std::pair<std::vector<int>, double>> Graph::findKShortestPaths(int srcIdx, int destIdx, size_t k, int range,
+                                                                          WorkStealingPool& pool) {
+    ensureFrozen();
+    KShortestPaths search(adjacency, pool);
+    return search.findPaths(srcIdx, destIdx, k, range < 0 ? 0 : static_cast<uint32_t>(range));
+}
+
+std::vector<std::pair<std::vector<int>, double>> Graph::findKShortestPaths(const Airport& start, const Airport& destination,
+                                                                          size_t k, int range, size_t numThreads) {
+    WorkStealingPool pool(numThreads);
+    return findKShortestPaths(airportToIndex.at(start.id), airportToIndex.at(destination.id), k, range, pool);
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathWithStops(int srcIdx, int destIdx, int maxStops, int range,
+                                                                     SearchContext& context) {
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    HopConstrainedSearch search(adjacency, context);
+    return search.findPath(srcIdx, destIdx, maxStops + 1, maxEdgeRange);
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathWithStops(const Airport& start, const Airport& destination,
+                                                                     int maxStops, int range) {
+    return findShortestPathWithStops(airportToIndex.at(start.id), airportToIndex.at(destination.id), maxStops, range,
+                                     threadSearchContext());
+}
+
+void Graph::setBidirectionalThreads(bool useTwoThreads) {
+    twoThreadBidirectional = useTwoThreads;
+}
+
+std::shared_ptr<const ContractionHierarchy> Graph::builtContractionHierarchy(int range) {
+    ensureFrozen();
+    return hierarchies.find(rangeKey(range));
+}
+
+bool Graph::hasContractionHierarchy(int range) {
+    return builtContractionHierarchy(range) != nullptr;
+}
+
+std::shared_ptr<const ContractionHierarchy> Graph::prepareContractionHierarchy(int range, size_t numThreads) {
+    ensureFrozen();
+    int key = rangeKey(range);
+    return hierarchies.findOrBuild(key, [&] {
+        return ContractionHierarchy::build(adjacency, static_cast<uint32_t>(key), numThreads);
+    });
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathCH(int srcIdx, int destIdx, int range, SearchContext& context) {
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+
+    // Check for a direct flight first to avoid unneeded landings (as the other modes do)
+    for (uint32_t e = adjacency.begin(srcIdx), last = adjacency.rangeEnd(srcIdx, maxEdgeRange); e < last; ++e) {
+        if (adjacency.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+            return {{destIdx, srcIdx}, static_cast<double>(adjacency.weight(e))};
+        }
+    }
+
+    // a build takes minutes, so a range without a hierarchy gets the same shortest route from A* instead (as the
+    // landmarks do without their table)
+    std::shared_ptr<const ContractionHierarchy> hierarchy = builtContractionHierarchy(range);
+    if (!hierarchy) {
+        return findShortestPathAStar(srcIdx, destIdx, range, context);
+    }
+    return hierarchy->findPath(srcIdx, destIdx);
+}
+
+std::shared_ptr<const LandmarkTable> Graph::prepareLandmarks(int range, size_t numThreads) {
+    ensureFrozen();
+    int key = rangeKey(range);
+    return landmarkTables.findOrBuild(key, [&] {
+        return LandmarkTable::build(adjacency, static_cast<uint32_t>(key), LandmarkTable::DEFAULT_LANDMARKS,
+                                    LandmarkSelection::Avoid, numThreads);
+    });
+}
+
+bool Graph::hasLandmarks(int range) {
+    ensureFrozen();
+    return landmarkTables.find(rangeKey(range)) != nullptr;
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathLandmarks(int srcIdx, int destIdx, int range, SearchContext& context) {
+    ensureFrozen();
+    const CompressedAdjacency& adj = adjacency;
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+
+    // Check for a direct flight first to avoid unneeded landings (as the other modes do)
+    for (uint32_t e = adj.begin(srcIdx), last = adj.rangeEnd(srcIdx, maxEdgeRange); e < last; ++e) {
+        if (adj.neighbor(e) == static_cast<uint32_t>(destIdx)) {
+            return {{destIdx, srcIdx}, static_cast<double>(adj.weight(e))};
+        }
+    }
+
+    // without landmarks for the range, A* with the great-circle distance finds the same shortest route
+    std::shared_ptr<const LandmarkTable> landmarks = landmarkTables.find(rangeKey(range));
+    if (!landmarks) {
+        return findShortestPathAStar(srcIdx, destIdx, range, context);
+    }
+    std::vector<uint32_t> all(landmarks->numLandmarks());
+    for (size_t l = 0; l < all.size(); ++l) {
+        all[l] = static_cast<uint32_t>(l);
+    }
+    if (landmarks->lowerBound(srcIdx, destIdx, all) == LandmarkTable::UNREACHED) {
+        return {}; // a landmark reaches one end but not the other
+    }
+
+    // the landmarks that bound this route best; the bounds are exact route distances, so the heuristic is
+    // consistent and every vertex is expanded once
+    const size_t ACTIVE_LANDMARKS = 4;
+    std::vector<uint32_t> active = landmarks->bestLandmarks(srcIdx, destIdx, ACTIVE_LANDMARKS);
+
+    // the context's arrays read as unreached without clearing them; reset only empties the queue the context is
+    // set to, so its binary heap is emptied here too
+    context.reset(adj.numVertices());
+    BinaryHeapQueue& queue = context.binaryHeap();
+    queue.clear(adj.numVertices());
+
+    // (estimated route weight, vertex, weight so far); a bound is at most the route distance left, so the
+    // estimates fit an int as the distances do
+    context.reach(srcIdx, 0, 0, -1);
+    queue.push(static_cast<int>(landmarks->lowerBound(srcIdx, destIdx, active)), srcIdx, 0);
+
+    while (!queue.empty()) {
+        auto [estimate, u, current_dist] = queue.pop();
+
+        if (current_dist > context.dist(u)) {
+            continue;
+        }
+        if (u == destIdx) {
+            return {context.pathTo(destIdx), static_cast<double>(current_dist)};
+        }
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, maxEdgeRange); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int nextDist = current_dist + static_cast<int>(adj.weight(e));
+            if (nextDist < context.dist(v)) {
+                context.reach(v, nextDist, 0, u);
+                queue.push(nextDist + static_cast<int>(landmarks->lowerBound(v, destIdx, active)), v, nextDist);
+            }
+        }
+    }
+
+    return {};
+}
+
+void Graph::clearDerivedData() {
+    heuristicBoundsReady = false;
+    // each airport's edges are sorted by weight, so its last edge needs the longest range
+    everyEdgeRange = 0;
+    for (size_t v = 0; v < adjacency.numVertices(); ++v) {
+        if (adjacency.end(v) > adjacency.begin(v)) {
+            everyEdgeRange = std::max(everyEdgeRange, static_cast<int>(adjacency.minRange(adjacency.end(v) - 1)));
+        }
     }
-    catch(const std::exception& e)
+    hierarchies.clear();
+    landmarkTables.clear();
     {
+        std::lock_guard<std::mutex> lock(minimumRangeTreeMutex);
+        std::atomic_store(&minimumRangeTree, std::shared_ptr<const MinimumRangeTree>());
+    }
+    std::lock_guard<std::mutex> lock(searchIndexMutex);
+    searchIndex.reset();
+}
+
+std::pair<std::vector<int>, double> Graph::findRoute(int srcIdx, int destIdx, int range, RouteAlgorithm algorithm,
+                                                     SearchContext& context) {
+    switch (algorithm) {
+        case RouteAlgorithm::Distance: return findShortestPathImpl(srcIdx, destIdx, true, range, context);
+        case RouteAlgorithm::AStar: return findShortestPathAStar(srcIdx, destIdx, range, context);
+        case RouteAlgorithm::Bidirectional:
+            return findShortestPathBidirectional(srcIdx, destIdx, range, false, twoThreadBidirectional);
+        case RouteAlgorithm::BidirectionalFewestLandings:
+            return findShortestPathBidirectional(srcIdx, destIdx, range, true, twoThreadBidirectional);
+        case RouteAlgorithm::ContractionHierarchy: return findShortestPathCH(srcIdx, destIdx, range, context);
+        case RouteAlgorithm::Landmarks: return findShortestPathLandmarks(srcIdx, destIdx, range, context);
+        default: return findShortestPathImpl(srcIdx, destIdx, false, range, context);
+    }
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPath(const Airport& start, const Airport& destination, int range,
+                                                            RouteAlgorithm algorithm) {
+    return findShortestPath(start, destination, threadSearchContext(), range, algorithm);
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPath(const Airport& start, const Airport& destination,
+                                                            SearchContext& context, int range, RouteAlgorithm algorithm) {
+    return findRoute(airportToIndex.at(start.id), airportToIndex.at(destination.id), range, algorithm, context);
+}
+
+std::pair<std::vector<int>, double> Graph::findShortestPathMIN(const Airport& start, const Airport& destination, int range) {
+    return findShortestPathImpl(airportToIndex.at(start.id), airportToIndex.at(destination.id), true, range);
+}
+
+
+void Graph::printShortestPath(const std::string startID, const std::string destID, int mode) {
+    // ENSURE AIRPORT IDs are valid
+    int startIdx = getAirportIndex(startID);
+    if (startIdx < 0) {
+        std::cout << RED << "'" << startID << "' IS NOT A VALID ID\n";
+    }
+
+    int destIdx = getAirportIndex(destID);
+    if (destIdx < 0) {
         std::cout << RED << "'" << destID << "' IS NOT A VALID ID\n";
         return; 
     }
+    if (startIdx < 0) {
+        return;
+    }
     
-    std::pair<std::vector<int>, double> res = findShortestPath(startAirport, destAirport);
+    std::pair<std::vector<int>, double> res = findShortestPathImpl(startIdx, destIdx, false, UNLIMITED_RANGE);
 
     // if there was no path, res should be an empty array
     if (res.first.empty()) {
@@ -267,7 +1024,7 @@ void Graph::printShortestPath(const std::string startID, const std::string destI
             if (i != res.first.size() - 1) {
                 std::cout << " -> ";
             }
-            std::cout << vertices[res.first[i]].name;
+            std::cout << vertices.name(res.first[i]);
         }
         std::cout << "\033[33m" << "\n\nTotal distance: ~" << res.second << "nm" << std::endl;
         return;
@@ -279,16 +1036,15 @@ void Graph::printShortestPath(const std::string startID, const std::string destI
         if (i != res.first.size() - 1) {
             std::cout << " -> ";
         }
-        std::cout << vertices[res.first[i]].id;
+        std::cout << vertices.id(res.first[i]);
     }
     std::cout << "\033[33m" << "\n\nTotal distance: ~" << res.second << "nm" << std::endl;
 }
 
 // Ostream version
 void Graph::printShortestPath(const std::string startID, const std::string destID, std::ostream& os) {
-    Airport startAirport = vertices[airportToIndex.at(startID)];
-    Airport destAirport = vertices[airportToIndex.at(destID)];
-    std::pair<std::vector<int>, double> res = findShortestPath(startAirport, destAirport);
+    std::pair<std::vector<int>, double> res = findShortestPathImpl(airportToIndex.at(startID), airportToIndex.at(destID), false,
+                                                                   UNLIMITED_RANGE);
 
     // if there was no path, res should be an empty array
     if (res.first.empty()) {
@@ -302,46 +1058,125 @@ void Graph::printShortestPath(const std::string startID, const std::string destI
         if (i != res.first.size() - 1) {
             os << " -> ";
         }
-        os << vertices[res.first[i]].id;
+        os << vertices.id(res.first[i]);
     }
 }
 
-std::pair<std::vector<std::string>, double> Graph::getShortestPath(const std::string startID, const std::string destID, int mode) {
-    if (!isValidAirport(startID) || !isValidAirport(destID)) {
+std::pair<std::vector<std::string>, double> Graph::getShortestPath(const std::string startID, const std::string destID, int mode,
+                                                                   int range, RouteAlgorithm algorithm) {
+    return getShortestPath(startID, destID, threadSearchContext(), mode, range, algorithm);
+}
+
+std::pair<std::vector<std::string>, double> Graph::getShortestPath(const std::string startID, const std::string destID,
+                                                                   SearchContext& context, int mode, int range,
+                                                                   RouteAlgorithm algorithm) {
+    int startIdx = getAirportIndex(startID);
+    int destIdx = getAirportIndex(destID);
+    if (startIdx < 0 || destIdx < 0) {
         return {};
     }
 
-    Airport startAirport = vertices[airportToIndex.at(startID)];
-    Airport destAirport = vertices[airportToIndex.at(destID)];
-    std::pair<std::vector<int>, double> res = findShortestPath(startAirport, destAirport);
+    // airports the range does not connect have no route between them, however far a search looks
+    if (!mayConnect(startIdx, destIdx, range)) {
+        return {};
+    }
+
+    std::pair<std::vector<int>, double> res = findRoute(startIdx, destIdx, range, algorithm, context);
 
     if (res.first.empty()) {
         return {};
     }
 
-    std::vector<std::string> path;
-    path.reserve(res.first.size());
+    return {pathToStrings(res.first, mode), res.second};
+}
+
+std::pair<std::vector<std::string>, double> Graph::getShortestPathWithStops(const std::string startID, const std::string destID,
+                                                                            int maxStops, int mode, int range) {
+    return getShortestPathWithStops(startID, destID, threadSearchContext(), maxStops, mode, range);
+}
 
-    for (int i = res.first.size() - 1; i >= 0; i--) {
-        const Airport& airport = vertices[res.first[i]];
+std::pair<std::vector<std::string>, double> Graph::getShortestPathWithStops(const std::string startID, const std::string destID,
+                                                                            SearchContext& context, int maxStops, int mode,
+                                                                            int range) {
+    int startIdx = getAirportIndex(startID);
+    int destIdx = getAirportIndex(destID);
+    if (startIdx < 0 || destIdx < 0 || !mayConnect(startIdx, destIdx, range)) {
+        return {};
+    }
+
+    std::pair<std::vector<int>, double> res = findShortestPathWithStops(startIdx, destIdx, maxStops, range, context);
+    if (res.first.empty()) {
+        return {};
+    }
+    return {pathToStrings(res.first, mode), res.second};
+}
+
+std::vector<std::pair<std::vector<std::string>, double>> Graph::getShortestPathsByStops(const std::string startID,
+                                                                                        const std::string destID, int maxStops,
+                                                                                        int mode, int range) {
+    int startIdx = getAirportIndex(startID);
+    int destIdx = getAirportIndex(destID);
+    if (startIdx < 0 || destIdx < 0 || !mayConnect(startIdx, destIdx, range)) {
+        return {};
+    }
+
+    ensureFrozen();
+    uint32_t maxEdgeRange = range < 0 ? 0 : static_cast<uint32_t>(range);
+    HopConstrainedSearch search(adjacency, threadSearchContext());
+    std::vector<std::pair<std::vector<std::string>, double>> routes;
+    for (const auto& [path, distance] : search.findPaths(startIdx, destIdx, maxStops + 1, maxEdgeRange)) {
+        routes.push_back({pathToStrings(path, mode), distance});
+    }
+    return routes;
+}
+
+std::vector<std::pair<std::vector<std::string>, double>> Graph::getKShortestPaths(const std::string startID,
+                                                                                  const std::string destID, size_t k,
+                                                                                  int mode, int range, size_t numThreads) {
+    WorkStealingPool pool(numThreads);
+    return getKShortestPaths(startID, destID, k, pool, mode, range);
+}
+
+std::vector<std::pair<std::vector<std::string>, double>> Graph::getKShortestPaths(const std::string startID,
+                                                                                  const std::string destID, size_t k,
+                                                                                  WorkStealingPool& pool, int mode, int range) {
+    int startIdx = getAirportIndex(startID);
+    int destIdx = getAirportIndex(destID);
+    // airports the range does not connect have no routes, so Yen's first search is skipped too
+    if (startIdx < 0 || destIdx < 0 || !mayConnect(startIdx, destIdx, range)) {
+        return {};
+    }
+
+    std::vector<std::pair<std::vector<std::string>, double>> routes;
+    for (const auto& [path, distance] : findKShortestPaths(startIdx, destIdx, k, range, pool)) {
+        routes.push_back({pathToStrings(path, mode), distance});
+    }
+    return routes;
+}
+
+std::vector<std::string> Graph::pathToStrings(const std::vector<int>& path, int mode) const {
+    std::vector<std::string> names;
+    names.reserve(path.size());
+
+    for (int i = path.size() - 1; i >= 0; i--) {
         if (mode == 1) {
-            path.push_back(airport.name);
+            names.emplace_back(vertices.name(path[i]));
         } else {
-            path.push_back(airport.id);
+            names.emplace_back(vertices.id(path[i]));
         }
     }
-
-    return {path, res.second};
+    return names;
 }
 
 void Graph::toDOT(const std::string& filename) const {
+    std::vector<std::vector<std::pair<size_t, int>>> rows = edgesForPrinting();
     std::ofstream file(filename);
     file << "graph G {\n";
-    for (size_t i = 0; i < adjList.size(); ++i) {
-        for (const auto& edge : adjList[i]) {
-            if (i < edge.dest) {
-                file << "    \"" << vertices[i].id << "\" -- \""
-                     << vertices[edge.dest].id << "\" [label=\"" << edge.weight << "\"];\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (const auto& [dest, weight] : rows[i]) {
+            if (i < dest) {
+                file << "    \"" << vertices.id(i) << "\" -- \""
+                     << vertices.id(dest) << "\" [label=\"" << weight << "\"];\n";
             }
         }
     }
@@ -350,57 +1185,85 @@ void Graph::toDOT(const std::string& filename) const {
 }
 
 std::vector<Airport> Graph::getAirports() const {
-    return this->vertices;
+    std::vector<Airport> airports;
+    airports.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        airports.push_back(vertices.airport(i));
+    }
+    return airports;
+}
+
+const AirportTable& Graph::getAirportTable() const {
+    return vertices;
+}
+
+int Graph::getAirportIndex(const std::string& code) const {
+    auto it = airportToIndex.find(code);
+    return it == airportToIndex.end() ? -1 : static_cast<int>(it->second);
 }
 
 bool Graph::isValidAirport(const std::string& code) const {
-    try {
-        Airport check = vertices[airportToIndex.at(code)];
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return airportToIndex.count(code) != 0;
 }
 
 std::unordered_map<std::string, std::string> Graph::getAirportCodeNames() const {
     std::unordered_map<std::string, std::string> map = {}; // Initialize empty map
-    // We want to get all the airports in the graph
-    std::vector<Airport> airports = this->getAirports();
+    map.reserve(vertices.size());
 
     // for each airport, add to the map {airport.id, airport.name}
-    for (auto airport : airports) {
-        map.insert({airport.id, airport.name});
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        map.emplace(vertices.id(i), vertices.name(i));
     }
 
     return map;
 }
 
 std::string Graph::getAirportNameByCode(const std::string code) const {
-    std::unordered_map<std::string, std::string> airports_map = this->getAirportCodeNames();
-    auto it = airports_map.find(code);
-    if (it != airports_map.end()) {
-        return it->first + ": " + it->second;
-    } else {
+    int index = getAirportIndex(code);
+    if (index < 0) {
         return code + " NOT FOUND";
     }
 
+    std::string result = code;
+    result += ": ";
+    result += vertices.name(index);
+    return result;
 }
 
 std::vector<std::string> Graph::searchAirportCodeByName(const std::string phrase) const {
-    std::unordered_map<std::string, std::string> airports_map = this->getAirportCodeNames();
     std::vector<std::string> matching_airports = {}; // Initialize the matching airports with the airports found so far
 
-    // Convert all phrases to upper case
-    std::string upperPhrase = toUpperCase(phrase);
-
-    for (auto it = airports_map.begin(); it != airports_map.end(); ++it) {
-        // Convert the airport name to uppercase
-        std::string upperValue = toUpperCase(it->second);
-        size_t found = upperValue.find(upperPhrase);
-        if (found != std::string::npos) {
-            matching_airports.push_back(it->first + ": " + it->second);
-        }
+    for (uint32_t i : prepareSearchIndex()->search(phrase, false)) {
+        std::string match(vertices.id(i));
+        match += ": ";
+        match += vertices.name(i);
+        matching_airports.push_back(std::move(match));
     }
 
     return matching_airports;
 }
+
+const KdTree& Graph::getSpatialIndex() const {
+    std::lock_guard<std::mutex> lock(spatialIndexMutex);
+    if (!spatialIndex) {
+        spatialIndex = std::make_unique<KdTree>(vertices, coordinates);
+    }
+    return *spatialIndex;
+}
+
+std::vector<std::pair<Airport, double>> Graph::toAirports(const std::vector<KdTree::Result>& found) const {
+    std::vector<std::pair<Airport, double>> airports;
+    airports.reserve(found.size());
+    for (const auto& [index, distance] : found) {
+        airports.push_back({vertices.airport(index), distance});
+    }
+    return airports;
+}
+
+std::vector<std::pair<Airport, double>> Graph::nearestAirports(double lat, double lon, size_t k) const {
+    return toAirports(getSpatialIndex().nearest(lat, lon, k));
+}
+
+std::vector<std::pair<Airport, double>> Graph::airportsWithinRadius(double lat, double lon, double radiusNm) const {
+    return toAirports(getSpatialIndex().withinRadius(lat, lon, radiusNm));
+}
@@ -0,0 +1,127 @@
+/**
+ * @file: GraphBuilder.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of GraphBuilder
+ */
+#include "GraphBuilder.h"
+#include <algorithm>
+#include "DistanceKernel.h"
+#include "SpatialGrid.h"
+#include "WorkStealing.h"
+
+namespace {
+    // Blocks handed out per worker, enough for stealing to even out rows that turn out denser than others
+    const size_t BLOCKS_PER_THREAD = 16;
+}
+
+GraphBuilder::GraphBuilder(const AirportTable& airports, const CoordinateTable& coordinates,
+                           int threshold, BuildMode mode)
+    : airports(airports), coordinates(coordinates), threshold(threshold), mode(mode) {
+    double maxChord = chordForDistance(threshold);
+    maxChord2 = maxChord * maxChord;
+}
+
+GraphBuilder::~GraphBuilder() = default;
+
+void GraphBuilder::planBlocks(size_t numThreads) {
+    size_t n = airports.size();
+    size_t numBlocks = std::max<size_t>(1, std::min(n, numThreads * BLOCKS_PER_THREAD));
+
+    // Row i of the all pairs loop compares against the n - i - 1 rows after it, so early rows cost far more
+    // than late ones. With the grid each row only looks at its neighbouring cells, so rows cost about the same.
+    auto rowCost = [&](size_t i) -> double {
+        return mode == BuildMode::AllPairs ? static_cast<double>(n - i) : 1.0;
+    };
+
+    double total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += rowCost(i);
+    }
+
+    blockStart.assign(1, 0);
+    double target = total / numBlocks;
+    double acc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        acc += rowCost(i);
+        if (acc >= target * blockStart.size() && blockStart.size() < numBlocks) {
+            blockStart.push_back(i + 1);
+        }
+    }
+    if (blockStart.back() != n) {
+        blockStart.push_back(n);
+    }
+}
+
+void GraphBuilder::buildRow(size_t i, std::vector<BuiltEdge>& out, std::vector<size_t>& candidates,
+                            std::vector<uint32_t>& scratch) const {
+    auto tryPair = [&](size_t j) {
+        double distance = haversine(airports.latitude(i), airports.longitude(i), airports.latitude(j), airports.longitude(j));
+
+        // ensure distance is within THRESHOLD
+        if (distance <= threshold) {
+            out.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j), CompressedAdjacency::packWeight(distance)});
+        }
+    };
+
+    if (mode == BuildMode::SpatialGrid) {
+        grid->candidatesAfter(i, candidates, scratch);
+        for (size_t j : candidates) {
+            tryPair(j);
+        }
+        return;
+    }
+
+    // start at i + 1 to prevent creating an edge to self
+    size_t count = airports.size() - i - 1;
+    const double q[3] = {coordinates.x[i], coordinates.y[i], coordinates.z[i]};
+    scratch.resize(count);
+    size_t found = chordWithin(&coordinates.x[i + 1], &coordinates.y[i + 1], &coordinates.z[i + 1],
+                               count, q, maxChord2, scratch.data());
+    for (size_t h = 0; h < found; ++h) {
+        tryPair(i + 1 + scratch[h]);
+    }
+}
+
+void GraphBuilder::run(size_t numThreads) {
+    numThreads = resolveThreadCount(numThreads);
+    if (mode == BuildMode::SpatialGrid) {
+        grid = std::make_unique<SpatialGrid>(coordinates, threshold);
+    }
+
+    planBlocks(numThreads);
+    size_t numBlocks = blockStart.size() - 1;
+
+    buffers.assign(numThreads, {});
+    std::vector<std::vector<Segment>> workerSegments(numThreads);
+
+    runWorkStealing(numBlocks, numThreads, [&](size_t block, size_t worker) {
+        // scratch space is per thread so rows never share anything mutable
+        thread_local std::vector<size_t> candidates;
+        thread_local std::vector<uint32_t> scratch;
+
+        std::vector<BuiltEdge>& buffer = buffers[worker];
+        size_t begin = buffer.size();
+        for (size_t i = blockStart[block]; i < blockStart[block + 1]; ++i) {
+            buildRow(i, buffer, candidates, scratch);
+        }
+        workerSegments[worker].push_back({block, worker, begin, buffer.size()});
+    });
+
+    // put the blocks back in row order
+    segments.clear();
+    for (const auto& list : workerSegments) {
+        segments.insert(segments.end(), list.begin(), list.end());
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& a, const Segment& b) { return a.block < b.block; });
+    grid.reset();
+}
+
+size_t GraphBuilder::edgeCount() const {
+    size_t count = 0;
+    for (const Segment& segment : segments) {
+        count += segment.end - segment.begin;
+    }
+    return count;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file: GraphSnapshot.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of Graph::saveSnapshot and Graph::loadSnapshot
+ */
+#include "Graph.h"
+#include "GraphSnapshot.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Sections start at multiples of 8 bytes so every array in the mapped file is aligned
+uint64_t alignSection(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// Returns a pointer to count elements of T at offset in the file, checking they fit and are aligned
+template <typename T>
+const T* section(const MappedFile& file, uint64_t offset, uint64_t count, const std::string& filename) {
+    if (offset % alignof(T) != 0 || offset > file.size() || count > (file.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("Snapshot " + filename + " is corrupt (section out of bounds)");
+    }
+    return reinterpret_cast<const T*>(file.data() + offset);
+}
+
+}
+
+void Graph::saveSnapshot(const std::string& filename) {
+    ensureFrozen();
+    std::lock_guard<std::mutex> lock(mtx);
+
+    size_t n = vertices.size();
+    if (adjacency.numVertices() != n) {
+        throw std::runtime_error("Cannot snapshot a graph with " + std::to_string(adjacency.numVertices()) +
+                                 " adjacency rows for " + std::to_string(n) + " airports");
+    }
+
+    // airport records and their strings
+    std::vector<SnapshotAirport> airports(n);
+    std::string strings;
+    auto addString = [&](std::string_view value) {
+        SnapshotString ref = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+        strings += value;
+        return ref;
+    };
+    for (size_t i = 0; i < n; ++i) {
+        SnapshotAirport& airport = airports[i];
+        airport.id = addString(vertices.id(i));
+        airport.name = addString(vertices.name(i));
+        airport.continent = addString(vertices.continent(i));
+        airport.latitude = vertices.latitude(i);
+        airport.longitude = vertices.longitude(i);
+        airport.type = static_cast<uint8_t>(vertices.type(i));
+    }
+
+    std::vector<uint32_t> idIndex(n);
+    std::iota(idIndex.begin(), idIndex.end(), 0);
+    std::sort(idIndex.begin(), idIndex.end(), [&](uint32_t a, uint32_t b) { return vertices.id(a) < vertices.id(b); });
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.maxRange = maxRange;
+    header.numAirports = static_cast<uint32_t>(n);
+    header.numEdges = adjacency.numEdges();
+    header.airportsOffset = alignSection(sizeof(SnapshotHeader));
+    header.idIndexOffset = alignSection(header.airportsOffset + n * sizeof(SnapshotAirport));
+    header.offsetsOffset = alignSection(header.idIndexOffset + n * sizeof(uint32_t));
+    header.neighborsOffset = alignSection(header.offsetsOffset + (n + 1) * sizeof(uint32_t));
+    header.weightsOffset = alignSection(header.neighborsOffset + header.numEdges * sizeof(uint32_t));
+    header.stringsOffset = alignSection(header.weightsOffset + header.numEdges * sizeof(uint32_t));
+    header.stringsSize = strings.size();
+    header.fileSize = header.stringsOffset + header.stringsSize;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open " + filename + " for writing");
+    }
+
+    auto writeAt = [&](uint64_t offset, const void* data, size_t size) {
+        static const char padding[8] = {};
+        file.write(padding, offset - static_cast<uint64_t>(file.tellp()));
+        file.write(static_cast<const char*>(data), size);
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeAt(header.airportsOffset, airports.data(), n * sizeof(SnapshotAirport));
+    writeAt(header.idIndexOffset, idIndex.data(), n * sizeof(uint32_t));
+    writeAt(header.offsetsOffset, adjacency.offsetsData(), (n + 1) * sizeof(uint32_t));
+    writeAt(header.neighborsOffset, adjacency.neighborsData(), header.numEdges * sizeof(uint32_t));
+    writeAt(header.weightsOffset, adjacency.weightsData(), header.numEdges * sizeof(uint32_t));
+    writeAt(header.stringsOffset, strings.data(), strings.size());
+
+    if (!file) {
+        throw std::runtime_error("Could not write " + filename);
+    }
+}
+
+void Graph::loadSnapshot(const std::string& filename) {
+    std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(filename);
+
+    if (file->size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error(filename + " is not a graph snapshot (too small)");
+    }
+    const SnapshotHeader& header = *reinterpret_cast<const SnapshotHeader*>(file->data());
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(filename + " is not a graph snapshot");
+    }
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER) {
+        throw std::runtime_error("Snapshot " + filename + " was written on a machine with a different byte order");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Snapshot " + filename + " has version " + std::to_string(header.version) +
+                                 ", expected " + std::to_string(SNAPSHOT_VERSION) + " (rebuild it with buildSnapshot)");
+    }
+    if (header.fileSize != file->size()) {
+        throw std::runtime_error("Snapshot " + filename + " is truncated");
+    }
+
+    size_t n = header.numAirports;
+    const SnapshotAirport* airports = section<SnapshotAirport>(*file, header.airportsOffset, n, filename);
+    const uint32_t* idIndex = section<uint32_t>(*file, header.idIndexOffset, n, filename);
+    const uint32_t* offsets = section<uint32_t>(*file, header.offsetsOffset, n + 1, filename);
+    const uint32_t* neighbors = section<uint32_t>(*file, header.neighborsOffset, header.numEdges, filename);
+    const uint32_t* weights = section<uint32_t>(*file, header.weightsOffset, header.numEdges, filename);
+    const char* strings = section<char>(*file, header.stringsOffset, header.stringsSize, filename);
+
+    // Check the adjacency once here so queries can trust it
+    if (offsets[0] != 0 || offsets[n] != header.numEdges) {
+        throw std::runtime_error("Snapshot " + filename + " is corrupt (bad adjacency offsets)");
+    }
+    for (size_t v = 0; v < n; ++v) {
+        if (offsets[v] > offsets[v + 1]) {
+            throw std::runtime_error("Snapshot " + filename + " is corrupt (bad adjacency offsets)");
+        }
+    }
+    for (uint64_t e = 0; e < header.numEdges; ++e) {
+        if (neighbors[e] >= n) {
+            throw std::runtime_error("Snapshot " + filename + " is corrupt (edge to a missing airport)");
+        }
+    }
+
+    auto readString = [&](const SnapshotString& ref) {
+        if (ref.offset > header.stringsSize || ref.length > header.stringsSize - ref.offset) {
+            throw std::runtime_error("Snapshot " + filename + " is corrupt (string out of bounds)");
+        }
+        return std::string_view(strings + ref.offset, ref.length);
+    };
+
+    AirportTable loaded;
+    loaded.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const SnapshotAirport& airport = airports[i];
+        if (airport.type > static_cast<uint8_t>(AirportType::Unknown)) {
+            throw std::runtime_error("Snapshot " + filename + " is corrupt (bad airport type)");
+        }
+        loaded.add(readString(airport.id), readString(airport.name), static_cast<AirportType>(airport.type),
+                   readString(airport.continent), airport.latitude, airport.longitude);
+    }
+
+    // the id index lists every vertex once, in increasing id order
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(n);
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t i = idIndex[k];
+        if (i >= n || (k > 0 && !(loaded.id(idIndex[k - 1]) < loaded.id(i)))) {
+            throw std::runtime_error("Snapshot " + filename + " is corrupt (bad id index)");
+        }
+        index.emplace(loaded.id(i), i);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    numVertices = n;
+    maxRange = header.maxRange;
+    vertices = std::move(loaded);
+    airportToIndex = std::move(index);
+    coordinates = CoordinateTable(vertices);
+    pendingEdges.clear();
+    adjacency = CompressedAdjacency::borrow(n, header.numEdges, offsets, neighbors, weights);
+    clearDerivedData();
+    snapshotFile = file;
+    frozen = true;
+    {
+        std::lock_guard<std::mutex> indexLock(spatialIndexMutex);
+        spatialIndex.reset();
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * @file: HopConstrainedSearch.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of HopConstrainedSearch
+ */
+#include "HopConstrainedSearch.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// An airport reached with some number of flights: its distance and the label it was reached from.
+struct Label {
+    int vertex;
+    int dist;
+    int parent; // The index of the label in the previous layer (-1 in layer 0).
+};
+
+/**
+ * Dijkstra from dest over the edges within range, through the vertices within(v) only (those at most maxFlights
+ * flights from dest: a route within the limit never leaves them), until it settles src. The context must have been
+ * reset; its dist holds the distances of the settled vertices. Returns the distance to src, no more than the distance
+ * to dest of any vertex left unsettled.
+ */
+template <typename Queue, typename Within>
+int settleFromDestination(const CompressedAdjacency& adj, int src, int dest, uint32_t range, Within within,
+                          SearchContext& context, Queue& queue) {
+    context.reach(dest, 0, 0, -1);
+    queue.push(0, dest, 0);
+    while (!queue.empty()) {
+        auto [dist, u, hops] = queue.pop();
+        if (context.visited(u)) {
+            continue;
+        }
+        context.visit(u);
+        if (u == src) {
+            return dist;
+        }
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, range); e < last; ++e) {
+            int v = adj.neighbor(e);
+            int next = dist + static_cast<int>(adj.weight(e));
+            if (within(v) && next < context.dist(v)) {
+                context.reach(v, next, hops + 1, u);
+                queue.push(next, v, hops + 1);
+            }
+        }
+    }
+    return INT32_MAX;
+}
+
+}
+
+/**
+ * The state of each vertex in one search, kept between searches. Every entry carries the generation it was written
+ * in, and entries of earlier searches read as their initial values (as in SearchContext).
+ */
+struct HopConstrainedSearch::Workspace {
+    struct Entry {
+        uint32_t generation;
+        int flightsToDest; // The fewest flights from the vertex to dest (INT32_MAX past maxFlights).
+        int best;          // The shortest label of the vertex in the layers so far.
+        int labelLayer;    // The last layer the vertex has a label in.
+        int labelIndex;    // The index of that label in its layer.
+    };
+
+    std::vector<Entry> entries;
+    uint32_t generation = 0;
+    std::vector<int> frontier; // The queue of the breadth-first search.
+
+    // Prepares for a search over numVertices vertices (O(1) unless the graph is larger than before).
+    void reset(size_t numVertices) {
+        if (entries.size() < numVertices) {
+            entries.resize(numVertices, Entry{0, INT32_MAX, INT32_MAX, -1, -1});
+        }
+        // generation 0 marks entries never written, so a wrapped counter clears them
+        if (++generation == 0) {
+            std::fill(entries.begin(), entries.end(), Entry{0, INT32_MAX, INT32_MAX, -1, -1});
+            generation = 1;
+        }
+        frontier.clear();
+    }
+
+    const Entry& get(int v) const {
+        static const Entry UNREACHED{0, INT32_MAX, INT32_MAX, -1, -1};
+        return entries[v].generation == generation ? entries[v] : UNREACHED;
+    }
+
+    // Returns v's entry, reset first if it was last written by an earlier search.
+    Entry& set(int v) {
+        Entry& entry = entries[v];
+        if (entry.generation != generation) {
+            entry = Entry{generation, INT32_MAX, INT32_MAX, -1, -1};
+        }
+        return entry;
+    }
+};
+
+HopConstrainedSearch::HopConstrainedSearch(const CompressedAdjacency& adjacency, SearchContext& context)
+    : adjacency(adjacency), context(context), work(threadWorkspace()) {}
+
+HopConstrainedSearch::Workspace& HopConstrainedSearch::threadWorkspace() {
+    thread_local Workspace workspace;
+    return workspace;
+}
+
+std::pair<std::vector<int>, double> HopConstrainedSearch::findPath(int src, int dest, int maxFlights, uint32_t range) {
+    // a route to the airport it starts at takes no flights, as in every other algorithm (not a round trip)
+    if (src == dest) {
+        return {{src}, 0};
+    }
+    if (maxFlights <= 0 || !boundFromDestination(src, dest, maxFlights, range)) {
+        return {};
+    }
+    // the shortest route through the vertices within the limit's reach is the answer if it is itself within the limit
+    if (context.hops(src) <= maxFlights) {
+        std::vector<int> path = context.pathTo(src);
+        std::reverse(path.begin(), path.end());
+        return {path, static_cast<double>(srcToDest)};
+    }
+    std::vector<std::pair<std::vector<int>, double>> routes = searchLayers(src, dest, maxFlights, range);
+    if (routes.empty()) {
+        return {};
+    }
+    return routes.back();
+}
+
+std::vector<std::pair<std::vector<int>, double>> HopConstrainedSearch::findPaths(int src, int dest, int maxFlights,
+                                                                               uint32_t range) {
+    if (src == dest) {
+        return {{{src}, 0}};
+    }
+    if (maxFlights <= 0 || !boundFromDestination(src, dest, maxFlights, range)) {
+        return {};
+    }
+    return searchLayers(src, dest, maxFlights, range);
+}
+
+bool HopConstrainedSearch::boundFromDestination(int src, int dest, int maxFlights, uint32_t range) {
+    const size_t n = adjacency.numVertices();
+
+    // the fewest flights from every vertex within maxFlights of dest (flights go both ways, so by a search from dest)
+    work.reset(n);
+    std::vector<int>& frontier = work.frontier;
+    frontier.push_back(dest);
+    work.set(dest).flightsToDest = 0;
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        int u = frontier[head];
+        int flights = work.get(u).flightsToDest;
+        if (flights == maxFlights) {
+            continue;
+        }
+        for (uint32_t e = adjacency.begin(u), last = adjacency.rangeEnd(u, range); e < last; ++e) {
+            int v = adjacency.neighbor(e);
+            if (work.get(v).flightsToDest == INT32_MAX) {
+                work.set(v).flightsToDest = flights + 1;
+                frontier.push_back(v);
+            }
+        }
+    }
+    if (work.get(src).flightsToDest > maxFlights) {
+        return false;
+    }
+
+    // the distance to dest through those vertices, a lower bound on the rest of any route within the limit
+    auto within = [&](int v) { return work.get(v).flightsToDest <= maxFlights; };
+    context.reset(n);
+    switch (context.getQueue()) {
+        case SearchQueue::QuaternaryHeap:
+            srcToDest = settleFromDestination(adjacency, src, dest, range, within, context, context.quaternaryHeap());
+            break;
+        case SearchQueue::RadixHeap:
+            srcToDest = settleFromDestination(adjacency, src, dest, range, within, context, context.radixHeap());
+            break;
+        default:
+            srcToDest = settleFromDestination(adjacency, src, dest, range, within, context, context.binaryHeap());
+            break;
+    }
+    return true;
+}
+
+std::vector<std::pair<std::vector<int>, double>> HopConstrainedSearch::searchLayers(int src, int dest, int maxFlights,
+                                                                                  uint32_t range) {
+    // the Dijkstra stopped at src, so the vertices it did not settle are at least as far from dest as src is
+    auto toDest = [&](int v) { return context.visited(v) ? context.dist(v) : srcToDest; };
+
+    std::vector<std::pair<std::vector<int>, double>> result;
+    std::vector<std::vector<Label>> layers(1, std::vector<Label>{{src, 0, -1}});
+    work.set(src).best = 0;
+    int shortest = INT32_MAX;
+
+    // once a route is as short as src's bound, no number of flights gives a shorter one
+    for (int flights = 1; flights <= maxFlights && !layers.back().empty() && shortest > srcToDest; ++flights) {
+        std::vector<Label> layer;
+        const std::vector<Label>& previous = layers.back();
+        for (size_t i = 0; i < previous.size(); ++i) {
+            const Label& label = previous[i];
+            if (label.vertex == dest) {
+                continue;
+            }
+            for (uint32_t e = adjacency.begin(label.vertex), last = adjacency.rangeEnd(label.vertex, range); e < last; ++e) {
+                int v = adjacency.neighbor(e);
+                int dist = label.dist + static_cast<int>(adjacency.weight(e));
+                const Workspace::Entry& state = work.get(v);
+                // too many flights to finish, dominated by a label with fewer flights, or no shorter than a route found
+                if (state.flightsToDest > maxFlights - flights || dist >= state.best ||
+                    static_cast<long long>(dist) + toDest(v) >= shortest) {
+                    continue;
+                }
+                Workspace::Entry& entry = work.set(v);
+                entry.best = dist;
+                if (entry.labelLayer == flights) {
+                    layer[entry.labelIndex] = {v, dist, static_cast<int>(i)};
+                } else {
+                    entry.labelLayer = flights;
+                    entry.labelIndex = static_cast<int>(layer.size());
+                    layer.push_back({v, dist, static_cast<int>(i)});
+                }
+            }
+        }
+        layers.push_back(std::move(layer));
+
+        const Workspace::Entry& arrival = work.get(dest);
+        if (arrival.labelLayer == flights) {
+            shortest = arrival.best;
+            std::vector<int> path;
+            for (int k = flights, index = arrival.labelIndex; k >= 0; --k) {
+                const Label& label = layers[k][index];
+                path.push_back(label.vertex);
+                index = label.parent;
+            }
+            result.push_back({path, static_cast<double>(shortest)});
+        }
+    }
+    return result;
+}
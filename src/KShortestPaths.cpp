@@ -0,0 +1,186 @@
+/**
+ * @file: KShortestPaths.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of KShortestPaths
+ */
+#include "KShortestPaths.h"
+#include "WorkStealing.h"
+#include <algorithm>
+#include <set>
+#include <climits>
+
+namespace {
+
+// A route from the start to the destination.
+struct Route {
+    std::vector<int> path;  // The vertices from the start to the destination.
+    std::vector<int> costs; // costs[i] is the distance along the route from the start to path[i].
+    size_t spur = 0;        // The index in path at which the route left the route it was found from.
+
+    int cost() const { return costs.back(); }
+};
+
+/**
+ * A* from spur to dest over the edges within range, never entering a visited vertex nor flying from spur to a
+ * vertex in blockedNext, guided by toDest (the distance from each vertex to dest with nothing avoided, INT32_MAX
+ * where dest cannot be reached). Avoiding vertices and flights only makes routes longer, so toDest is a
+ * consistent lower bound, and an exact one wherever the shortest route to dest avoids nothing.
+ * Without toDest (nullptr) this is Dijkstra, which settles every vertex it can reach when dest is -1.
+ * The context must have been reset, with the vertices to avoid marked visited.
+ * Returns the distance to dest, or -1 if it cannot be reached.
+ */
+template <typename Queue>
+int searchFromSpur(const CompressedAdjacency& adj, int spur, int dest, uint32_t range, const std::vector<int>& blockedNext,
+                   const int* toDest, SearchContext& context, Queue& queue) {
+    auto bound = [&](int v) { return toDest ? toDest[v] : 0; };
+    if (bound(spur) == INT32_MAX) {
+        return -1;
+    }
+    context.reach(spur, 0, 0, -1);
+    queue.push(bound(spur), spur, 0);
+    while (!queue.empty()) {
+        auto [key, u, hops] = queue.pop();
+        if (context.visited(u)) {
+            continue;
+        }
+        int dist = context.dist(u);
+        if (u == dest) {
+            return dist;
+        }
+        context.visit(u);
+
+        for (uint32_t e = adj.begin(u), last = adj.rangeEnd(u, range); e < last; ++e) {
+            int v = adj.neighbor(e);
+            if (context.visited(v) || bound(v) == INT32_MAX ||
+                (u == spur && std::find(blockedNext.begin(), blockedNext.end(), v) != blockedNext.end())) {
+                continue;
+            }
+            int next = dist + static_cast<int>(adj.weight(e));
+            if (next < context.dist(v)) {
+                context.reach(v, next, hops + 1, u);
+                queue.push(next + bound(v), v, hops + 1);
+            }
+        }
+    }
+    return -1;
+}
+
+// Runs searchFromSpur on the context's queue.
+int searchFromSpur(const CompressedAdjacency& adj, int spur, int dest, uint32_t range, const std::vector<int>& blockedNext,
+                   const int* toDest, SearchContext& context) {
+    switch (context.getQueue()) {
+        case SearchQueue::QuaternaryHeap:
+            return searchFromSpur(adj, spur, dest, range, blockedNext, toDest, context, context.quaternaryHeap());
+        case SearchQueue::RadixHeap:
+            return searchFromSpur(adj, spur, dest, range, blockedNext, toDest, context, context.radixHeap());
+        default:
+            return searchFromSpur(adj, spur, dest, range, blockedNext, toDest, context, context.binaryHeap());
+    }
+}
+
+// Returns the calling thread's context, kept for every search the thread runs.
+SearchContext& threadContext() {
+    thread_local SearchContext context;
+    return context;
+}
+
+/**
+ * Returns the route that follows root up to its vertex at index spur and then takes the shortest path to dest
+ * avoiding root's earlier vertices and the flights from the spur to blockedNext, or an empty route if there is none.
+ */
+Route spurRoute(const CompressedAdjacency& adj, const Route& root, size_t spur, int dest, uint32_t range,
+                const std::vector<int>& blockedNext, const std::vector<int>& toDest, SearchContext& context) {
+    context.reset(adj.numVertices());
+    for (size_t i = 0; i < spur; ++i) {
+        context.visit(root.path[i]);
+    }
+
+    if (searchFromSpur(adj, root.path[spur], dest, range, blockedNext, toDest.data(), context) < 0) {
+        return {};
+    }
+
+    Route route;
+    route.path.assign(root.path.begin(), root.path.begin() + spur);
+    route.costs.assign(root.costs.begin(), root.costs.begin() + spur);
+    std::vector<int> tail = context.pathTo(dest);
+    for (auto it = tail.rbegin(); it != tail.rend(); ++it) {
+        route.path.push_back(*it);
+        route.costs.push_back(root.costs[spur] + context.dist(*it));
+    }
+    route.spur = spur;
+    return route;
+}
+
+}
+
+std::vector<std::pair<std::vector<int>, double>> KShortestPaths::findPaths(int src, int dest, size_t k, uint32_t range) {
+    std::vector<std::pair<std::vector<int>, double>> result;
+    if (k == 0 || src == dest) {
+        return result;
+    }
+
+    // the distance from every vertex to dest (flights go both ways, so they are found by a search from dest)
+    const size_t numVertices = adjacency.numVertices();
+    SearchContext& context = threadContext();
+    context.reset(numVertices);
+    searchFromSpur(adjacency, dest, -1, range, {}, nullptr, context);
+    std::vector<int> toDest(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        toDest[v] = context.dist(v);
+    }
+
+    // the first route is the shortest path from the start, with nothing avoided
+    Route start;
+    start.path = {src};
+    start.costs = {0};
+    std::vector<Route> found;
+    found.push_back(spurRoute(adjacency, start, 0, dest, range, {}, toDest, context));
+    if (found.back().path.empty()) {
+        return result;
+    }
+
+    std::vector<Route> candidates;
+    std::set<std::vector<int>> seen = {found.back().path};
+    while (found.size() < k) {
+        const Route& previous = found.back();
+        const size_t firstSpur = previous.spur;
+        const size_t numSpurs = previous.path.size() - 1 - firstSpur;
+
+        std::vector<Route> spurs(numSpurs);
+        pool.run(numSpurs, [&](size_t task, size_t) {
+            size_t spur = firstSpur + task;
+            // the next flight of every route found that starts the same way, so the new route leaves them all here
+            std::vector<int> blockedNext;
+            for (const Route& route : found) {
+                if (route.path.size() > spur + 1 &&
+                    std::equal(previous.path.begin(), previous.path.begin() + spur + 1, route.path.begin())) {
+                    blockedNext.push_back(route.path[spur + 1]);
+                }
+            }
+            spurs[task] = spurRoute(adjacency, previous, spur, dest, range, blockedNext, toDest, threadContext());
+        });
+
+        for (Route& route : spurs) {
+            if (!route.path.empty() && seen.insert(route.path).second) {
+                candidates.push_back(std::move(route));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        // the shortest candidate (ties broken by path, so the order does not depend on the threads)
+        auto best = std::min_element(candidates.begin(), candidates.end(), [](const Route& a, const Route& b) {
+            return a.cost() != b.cost() ? a.cost() < b.cost() : a.path < b.path;
+        });
+        found.push_back(std::move(*best));
+        *best = std::move(candidates.back());
+        candidates.pop_back();
+    }
+
+    for (const Route& route : found) {
+        result.push_back({std::vector<int>(route.path.rbegin(), route.path.rend()), static_cast<double>(route.cost())});
+    }
+    return result;
+}
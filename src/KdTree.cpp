@@ -0,0 +1,180 @@
+/**
+ * @file: KdTree.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of KdTree
+ */
+#include "KdTree.h"
+#include <algorithm>
+#include "DistanceKernel.h"
+
+namespace {
+    // Maximum number of points stored in a leaf
+    const uint32_t LEAF_SIZE = 16;
+
+    void toUnitVector(double lat, double lon, double out[3]) {
+        double phi = toRadians(lat);
+        double lambda = toRadians(lon);
+        out[0] = std::cos(phi) * std::cos(lambda);
+        out[1] = std::cos(phi) * std::sin(lambda);
+        out[2] = std::sin(phi);
+    }
+}
+
+KdTree::KdTree(const AirportTable& airports, const CoordinateTable& coordinates)
+    : airports(airports), order(coordinates.size()) {
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    nodes.reserve(2 * (order.size() / LEAF_SIZE + 1));
+    build(0, static_cast<uint32_t>(order.size()), coordinates);
+
+    // Store the coordinates in tree order so the points of a leaf are contiguous
+    xs.resize(order.size());
+    ys.resize(order.size());
+    zs.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        xs[i] = coordinates.x[order[i]];
+        ys[i] = coordinates.y[order[i]];
+        zs[i] = coordinates.z[order[i]];
+    }
+}
+
+uint32_t KdTree::build(uint32_t begin, uint32_t end, const CoordinateTable& coordinates) {
+    uint32_t id = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({begin, end, 0, 0, 0, 0.0});
+
+    if (end - begin <= LEAF_SIZE) {
+        return id;
+    }
+
+    const std::vector<double>* axes[3] = {&coordinates.x, &coordinates.y, &coordinates.z};
+
+    // split on the axis with the widest spread
+    double lo[3] = {2, 2, 2}, hi[3] = {-2, -2, -2};
+    for (uint32_t i = begin; i < end; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], (*axes[a])[order[i]]);
+            hi[a] = std::max(hi[a], (*axes[a])[order[i]]);
+        }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (hi[a] - lo[a] > hi[axis] - lo[axis]) axis = a;
+    }
+
+    const std::vector<double>& values = *axes[axis];
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+
+    double split = values[order[mid]];
+    uint32_t left = build(begin, mid, coordinates);
+    uint32_t right = build(mid, end, coordinates);
+
+    nodes[id].axis = axis;
+    nodes[id].split = split;
+    nodes[id].left = left;
+    nodes[id].right = right;
+    return id;
+}
+
+void KdTree::nearestImpl(uint32_t node, const double q[3], size_t k,
+                         std::vector<std::pair<double, uint32_t>>& heap) const {
+    const Node& n = nodes[node];
+    if (n.left == 0) {
+        double d2[LEAF_SIZE];
+        chordDistances2(&xs[n.begin], &ys[n.begin], &zs[n.begin], n.end - n.begin, q, d2);
+
+        for (uint32_t i = n.begin; i < n.end; ++i) {
+            double d = d2[i - n.begin];
+            if (heap.size() < k) {
+                heap.push_back({d, i});
+                std::push_heap(heap.begin(), heap.end());
+            } else if (d < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d, i};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    // visit the side containing the query first, then the other side if it can still hold a closer point
+    double diff = q[n.axis] - n.split;
+    uint32_t nearChild = diff < 0 ? n.left : n.right;
+    uint32_t farChild = diff < 0 ? n.right : n.left;
+
+    nearestImpl(nearChild, q, k, heap);
+    if (heap.size() < k || diff * diff < heap.front().first) {
+        nearestImpl(farChild, q, k, heap);
+    }
+}
+
+void KdTree::radiusImpl(uint32_t node, const double q[3], double maxChord2,
+                        std::vector<std::pair<double, uint32_t>>& out) const {
+    const Node& n = nodes[node];
+    if (n.left == 0) {
+        uint32_t hits[LEAF_SIZE];
+        size_t found = chordWithin(&xs[n.begin], &ys[n.begin], &zs[n.begin], n.end - n.begin, q, maxChord2, hits);
+        for (size_t h = 0; h < found; ++h) {
+            out.push_back({0.0, n.begin + hits[h]});
+        }
+        return;
+    }
+
+    double diff = q[n.axis] - n.split;
+    if (diff < 0 || diff * diff <= maxChord2) {
+        radiusImpl(n.left, q, maxChord2, out);
+    }
+    if (diff >= 0 || diff * diff <= maxChord2) {
+        radiusImpl(n.right, q, maxChord2, out);
+    }
+}
+
+std::vector<KdTree::Result> KdTree::toResults(std::vector<std::pair<double, uint32_t>>& found,
+                                              double lat, double lon) const {
+    std::vector<Result> results;
+    results.reserve(found.size());
+    for (const auto& [d, i] : found) {
+        results.push_back({order[i], haversine(lat, lon, airports.latitude(order[i]), airports.longitude(order[i]))});
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const Result& a, const Result& b) { return a.second < b.second || (a.second == b.second && a.first < b.first); });
+    return results;
+}
+
+std::vector<KdTree::Result> KdTree::nearest(double lat, double lon, size_t k) const {
+    std::vector<std::pair<double, uint32_t>> heap;
+    if (k == 0 || order.empty()) {
+        return {};
+    }
+
+    double q[3];
+    toUnitVector(lat, lon, q);
+    heap.reserve(std::min(k, order.size()));
+    nearestImpl(0, q, k, heap);
+
+    return toResults(heap, lat, lon);
+}
+
+std::vector<KdTree::Result> KdTree::withinRadius(double lat, double lon, double radiusNm) const {
+    std::vector<std::pair<double, uint32_t>> found;
+    if (radiusNm < 0 || order.empty()) {
+        return {};
+    }
+
+    double q[3];
+    double maxChord = chordForDistance(radiusNm);
+    toUnitVector(lat, lon, q);
+    radiusImpl(0, q, maxChord * maxChord, found);
+
+    // drop anything the padding of the chord threshold let in that is outside the radius by the haversine distance
+    std::vector<Result> results = toResults(found, lat, lon);
+    results.erase(std::remove_if(results.begin(), results.end(),
+                                 [&](const Result& r) { return r.second > radiusNm; }),
+                  results.end());
+    return results;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file: LandmarkTable.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of LandmarkTable
+ */
+#include "LandmarkTable.h"
+#include "WorkStealing.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+
+namespace {
+
+/**
+ * One-to-all Dijkstra from root over the edges within range. Fills dist (UNREACHED where there is no route)
+ * and, if given, the parent of each vertex in the shortest path tree and the order vertices were settled in.
+ */
+void shortestPathTree(const CompressedAdjacency& adjacency, uint32_t range, uint32_t root, std::vector<uint32_t>& dist,
+                      std::vector<uint32_t>* parent = nullptr, std::vector<uint32_t>* order = nullptr) {
+    const size_t numVertices = adjacency.numVertices();
+    dist.assign(numVertices, LandmarkTable::UNREACHED);
+    if (parent) {
+        parent->assign(numVertices, LandmarkTable::UNREACHED);
+    }
+    if (order) {
+        order->clear();
+    }
+
+    using Entry = std::pair<uint32_t, uint32_t>; // (distance, vertex)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    dist[root] = 0;
+    pq.push({0, root});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) {
+            continue;
+        }
+        if (order) {
+            order->push_back(u);
+        }
+        for (uint32_t e = adjacency.begin(u), last = adjacency.rangeEnd(u, range); e < last; ++e) {
+            uint32_t v = adjacency.neighbor(e);
+            uint32_t next = d + adjacency.weight(e);
+            if (next < dist[v]) {
+                dist[v] = next;
+                if (parent) {
+                    (*parent)[v] = u;
+                }
+                pq.push({next, v});
+            }
+        }
+    }
+}
+
+// |a - b|, or 0 if either is unreached (the landmark says nothing about the pair).
+uint32_t landmarkBound(uint32_t a, uint32_t b) {
+    if (a == LandmarkTable::UNREACHED || b == LandmarkTable::UNREACHED) {
+        return 0;
+    }
+    return a > b ? a - b : b - a;
+}
+
+}
+
+LandmarkTable LandmarkTable::build(const CompressedAdjacency& adjacency, uint32_t range, size_t numLandmarks,
+                                   LandmarkSelection selection, size_t numThreads) {
+    numThreads = resolveThreadCount(numThreads);
+    const size_t numVertices = adjacency.numVertices();
+    numLandmarks = std::min(numLandmarks, numVertices);
+
+    LandmarkTable table;
+    table.range = range;
+    if (numLandmarks == 0) {
+        return table;
+    }
+
+    // Each part of the network (e.g. each continent, when the range cannot cross the oceans) gets landmarks in
+    // proportion to its airports, and the rest go to the largest part; small islands get none.
+    std::vector<std::vector<uint32_t>> components;
+    std::vector<char> seen(numVertices, 0);
+    for (size_t start = 0; start < numVertices; ++start) {
+        if (seen[start]) {
+            continue;
+        }
+        std::vector<uint32_t> component = {static_cast<uint32_t>(start)};
+        seen[start] = 1;
+        for (size_t k = 0; k < component.size(); ++k) {
+            for (uint32_t e = adjacency.begin(component[k]), last = adjacency.rangeEnd(component[k], range); e < last; ++e) {
+                uint32_t v = adjacency.neighbor(e);
+                if (!seen[v]) {
+                    seen[v] = 1;
+                    component.push_back(v);
+                }
+            }
+        }
+        components.push_back(std::move(component));
+    }
+    std::sort(components.begin(), components.end(),
+              [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) { return a.size() > b.size(); });
+
+    std::vector<size_t> quota(components.size());
+    size_t assigned = 0;
+    for (size_t c = 0; c < components.size(); ++c) {
+        quota[c] = numLandmarks * components[c].size() / numVertices;
+        assigned += quota[c];
+    }
+    quota[0] += numLandmarks - assigned;
+
+    std::vector<std::vector<uint32_t>> rows; // rows[l][v] = distance from landmark l to v
+    std::vector<char> isLandmark(numVertices, 0);
+
+    // lower bound between u and v from the landmarks chosen so far
+    auto boundBetween = [&](uint32_t u, uint32_t v) {
+        uint32_t bound = 0;
+        for (const std::vector<uint32_t>& row : rows) {
+            bound = std::max(bound, landmarkBound(row[u], row[v]));
+        }
+        return bound;
+    };
+
+    auto addLandmark = [&](uint32_t v) {
+        table.landmarks.push_back(v);
+        isLandmark[v] = 1;
+    };
+
+    std::mt19937 rng(1);
+    for (size_t c = 0; c < components.size() && quota[c] > 0; ++c) {
+        const std::vector<uint32_t>& component = components[c];
+        const size_t target = table.landmarks.size() + std::min(quota[c], component.size());
+
+        // start from the part's airport with the most flights
+        uint32_t seed = component[0];
+        for (uint32_t v : component) {
+            if (adjacency.rangeEnd(v, range) - adjacency.begin(v) > adjacency.rangeEnd(seed, range) - adjacency.begin(seed)) {
+                seed = v;
+            }
+        }
+
+        if (selection == LandmarkSelection::Farthest) {
+            // each landmark needs the distances of the ones before it, so they are found one at a time
+            std::vector<uint32_t> nearest; // distance to the nearest landmark (to the seed before the first)
+            shortestPathTree(adjacency, range, seed, nearest);
+            const size_t before = table.landmarks.size();
+            while (table.landmarks.size() < target) {
+                uint32_t farthest = component[0];
+                for (uint32_t v : component) {
+                    if (nearest[v] > nearest[farthest]) {
+                        farthest = v;
+                    }
+                }
+                if (isLandmark[farthest]) {
+                    break;
+                }
+                addLandmark(farthest);
+                rows.emplace_back();
+                shortestPathTree(adjacency, range, farthest, rows.back());
+                for (uint32_t v : component) {
+                    nearest[v] = table.landmarks.size() == before + 1 ? rows.back()[v] : std::min(nearest[v], rows.back()[v]);
+                }
+            }
+            continue;
+        }
+
+        // Rounds of one landmark per thread: grow a shortest path tree from a random root on each thread, then
+        // walk each tree from its root into the heaviest subtree, weighing a vertex by how far its distance from
+        // the root exceeds the landmarks' bound and skipping subtrees that already hold a landmark.
+        bool first = true;
+        int misses = 0;
+        while (table.landmarks.size() < target) {
+            size_t roundSize = std::min(numThreads, target - table.landmarks.size());
+            std::vector<uint32_t> roots(roundSize);
+            for (size_t i = 0; i < roundSize; ++i) {
+                roots[i] = first && i == 0 ? seed : component[rng() % component.size()];
+            }
+            first = false;
+
+            std::vector<std::vector<uint32_t>> rootDist(roundSize), parent(roundSize), order(roundSize);
+            runWorkStealing(roundSize, numThreads, [&](size_t i, size_t) {
+                shortestPathTree(adjacency, range, roots[i], rootDist[i], &parent[i], &order[i]);
+            });
+
+            size_t before = table.landmarks.size();
+            std::vector<uint64_t> size(numVertices);
+            std::vector<uint32_t> heaviestChild(numVertices);
+            for (size_t i = 0; i < roundSize; ++i) {
+                // children are settled after their parents, so sizes are summed in reverse settle order
+                for (uint32_t v : order[i]) {
+                    size[v] = rootDist[i][v] - std::min(rootDist[i][v], boundBetween(roots[i], v));
+                    heaviestChild[v] = UNREACHED;
+                }
+                std::vector<char> holdsLandmark(numVertices, 0);
+                for (auto it = order[i].rbegin(); it != order[i].rend(); ++it) {
+                    uint32_t v = *it;
+                    if (isLandmark[v]) {
+                        holdsLandmark[v] = 1;
+                    }
+                    if (holdsLandmark[v]) {
+                        size[v] = 0;
+                    }
+                    uint32_t p = parent[i][v];
+                    if (p != UNREACHED) {
+                        holdsLandmark[p] |= holdsLandmark[v];
+                        size[p] += size[v];
+                        if (size[v] > 0 && (heaviestChild[p] == UNREACHED || size[v] > size[heaviestChild[p]])) {
+                            heaviestChild[p] = v;
+                        }
+                    }
+                }
+
+                // the root's tree spans its part of the network, so the walk starts below the root
+                uint32_t at = roots[i];
+                while (heaviestChild[at] != UNREACHED) {
+                    at = heaviestChild[at];
+                }
+                if (!isLandmark[at] && at != roots[i]) {
+                    addLandmark(at);
+                }
+            }
+            if (table.landmarks.size() == before) {
+                // the landmarks already bound every branch of these trees; try other roots a few times
+                if (++misses == 8) {
+                    break;
+                }
+                continue;
+            }
+
+            rows.resize(table.landmarks.size());
+            runWorkStealing(table.landmarks.size() - before, numThreads, [&](size_t i, size_t) {
+                shortestPathTree(adjacency, range, table.landmarks[before + i], rows[before + i]);
+            });
+        }
+    }
+
+    // store the distances vertex by vertex
+    const size_t count = table.landmarks.size();
+    table.distances.resize(numVertices * count);
+    for (size_t l = 0; l < count; ++l) {
+        for (size_t v = 0; v < numVertices; ++v) {
+            table.distances[v * count + l] = rows[l][v];
+        }
+    }
+    return table;
+}
+
+std::vector<uint32_t> LandmarkTable::bestLandmarks(int src, int dest, size_t count) const {
+    std::vector<std::pair<uint32_t, uint32_t>> bounds; // (bound, landmark)
+    for (size_t l = 0; l < landmarks.size(); ++l) {
+        bounds.push_back({landmarkBound(distance(l, src), distance(l, dest)), static_cast<uint32_t>(l)});
+    }
+    count = std::min(count, bounds.size());
+    std::partial_sort(bounds.begin(), bounds.begin() + count, bounds.end(), std::greater<>());
+
+    std::vector<uint32_t> best;
+    for (size_t i = 0; i < count; ++i) {
+        best.push_back(bounds[i].second);
+    }
+    return best;
+}
+
+uint32_t LandmarkTable::lowerBound(int u, int v, const std::vector<uint32_t>& active) const {
+    const uint32_t* fromU = &distances[u * landmarks.size()];
+    const uint32_t* fromV = &distances[v * landmarks.size()];
+    uint32_t bound = 0;
+    for (uint32_t l : active) {
+        // a landmark that reaches exactly one of them proves they are in different parts of the network
+        if ((fromU[l] == UNREACHED) != (fromV[l] == UNREACHED)) {
+            return UNREACHED;
+        }
+        bound = std::max(bound, landmarkBound(fromU[l], fromV[l]));
+    }
+    return bound;
+}
+
+size_t LandmarkTable::memoryBytes() const {
+    return (landmarks.capacity() + distances.capacity()) * sizeof(uint32_t);
+}
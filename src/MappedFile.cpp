@@ -0,0 +1,64 @@
+/**
+ * @file: MappedFile.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of MappedFile
+ */
+#include "MappedFile.h"
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FPO_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef FPO_HAVE_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Could not read " + filename + " (missing or empty)");
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after the descriptor is closed
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Could not map " + filename);
+    }
+
+    bytes = static_cast<const char*>(address);
+    mapped = true;
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (buffer.empty() || !file.read(buffer.data(), buffer.size())) {
+        throw std::runtime_error("Could not read " + filename + " (missing or empty)");
+    }
+
+    bytes = buffer.data();
+    length = buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef FPO_HAVE_MMAP
+    if (mapped) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+}
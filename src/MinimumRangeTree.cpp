@@ -0,0 +1,166 @@
+/**
+ * @file: MinimumRangeTree.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of MinimumRangeTree
+ */
+#include "MinimumRangeTree.h"
+#include "CompressedAdjacency.h"
+#include "DistanceKernel.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+MinimumRangeTree MinimumRangeTree::build(const AirportTable& airports, const CoordinateTable& coordinates) {
+    MinimumRangeTree tree;
+    const size_t n = airports.size();
+    tree.numLeaves = n;
+    if (n == 0) {
+        return tree;
+    }
+
+    // Prim over the complete graph. The squared chord grows with the great-circle distance, so the tree is the
+    // same as by distance, and the kernel gives the chords from the airport just added to all others at once.
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> nearest(n, INF); // squared chord from each airport outside the tree to the closest inside
+    std::vector<uint32_t> closest(n, 0); // that closest airport
+    std::vector<char> inTree(n, 0);
+    std::vector<double> chords(n);
+    struct Flight {
+        uint32_t range;
+        uint32_t from;
+        uint32_t to;
+    };
+    std::vector<Flight> flights;
+    flights.reserve(n - 1);
+
+    size_t added = 0;
+    inTree[0] = 1;
+    for (size_t step = 1; step < n; ++step) {
+        const double q[3] = {coordinates.x[added], coordinates.y[added], coordinates.z[added]};
+        chordDistances2(coordinates.x.data(), coordinates.y.data(), coordinates.z.data(), n, q, chords.data());
+
+        size_t next = n;
+        for (size_t v = 0; v < n; ++v) {
+            if (inTree[v]) {
+                continue;
+            }
+            if (chords[v] < nearest[v]) {
+                nearest[v] = chords[v];
+                closest[v] = static_cast<uint32_t>(added);
+            }
+            if (next == n || nearest[v] < nearest[next]) {
+                next = v;
+            }
+        }
+
+        // the range an edge needs, measured exactly as the graph's edges are
+        uint32_t from = closest[next];
+        double distance = haversine(airports.latitude(from), airports.longitude(from),
+                                    airports.latitude(next), airports.longitude(next));
+        uint32_t packed = CompressedAdjacency::packWeight(distance);
+        flights.push_back({(packed >> 1) + (packed & 1), from, static_cast<uint32_t>(next)});
+        inTree[next] = 1;
+        added = next;
+    }
+
+    // Kruskal over the spanning tree's flights builds the reconstruction tree bottom up
+    std::sort(flights.begin(), flights.end(), [](const Flight& a, const Flight& b) { return a.range < b.range; });
+    const size_t numNodes = 2 * n - 1;
+    std::vector<uint32_t> parent(numNodes, UINT32_MAX);
+    tree.range.assign(numNodes, 0);
+
+    std::vector<uint32_t> group(n); // union-find over the airports
+    std::vector<uint32_t> groupNode(n); // the reconstruction tree node of each group's root
+    std::iota(group.begin(), group.end(), 0);
+    std::iota(groupNode.begin(), groupNode.end(), 0);
+    auto find = [&](uint32_t v) {
+        while (group[v] != v) {
+            group[v] = group[group[v]];
+            v = group[v];
+        }
+        return v;
+    };
+
+    uint32_t node = static_cast<uint32_t>(n);
+    for (const Flight& flight : flights) {
+        uint32_t a = find(flight.from);
+        uint32_t b = find(flight.to);
+        parent[groupNode[a]] = node;
+        parent[groupNode[b]] = node;
+        tree.range[node] = flight.range;
+        group[b] = a;
+        groupNode[a] = node;
+        ++node;
+    }
+
+    // parents are created after their children, so depths are filled from the root down
+    const uint32_t root = static_cast<uint32_t>(numNodes - 1);
+    parent[root] = root;
+    tree.depth.assign(numNodes, 0);
+    for (size_t v = numNodes - 1; v-- > 0;) {
+        tree.depth[v] = tree.depth[parent[v]] + 1;
+    }
+    // and the airports under each node are counted from the leaves up
+    tree.leaves.assign(numNodes, 0);
+    std::fill(tree.leaves.begin(), tree.leaves.begin() + n, 1);
+    for (size_t v = 0; v + 1 < numNodes; ++v) {
+        tree.leaves[parent[v]] += tree.leaves[v];
+    }
+
+    size_t levels = 1;
+    while ((size_t(1) << levels) < numNodes) {
+        ++levels;
+    }
+    tree.ancestors.assign(levels, std::vector<uint32_t>());
+    tree.ancestors[0] = parent;
+    for (size_t k = 1; k < levels; ++k) {
+        tree.ancestors[k].resize(numNodes);
+        for (size_t v = 0; v < numNodes; ++v) {
+            tree.ancestors[k][v] = tree.ancestors[k - 1][tree.ancestors[k - 1][v]];
+        }
+    }
+    return tree;
+}
+
+uint32_t MinimumRangeTree::minimumRange(size_t u, size_t v) const {
+    uint32_t a = static_cast<uint32_t>(u);
+    uint32_t b = static_cast<uint32_t>(v);
+    if (depth[a] < depth[b]) {
+        std::swap(a, b);
+    }
+    for (size_t k = ancestors.size(); k-- > 0;) {
+        if (depth[a] - depth[b] >= (uint32_t(1) << k)) {
+            a = ancestors[k][a];
+        }
+    }
+    if (a == b) {
+        return range[a];
+    }
+    for (size_t k = ancestors.size(); k-- > 0;) {
+        if (ancestors[k][a] != ancestors[k][b]) {
+            a = ancestors[k][a];
+            b = ancestors[k][b];
+        }
+    }
+    return range[ancestors[0][a]];
+}
+
+uint32_t MinimumRangeTree::component(size_t v, uint32_t r) const {
+    // ranges only grow towards the root, so the highest ancestor within r is found by binary lifting too
+    uint32_t a = static_cast<uint32_t>(v);
+    for (size_t k = ancestors.size(); k-- > 0;) {
+        if (range[ancestors[k][a]] <= r) {
+            a = ancestors[k][a];
+        }
+    }
+    return a;
+}
+
+size_t MinimumRangeTree::memoryBytes() const {
+    size_t bytes = (range.capacity() + depth.capacity() + leaves.capacity()) * sizeof(uint32_t);
+    for (const std::vector<uint32_t>& level : ancestors) {
+        bytes += level.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
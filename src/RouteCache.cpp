@@ -0,0 +1,117 @@
+/**
+ * @file: RouteCache.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of RouteCache
+ */
+#include "RouteCache.h"
+#include <algorithm>
+
+namespace {
+
+// The bookkeeping of an entry besides its strings: its map node, list node, future state and the route's vector.
+const size_t ENTRY_OVERHEAD = 256;
+
+}
+
+RouteCache::RouteCache(size_t budgetBytes, size_t numShards)
+    : budget(budgetBytes), shardBudget(budgetBytes / std::max<size_t>(1, numShards)), shards(std::max<size_t>(1, numShards)) {}
+
+size_t RouteCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::string>()(key.start);
+    auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+    combine(std::hash<std::string>()(key.dest));
+    combine(std::hash<int>()(key.range));
+    combine(std::hash<int>()(key.mode));
+    combine(std::hash<int>()(key.algorithm));
+    combine(std::hash<int>()(key.maxStops));
+    return hash;
+}
+
+size_t RouteCache::entryBytes(const Key& key, const Route& route) {
+    size_t bytes = ENTRY_OVERHEAD + 2 * (key.start.capacity() + key.dest.capacity());
+    bytes += route.first.capacity() * sizeof(std::string);
+    for (const std::string& airport : route.first) {
+        bytes += airport.capacity();
+    }
+    return bytes;
+}
+
+std::shared_ptr<const RouteCache::Route> RouteCache::getOrCompute(const Key& key, const std::function<Route()>& compute) {
+    Shard& shard = shardOf(key);
+    std::promise<std::shared_ptr<const Route>> promise;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        auto found = shard.entries.find(key);
+        if (found != shard.entries.end()) {
+            std::shared_future<std::shared_ptr<const Route>> result = found->second.result;
+            if (found->second.ready) {
+                ++shard.hits;
+                shard.recent.splice(shard.recent.begin(), shard.recent, found->second.position);
+                return result.get();
+            }
+            // an identical request is searching; wait for it without holding the shard
+            ++shard.coalesced;
+            lock.unlock();
+            return result.get();
+        }
+        ++shard.misses;
+        Entry entry;
+        entry.result = promise.get_future().share();
+        shard.entries.emplace(key, std::move(entry));
+    }
+
+    std::shared_ptr<const Route> route;
+    try {
+        route = std::make_shared<const Route>(compute());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.erase(key);
+        throw;
+    }
+    promise.set_value(route);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Entry& entry = shard.entries.at(key);
+    entry.ready = true;
+    entry.bytes = entryBytes(key, *route);
+    shard.recent.push_front(key);
+    entry.position = shard.recent.begin();
+    shard.bytes += entry.bytes;
+
+    // the least recently used results go first, possibly including this one if it is larger than the budget
+    while (shard.bytes > shardBudget && !shard.recent.empty()) {
+        auto oldest = shard.entries.find(shard.recent.back());
+        shard.bytes -= oldest->second.bytes;
+        shard.entries.erase(oldest);
+        shard.recent.pop_back();
+        ++shard.evictions;
+    }
+    return route;
+}
+
+RouteCache::Stats RouteCache::stats() const {
+    Stats total;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total.hits += shard.hits;
+        total.misses += shard.misses;
+        total.coalesced += shard.coalesced;
+        total.evictions += shard.evictions;
+        total.entries += shard.recent.size();
+        total.bytes += shard.bytes;
+    }
+    return total;
+}
+
+void RouteCache::clear() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const Key& key : shard.recent) {
+            shard.entries.erase(key);
+        }
+        shard.recent.clear();
+        shard.bytes = 0;
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * @file: SearchContext.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of SearchContext
+ */
+#include "SearchContext.h"
+
+void SearchContext::reset(size_t numVertices) {
+    if (entries.size() < numVertices) {
+        entries.resize(numVertices, Entry{0, INT32_MAX, INT32_MAX, -1, false});
+    }
+    // when the generation wraps around, entries stamped 2^32 searches ago would look current again
+    if (++generation == 0) {
+        for (Entry& entry : entries) {
+            entry.generation = 0;
+        }
+        generation = 1;
+    }
+    switch (queueKind) {
+        case SearchQueue::QuaternaryHeap: quaternary.clear(numVertices); break;
+        case SearchQueue::RadixHeap: radix.clear(numVertices); break;
+        default: binary.clear(numVertices); break;
+    }
+}
+
+std::vector<int> SearchContext::pathTo(int last) const {
+    std::vector<int> path;
+    for (int at = last; at != -1; at = prev(at)) {
+        path.push_back(at);
+    }
+    return path;
+}
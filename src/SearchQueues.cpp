@@ -0,0 +1,74 @@
+/**
+ * @file: SearchQueues.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of the search queues
+ */
+#include "SearchQueues.h"
+
+bool parseSearchQueue(const std::string& name, SearchQueue& queue) {
+    if (name == "binary") {
+        queue = SearchQueue::BinaryHeap;
+    } else if (name == "4-ary") {
+        queue = SearchQueue::QuaternaryHeap;
+    } else if (name == "radix") {
+        queue = SearchQueue::RadixHeap;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string searchQueueName(SearchQueue queue) {
+    switch (queue) {
+        case SearchQueue::QuaternaryHeap: return "4-ary";
+        case SearchQueue::RadixHeap: return "radix";
+        default: return "binary";
+    }
+}
+
+void QuaternaryHeapQueue::clear(size_t numVertices) {
+    if (stamp.size() < numVertices) {
+        stamp.resize(numVertices, 0);
+        position.resize(numVertices);
+    }
+    // when the generation wraps around, vertices stamped 2^32 searches ago would look pushed again
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    heap.clear();
+}
+
+void RadixHeapQueue::clear(size_t) {
+    for (std::vector<QueueEntry>& bucket : buckets) {
+        bucket.clear();
+    }
+    last = 0;
+    count = 0;
+}
+
+QueueEntry RadixHeapQueue::pop() {
+    if (buckets[0].empty()) {
+        // move the first non-empty bucket down, relative to its smallest distance; its entries all land in
+        // lower buckets, those at that distance in bucket 0
+        size_t i = 1;
+        while (buckets[i].empty()) {
+            ++i;
+        }
+        last = UINT32_MAX;
+        for (const QueueEntry& entry : buckets[i]) {
+            last = std::min(last, static_cast<uint32_t>(std::get<0>(entry)));
+        }
+        for (const QueueEntry& entry : buckets[i]) {
+            buckets[bucketOf(static_cast<uint32_t>(std::get<0>(entry)))].push_back(entry);
+        }
+        buckets[i].clear();
+        std::make_heap(buckets[0].begin(), buckets[0].end(), std::greater<QueueEntry>());
+    }
+    std::pop_heap(buckets[0].begin(), buckets[0].end(), std::greater<QueueEntry>());
+    QueueEntry top = buckets[0].back();
+    buckets[0].pop_back();
+    --count;
+    return top;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file: SpatialGrid.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of SpatialGrid
+ */
+#include "SpatialGrid.h"
+#include <algorithm>
+#include "DistanceKernel.h"
+
+namespace {
+    // Relative and absolute padding (in radians) added to every angle so rounding can never drop a candidate
+    const double PAD_REL = 1e-9;
+    const double PAD_ABS = 1e-11;
+
+    const double HALF_PI = M_PI / 2;
+    const double TWO_PI = 2 * M_PI;
+}
+
+SpatialGrid::SpatialGrid(const CoordinateTable& coordinates, double radiusNm)
+    : coordinates(coordinates) {
+    double radiusClamped = std::max(radiusNm, 0.0);
+    radius = radiusClamped / EARTH_RADIUS_NM * (1 + PAD_REL) + PAD_ABS;
+    double chord = chordForDistance(radiusClamped);
+    maxChord2 = chord * chord;
+
+    // Cells are at least as wide as the radius, but never more numerous than ~4 per airport
+    // so that tiny thresholds don't allocate millions of empty cells.
+    size_t n = coordinates.size();
+    double minCell = std::sqrt(M_PI * TWO_PI / (4.0 * std::max<size_t>(n, 1)));
+    double cell = std::min(std::max(radius, minCell), M_PI);
+
+    numRows = std::max<size_t>(1, static_cast<size_t>(M_PI / cell));
+    numCols = std::max<size_t>(1, static_cast<size_t>(TWO_PI / cell));
+    rowHeight = M_PI / numRows;
+    colWidth = TWO_PI / numCols;
+
+    // Counting sort of the airports by cell
+    std::vector<size_t> cellOf(n);
+    cellStart.assign(numRows * numCols + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        cellOf[i] = rowOf(coordinates.latRad[i]) * numCols + colOf(coordinates.lonRad[i]);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    cellItems.resize(n);
+    std::vector<size_t> fill(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        cellItems[fill[cellOf[i]]++] = i;
+    }
+
+    // Copy the coordinates into cell order so each cell is one contiguous block for the kernel
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    for (size_t c = 0; c < n; ++c) {
+        xs[c] = coordinates.x[cellItems[c]];
+        ys[c] = coordinates.y[cellItems[c]];
+        zs[c] = coordinates.z[cellItems[c]];
+    }
+}
+
+size_t SpatialGrid::rowOf(double lat) const {
+    double clamped = std::min(std::max(lat, -HALF_PI), HALF_PI);
+    size_t row = static_cast<size_t>((clamped + HALF_PI) / rowHeight);
+    return std::min(row, numRows - 1);
+}
+
+size_t SpatialGrid::colOf(double lon) const {
+    // wrap the longitude into [0, 2pi) so cells on both sides of the antimeridian line up
+    double wrapped = std::fmod(lon + M_PI, TWO_PI);
+    if (wrapped < 0) {
+        wrapped += TWO_PI;
+    }
+    size_t col = static_cast<size_t>(wrapped / colWidth);
+    return std::min(col, numCols - 1);
+}
+
+void SpatialGrid::candidatesAfter(size_t i, std::vector<size_t>& out, std::vector<uint32_t>& scratch) const {
+    out.clear();
+    scratch.resize(coordinates.size());
+    double lat = coordinates.latRad[i];
+    double lon = coordinates.lonRad[i];
+    double q[3] = {coordinates.x[i], coordinates.y[i], coordinates.z[i]};
+
+    size_t rowLo = rowOf(lat - radius);
+    size_t rowHi = rowOf(lat + radius);
+
+    // Longitude half-width of the circle around the airport. If the circle contains a pole
+    // every longitude is reachable, otherwise it is asin(sin(radius) / cos(lat)).
+    bool allCols = lat + radius >= HALF_PI || lat - radius <= -HALF_PI;
+    double dLon = M_PI;
+    if (!allCols) {
+        double ratio = std::sin(radius) / std::cos(lat);
+        if (ratio >= 1) {
+            allCols = true;
+        } else {
+            dLon = std::asin(ratio) * (1 + PAD_REL) + PAD_ABS;
+            allCols = 2 * dLon + colWidth >= TWO_PI;
+        }
+    }
+
+    size_t firstCol = 0;
+    size_t colCount = numCols;
+    if (!allCols) {
+        firstCol = colOf(lon - dLon);
+        size_t lastCol = colOf(lon + dLon);
+        colCount = (lastCol + numCols - firstCol) % numCols + 1; // wraps across the antimeridian
+    }
+
+    for (size_t row = rowLo; row <= rowHi; ++row) {
+        for (size_t k = 0; k < colCount; ++k) {
+            size_t cell = row * numCols + (firstCol + k) % numCols;
+            size_t begin = cellStart[cell];
+            size_t count = cellStart[cell + 1] - begin;
+
+            // drop the cell's airports that are clearly out of range before anything else looks at them
+            size_t found = chordWithin(&xs[begin], &ys[begin], &zs[begin], count, q, maxChord2, scratch.data());
+            for (size_t h = 0; h < found; ++h) {
+                size_t j = cellItems[begin + scratch[h]];
+                if (j > i) {
+                    out.push_back(j);
+                }
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+}
@@ -0,0 +1,39 @@
+/**
+ * @file: StringArena.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of StringArena
+ */
+#include "StringArena.h"
+#include <functional>
+
+ArenaString StringArena::add(std::string_view s) {
+    ArenaString ref = {static_cast<uint32_t>(buffer.size()), static_cast<uint32_t>(s.size())};
+    buffer.append(s.data(), s.size());
+    return ref;
+}
+
+ArenaString StringArena::intern(std::string_view s) {
+    size_t hash = std::hash<std::string_view>()(s);
+    auto [first, last] = interned.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (view(it->second) == s) {
+            return it->second;
+        }
+    }
+
+    ArenaString ref = add(s);
+    interned.emplace(hash, ref);
+    return ref;
+}
+
+size_t StringArena::memoryBytes() const {
+    // each intern entry is a hash node (next pointer, hash and value) plus its bucket
+    size_t nodeBytes = sizeof(void*) + sizeof(size_t) + sizeof(ArenaString);
+    return buffer.capacity() + interned.size() * nodeBytes + interned.bucket_count() * sizeof(void*);
+}
+
+void StringArena::clear() {
+    buffer.clear();
+    interned.clear();
+}
@@ -0,0 +1,183 @@
+/**
+ * @file: WorkStealing.cpp
+ * @author: 0Ykahil
+ *
+ * Implementation of the work-stealing scheduler
+ */
+#include "WorkStealing.h"
+#include <algorithm>
+
+void WorkStealingDeque::push(size_t task) {
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.push_back(task);
+}
+
+bool WorkStealingDeque::pop(size_t& task) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (tasks.empty()) {
+        return false;
+    }
+    task = tasks.front();
+    tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingDeque::steal(size_t& task) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (tasks.empty()) {
+        return false;
+    }
+    task = tasks.back();
+    tasks.pop_back();
+    return true;
+}
+
+size_t resolveThreadCount(size_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    return numThreads == 0 ? 1 : numThreads;
+}
+
+void runWorkStealing(size_t numTasks, size_t numThreads, const std::function<void(size_t task, size_t worker)>& body) {
+    numThreads = std::min(resolveThreadCount(numThreads), std::max<size_t>(numTasks, 1));
+
+    if (numThreads == 1) {
+        for (size_t task = 0; task < numTasks; ++task) {
+            body(task, 0);
+        }
+        return;
+    }
+
+    // deal out contiguous runs of tasks
+    std::vector<WorkStealingDeque> queues(numThreads);
+    for (size_t w = 0; w < numThreads; ++w) {
+        for (size_t task = w * numTasks / numThreads; task < (w + 1) * numTasks / numThreads; ++task) {
+            queues[w].push(task);
+        }
+    }
+
+    // No tasks are added once workers start, so a worker can stop as soon as it finds every queue empty
+    auto work = [&](size_t worker) {
+        size_t task;
+        while (true) {
+            if (queues[worker].pop(task)) {
+                body(task, worker);
+                continue;
+            }
+
+            bool stole = false;
+            for (size_t k = 1; k < numThreads && !stole; ++k) {
+                stole = queues[(worker + k) % numThreads].steal(task);
+            }
+            if (!stole) {
+                return;
+            }
+            body(task, worker);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < numThreads; ++w) {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+WorkStealingPool::WorkStealingPool(size_t numThreads)
+    : numThreads(resolveThreadCount(numThreads)), queues(this->numThreads) {
+    for (size_t w = 0; w < this->numThreads; ++w) {
+        threads.emplace_back(&WorkStealingPool::work, this, w);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> submitting(submitMtx);
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    started.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(size_t numTasks, const std::function<void(size_t task, size_t worker)>& jobBody) {
+    if (numTasks == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> submitting(submitMtx);
+
+    // deal out contiguous runs of tasks, as runWorkStealing does
+    for (size_t w = 0; w < numThreads; ++w) {
+        for (size_t task = w * numTasks / numThreads; task < (w + 1) * numTasks / numThreads; ++task) {
+            queues[w].push(task);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    body = &jobBody;
+    error = nullptr;
+    failed.store(false, std::memory_order_relaxed);
+    working = numThreads;
+    ++job;
+    started.notify_all();
+    finished.wait(lock, [&] { return working == 0; });
+    body = nullptr;
+    if (error) {
+        std::exception_ptr thrown = error;
+        error = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+void WorkStealingPool::work(size_t worker) {
+    uint64_t done = 0;
+    while (true) {
+        const std::function<void(size_t, size_t)>* jobBody;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            started.wait(lock, [&] { return stopping || job != done; });
+            if (stopping) {
+                return;
+            }
+            done = job;
+            jobBody = body;
+        }
+
+        // No tasks are added while a job runs, so a worker is done with it once it finds every queue empty
+        size_t task;
+        while (true) {
+            bool found = queues[worker].pop(task);
+            for (size_t k = 1; k < numThreads && !found; ++k) {
+                found = queues[(worker + k) % numThreads].steal(task);
+            }
+            if (!found) {
+                break;
+            }
+            // after a failure the rest of the tasks are only taken off the queues
+            if (failed.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                (*jobBody)(task, worker);
+            } catch (...) {
+                failed.store(true, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (--working == 0) {
+            finished.notify_all();
+        }
+    }
+}
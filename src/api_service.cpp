@@ -1,19 +1,26 @@
 #include <iostream>
 #include <cpprest/http_listener.h>
 #include <cpprest/json.h>
+#include <cpprest/producerconsumerstream.h>
 #include <string>
+#include <string_view>
 #include <map>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
-#include <mutex>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 #include "utility_functions.h"
 #include "Graph.h"
+#include "RouteCache.h"
+#include "WorkStealing.h"
 #include "Logger.h"
 
 using namespace web;
@@ -22,11 +29,43 @@ using namespace web::http::experimental::listener;
 
 int PORT = 8080;
 std::atomic<int> aircraftRangeNm(500);
+// The graph is built once at this range and answers routes for every range up to it, set with MAX_RANGE_NM
+int maxRangeNm = 2000;
+// Threads used to build the graph (1 = single threaded, 0 = every hardware thread), set with GRAPH_BUILD_THREADS
+int graphBuildThreads = 1;
+// Threads used by each bidirectional route search (1 or 2), set with ROUTE_SEARCH_THREADS
+int routeSearchThreads = 1;
+// The most routes GET /route/alternatives returns
+const int MAX_ALTERNATIVES = 10;
+// The largest maxStops GET /route and POST /routes accept
+const int MAX_STOPS = 20;
+// The most sources (and the most targets) POST /matrix accepts
+const size_t MAX_MATRIX_AIRPORTS = 1000;
+// The most routes one POST /routes accepts
+const size_t MAX_BATCH_ROUTES = 100000;
+// POST /routes answers batches larger than this in chunks of this many routes, streaming each as it is done
+const size_t ROUTES_PER_CHUNK = 512;
+// Workers of the pool shared by POST /routes, /route/alternatives and /matrix (0 = every hardware thread), set with
+// ROUTE_BATCH_THREADS
+int routeBatchThreads = 0;
+// The memory the cached /route results may use, set in MB with ROUTE_CACHE_MB
+size_t routeCacheBytes = 64 * 1024 * 1024;
+// Ranges whose contraction hierarchies are built at startup, the only ranges algorithm=ch answers, set with CH_RANGES
+std::vector<int> contractionHierarchyRanges;
+// Ranges whose landmarks are chosen at startup, the only ranges algorithm=alt answers, set with ALT_RANGES
+// (the aircraft range by default)
+std::vector<int> landmarkRanges;
 utility::string_t web_link = "http://0.0.0.0:" + std::to_string(PORT);
 
-nlohmann::json airportsData;
-std::mutex graphCacheMutex;
-std::unordered_map<int, std::shared_ptr<Graph>> graphCache;
+// If set (with GRAPH_SNAPSHOT), the graph is loaded from this snapshot instead of built from the dataset
+std::string graphSnapshotPath;
+
+std::shared_ptr<Graph> airportGraph; // The graph, whose AirportTable the search and detail handlers read
+std::unique_ptr<RouteCache> routeCache; // The /route results, shared by every worker
+// The workers of every POST /routes, /route/alternatives and /matrix, started once, and the search context of each
+// (worker w uses context w)
+std::unique_ptr<WorkStealingPool> searchPool;
+std::vector<SearchContext> searchPoolContexts;
 std::atomic<bool> running(true);
 
 void handleShutdownSignal(int) {
@@ -42,7 +81,7 @@ void logRequest(const http_request& request, status_code status) {
 
 void addCorsHeaders(http_headers& headers) {
     headers.add(U("Access-Control-Allow-Origin"), U("*"));
-    headers.add(U("Access-Control-Allow-Methods"), U("GET, PUT, OPTIONS"));
+    headers.add(U("Access-Control-Allow-Methods"), U("GET, PUT, POST, OPTIONS"));
     headers.add(U("Access-Control-Allow-Headers"), U("Content-Type"));
 }
 
@@ -55,6 +94,33 @@ void sendJson(http_request request, status_code status, const json::value& body)
     request.reply(response);
 }
 
+// Sends a body that is already JSON text, for responses too large to build as a json::value.
+void sendJsonText(http_request request, status_code status, std::string&& body) {
+    http_response response(status);
+    addCorsHeaders(response.headers());
+    response.set_body(std::move(body), "application/json");
+    logRequest(request, status);
+    request.reply(response);
+}
+
+// Appends text to out as a JSON string, quoted and escaped.
+void appendJsonString(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
 void handleOptions(http_request request) {
     http_response response(status_codes::OK);
     addCorsHeaders(response.headers());
@@ -62,28 +128,69 @@ void handleOptions(http_request request) {
     request.reply(response);
 }
 
-std::shared_ptr<Graph> getGraphForRange(int rangeNm) {
-    {
-        std::lock_guard<std::mutex> lock(graphCacheMutex);
-        auto it = graphCache.find(rangeNm);
-        if (it != graphCache.end()) {
-            Logger::debug("Graph cache hit for range " + std::to_string(rangeNm) + "nm");
-            return it->second;
+/**
+ * Builds the graph from ./datasets/airports.json, or loads it from graphSnapshotPath if set.
+ * Returns false (after logging why) if neither worked.
+ */
+bool loadAirportGraph() {
+    airportGraph = std::make_shared<Graph>(0);
+
+    if (!graphSnapshotPath.empty()) {
+        try {
+            airportGraph->loadSnapshot(graphSnapshotPath);
+        } catch (const std::exception& e) {
+            Logger::error("Failed to load graph snapshot: " + std::string(e.what()));
+            return false;
+        }
+        maxRangeNm = airportGraph->getMaxRange();
+        Logger::info("Loaded snapshot " + graphSnapshotPath + " with ranges up to " + std::to_string(maxRangeNm) + "nm");
+    } else {
+        // stream the dataset straight into the table, the JSON document is never held in memory
+        AirportTable airportTable;
+        try {
+            airportTable = AirportTable::load("./datasets/airports.json");
+            Logger::info("Loaded " + std::to_string(airportTable.size()) + " airports");
+        } catch (const std::exception& e) {
+            Logger::error("Failed to load airports dataset: " + std::string(e.what()));
+            return false;
         }
+
+        Logger::info("Building graph for ranges up to " + std::to_string(maxRangeNm) + "nm");
+        airportGraph->generateAirportGraph(airportTable, maxRangeNm, graphBuildThreads != 1, BuildMode::SpatialGrid, graphBuildThreads);
     }
+    airportGraph->setBidirectionalThreads(routeSearchThreads == 2);
 
-    Logger::info("Building graph for range " + std::to_string(rangeNm) + "nm");
-    std::shared_ptr<Graph> graph = std::make_shared<Graph>(airportsData.size());
-    graph->generateAirportGraph(airportsData, rangeNm, false);
+    for (int range : contractionHierarchyRanges) {
+        auto started = std::chrono::steady_clock::now();
+        auto hierarchy = airportGraph->prepareContractionHierarchy(range, graphBuildThreads);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        Logger::info("Built the contraction hierarchy for " + std::to_string(range) + "nm in " + std::to_string(elapsed.count()) +
+                     "ms (" + std::to_string(hierarchy->shortcutCount()) + " shortcuts)");
+    }
 
-    std::lock_guard<std::mutex> lock(graphCacheMutex);
-    auto [it, inserted] = graphCache.insert({rangeNm, graph});
-    if (inserted) {
-        Logger::info("Cached graph for range " + std::to_string(rangeNm) + "nm");
-    } else {
-        Logger::debug("Graph cache hit for range " + std::to_string(rangeNm) + "nm after build");
+    for (int range : landmarkRanges) {
+        auto started = std::chrono::steady_clock::now();
+        airportGraph->prepareLandmarks(range, graphBuildThreads);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        Logger::info("Chose the landmarks for " + std::to_string(range) + "nm in " + std::to_string(elapsed.count()) + "ms");
     }
-    return it->second;
+
+    // the minimum range tree takes well under a second, so /route/min-range never waits for it
+    auto started = std::chrono::steady_clock::now();
+    airportGraph->prepareMinimumRangeTree();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    Logger::info("Built the minimum range tree in " + std::to_string(elapsed.count()) + "ms");
+
+    // airport searches are the most frequent requests, so their index is built before the first one
+    started = std::chrono::steady_clock::now();
+    auto searchIndex = airportGraph->prepareSearchIndex();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    Logger::info("Built the airport search index in " + std::to_string(elapsed.count()) + "ms (" +
+                 std::to_string(searchIndex->memoryBytes() / 1024) + " KB)");
+
+    Logger::info("Graph has " + std::to_string(airportGraph->getAirportTable().size()) + " airports and " +
+                 std::to_string(airportGraph->edgeCount()) + " edges");
+    return true;
 }
 
 /**
@@ -104,6 +211,28 @@ void handleHealth(http_request request) {
 void handleGetConfig(http_request request) {
     json::value response;
     response[U("aircraftRangeNm")] = json::value::number(aircraftRangeNm.load());
+    response[U("maxRangeNm")] = json::value::number(maxRangeNm);
+    response[U("graphBuildThreads")] = json::value::number(graphBuildThreads);
+    response[U("routeSearchThreads")] = json::value::number(routeSearchThreads);
+    response[U("routeCacheBytes")] = json::value::number(static_cast<double>(routeCacheBytes));
+
+    sendJson(request, status_codes::OK, response);
+}
+
+/**
+ * Handles GET /cache/stats.
+ * Returns the counters and size of the /route result cache.
+ */
+void handleCacheStats(http_request request) {
+    RouteCache::Stats stats = routeCache->stats();
+    json::value response;
+    response[U("hits")] = json::value::number(static_cast<double>(stats.hits));
+    response[U("misses")] = json::value::number(static_cast<double>(stats.misses));
+    response[U("coalesced")] = json::value::number(static_cast<double>(stats.coalesced));
+    response[U("evictions")] = json::value::number(static_cast<double>(stats.evictions));
+    response[U("entries")] = json::value::number(static_cast<double>(stats.entries));
+    response[U("bytes")] = json::value::number(static_cast<double>(stats.bytes));
+    response[U("budgetBytes")] = json::value::number(static_cast<double>(routeCache->getBudget()));
 
     sendJson(request, status_codes::OK, response);
 }
@@ -128,6 +257,12 @@ void handleSetRange(http_request request) {
                 sendJson(request, status_codes::BadRequest, response);
                 return;
             }
+            if (rangeInt > maxRangeNm) {
+                response[U("error")] = json::value::string(utility::conversions::to_string_t(
+                    "range must be at most " + std::to_string(maxRangeNm)));
+                sendJson(request, status_codes::BadRequest, response);
+                return;
+            }
 
             aircraftRangeNm.store(rangeInt);
             response[U("aircraftRangeNm")] = json::value::number(aircraftRangeNm.load());
@@ -155,31 +290,25 @@ void handleAirportSearch(http_request request) {
 
     if (searchParam != queryParams.end()) {
         utility::string_t search = searchParam->second;
-        std::string searchText = toUpperCase(utility::conversions::to_utf8string(search));
+        std::string searchText = utility::conversions::to_utf8string(search);
 
         response[U("search")] = json::value::string(search);
         response[U("airports")] = json::value::array();
     
+        const AirportTable& airportTable = airportGraph->getAirportTable();
+        std::shared_ptr<const AirportSearchIndex> searchIndex = airportGraph->prepareSearchIndex();
         int index = 0;
-        // index all results
-        for (const nlohmann::json& airport : airportsData) {
-            std::string code = toUpperCase(airport["ident"]);
-            std::string name = toUpperCase(airport["name"]);
-            std::string type = airport["type"];
-
-            bool matchesCode = code.find(searchText) != std::string::npos;
-            bool matchesName = name.find(searchText) != std::string::npos;
+        // the trigram index finds the matching airports; their uppercased codes and names are kept in it
+        for (uint32_t i : searchIndex->search(searchText)) {
+            std::string_view type = airportTypeName(airportTable.type(i));
+            json::value airportJson;
 
-            if (matchesCode || matchesName) {
-                json::value airportJson;
+            airportJson[U("code")] = json::value::string(utility::conversions::to_string_t(std::string(searchIndex->code(i))));
+            airportJson[U("name")] = json::value::string(utility::conversions::to_string_t(std::string(searchIndex->name(i))));
+            airportJson[U("type")] = json::value::string(utility::conversions::to_string_t(std::string(type)));
 
-                airportJson[U("code")] = json::value::string(utility::conversions::to_string_t(code));
-                airportJson[U("name")] = json::value::string(utility::conversions::to_string_t(name));
-                airportJson[U("type")] = json::value::string(utility::conversions::to_string_t(type));
-
-                response[U("airports")][index] = airportJson;
-                index++;
-            }
+            response[U("airports")][index] = airportJson;
+            index++;
         }
 
     } else {
@@ -191,6 +320,94 @@ void handleAirportSearch(http_request request) {
     sendJson(request, status_codes::OK, response);
 }
 
+/**
+ * Handles GET /airports/near?lat=<latitude>&lon=<longitude>&k=<count>&radius=<radiusNm>.
+ * Returns the k airports closest to the position, closest first. If a radius is given, returns
+ * every airport within that many nautical miles instead (still capped at k when k is given).
+ */
+void handleNearbyAirports(http_request request) {
+    utility::string_t queryString = request.request_uri().query();
+    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+    auto latParam = queryParams.find(U("lat"));
+    auto lonParam = queryParams.find(U("lon"));
+    auto kParam = queryParams.find(U("k"));
+    auto radiusParam = queryParams.find(U("radius"));
+
+    json::value response;
+
+    if (latParam == queryParams.end() || lonParam == queryParams.end()) {
+        response[U("error")] = json::value::string(U("missing lat or lon parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    double lat = 0;
+    double lon = 0;
+    int k = 5;
+    double radiusNm = -1;
+
+    // std::stod reads "nan" and "inf", which slip past the range checks below, so only finite numbers are taken
+    bool valid = toFiniteDouble(utility::conversions::to_utf8string(latParam->second), lat) &&
+                 toFiniteDouble(utility::conversions::to_utf8string(lonParam->second), lon) &&
+                 (radiusParam == queryParams.end() ||
+                  toFiniteDouble(utility::conversions::to_utf8string(radiusParam->second), radiusNm));
+    try {
+        if (kParam != queryParams.end()) {
+            k = std::stoi(utility::conversions::to_utf8string(kParam->second));
+        }
+    } catch (const std::exception&) {
+        valid = false;
+    }
+    if (!valid) {
+        response[U("error")] = json::value::string(U("invalid lat, lon, k or radius parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
+        response[U("error")] = json::value::string(U("lat must be within [-90, 90] and lon within [-180, 180]"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    if (k <= 0 || (radiusParam != queryParams.end() && radiusNm <= 0)) {
+        response[U("error")] = json::value::string(U("k and radius must be greater than 0"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    std::shared_ptr<Graph> graph = airportGraph;
+    std::vector<std::pair<Airport, double>> found;
+    if (radiusParam != queryParams.end()) {
+        found = graph->airportsWithinRadius(lat, lon, radiusNm);
+        if (kParam != queryParams.end() && found.size() > static_cast<size_t>(k)) {
+            found.resize(k);
+        }
+    } else {
+        found = graph->nearestAirports(lat, lon, k);
+    }
+
+    response[U("lat")] = json::value::number(lat);
+    response[U("lon")] = json::value::number(lon);
+    response[U("airports")] = json::value::array(found.size());
+
+    for (size_t i = 0; i < found.size(); i++) {
+        const Airport& airport = found[i].first;
+        json::value airportJson;
+
+        airportJson[U("code")] = json::value::string(utility::conversions::to_string_t(airport.id));
+        airportJson[U("name")] = json::value::string(utility::conversions::to_string_t(airport.name));
+        airportJson[U("type")] = json::value::string(utility::conversions::to_string_t(std::string(airportTypeName(airport.type))));
+        airportJson[U("latitude")] = json::value::number(airport.latitude);
+        airportJson[U("longitude")] = json::value::number(airport.longitude);
+        airportJson[U("distance")] = json::value::number(found[i].second);
+
+        response[U("airports")][i] = airportJson;
+    }
+
+    sendJson(request, status_codes::OK, response);
+}
+
 /**
  * Handles GET /airports/{code}.
  * Returns detailed information about the airport with the specified code.
@@ -200,42 +417,81 @@ void handleAirportDetail(http_request request) {
     utility::string_t code = path.substr(path.find_last_of(U("/")) + 1);
     json::value response;
 
-    for (const nlohmann::json& airport : airportsData) {
-        if (toUpperCase(airport["ident"]) == toUpperCase(utility::conversions::to_utf8string(code))) {
-            response[U("code")] = json::value::string(utility::conversions::to_string_t((std::string) airport["ident"]));
-            response[U("name")] = json::value::string(utility::conversions::to_string_t((std::string) airport["name"]));
-            response[U("type")] = json::value::string(utility::conversions::to_string_t((std::string) airport["type"]));
-            response[U("latitude")] = json::value::string(utility::conversions::to_string_t((std::string) airport["latitude"]));
-            response[U("longitude")] = json::value::string(utility::conversions::to_string_t((std::string) airport["longitude"]));
-            response[U("continent")] = json::value::string(utility::conversions::to_string_t((std::string) airport["continent"]));
+    // codes are looked up as given, then in upper case (as the datasets write nearly all of them), through the
+    // graph's index instead of a scan of every airport
+    std::shared_ptr<Graph> graph = airportGraph;
+    std::string requested = utility::conversions::to_utf8string(code);
+    int i = graph->getAirportIndex(requested);
+    if (i < 0) {
+        i = graph->getAirportIndex(toUpperCase(requested));
+    }
+    if (i >= 0) {
+        const AirportTable& airportTable = graph->getAirportTable();
+        response[U("code")] = json::value::string(utility::conversions::to_string_t(std::string(airportTable.id(i))));
+        response[U("name")] = json::value::string(utility::conversions::to_string_t(std::string(airportTable.name(i))));
+        response[U("type")] = json::value::string(utility::conversions::to_string_t(std::string(airportTypeName(airportTable.type(i)))));
+        response[U("latitude")] = json::value::string(utility::conversions::to_string_t(formatCoordinate(airportTable.latitude(i))));
+        response[U("longitude")] = json::value::string(utility::conversions::to_string_t(formatCoordinate(airportTable.longitude(i))));
+        response[U("continent")] = json::value::string(utility::conversions::to_string_t(std::string(airportTable.continent(i))));
 
-            sendJson(request, status_codes::OK, response);
-            return;
-        }
+        sendJson(request, status_codes::OK, response);
+        return;
     }
-    
+
     response[U("message")] = json::value::string(U(code + " Not found in dataset"));
 
     sendJson(request, status_codes::NotFound, response);
 }
 
 /**
- * Handles GET /route?start=<startCode>&dest=<destCode>&range=<desiredRange>
+ * Reads the range parameter of a route endpoint into routeRangeNm, the configured aircraft range if it is not given.
+ * Sends a BadRequest and returns false if it is invalid.
  */
-void handleRoute(http_request request) {
+bool readRangeParameter(http_request request, const std::map<utility::string_t, utility::string_t>& queryParams,
+                        int& routeRangeNm) {
     json::value response;
+    auto rangeParam = queryParams.find(U("range"));
+    routeRangeNm = aircraftRangeNm.load();
+    if (rangeParam == queryParams.end()) {
+        return true;
+    }
 
-    utility::string_t queryString = request.request_uri().query();
-    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+    try {
+        routeRangeNm = std::stoi(utility::conversions::to_utf8string(rangeParam->second));
+    } catch (const std::exception&) {
+        response[U("error")] = json::value::string(U("invalid range parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+    if (routeRangeNm <= 0) {
+        response[U("error")] = json::value::string(U("range must be greater than 0"));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+    if (routeRangeNm > maxRangeNm) {
+        response[U("error")] = json::value::string(utility::conversions::to_string_t(
+            "range must be at most " + std::to_string(maxRangeNm)));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the start, dest, mode and range parameters shared by the route endpoints (range defaults to the
+ * configured aircraft range). Sends a BadRequest and returns false if one is invalid.
+ */
+bool readRouteParameters(http_request request, const std::map<utility::string_t, utility::string_t>& queryParams,
+                         const std::shared_ptr<Graph>& routeGraph, std::string& startCode, std::string& destCode,
+                         int& mode, int& routeRangeNm) {
+    json::value response;
 
     auto startParam = queryParams.find(U("start"));
     auto destParam = queryParams.find(U("dest"));
     auto modeParam = queryParams.find(U("mode"));
-    auto rangeParam = queryParams.find(U("range"));
-    std::string startCode = startParam != queryParams.end() ? utility::conversions::to_utf8string(startParam->second) : "";
-    std::string destCode = destParam != queryParams.end() ? utility::conversions::to_utf8string(destParam->second) : "";
-    int mode = 0;
-    int routeRangeNm = aircraftRangeNm.load();
+    startCode = startParam != queryParams.end() ? utility::conversions::to_utf8string(startParam->second) : "";
+    destCode = destParam != queryParams.end() ? utility::conversions::to_utf8string(destParam->second) : "";
+    mode = 0;
 
     if (modeParam != queryParams.end()) {
         try {
@@ -243,40 +499,158 @@ void handleRoute(http_request request) {
         } catch (const std::exception&) {
             response[U("error")] = json::value::string(U("invalid mode parameter"));
             sendJson(request, status_codes::BadRequest, response);
-            return;
+            return false;
         }
     }
 
-    if (rangeParam != queryParams.end()) {
+    if (!readRangeParameter(request, queryParams, routeRangeNm)) {
+        return false;
+    }
+
+    if (startCode.empty() || !routeGraph->isValidAirport(startCode)) {
+        response[U("error")] = json::value::string(U("invalid or missing start parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+
+    if (destCode.empty() || !routeGraph->isValidAirport(destCode)) {
+        response[U("error")] = json::value::string(U("invalid or missing destination parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+    return true;
+}
+
+// Returns a path as a JSON array of strings.
+json::value pathToJson(const std::vector<std::string>& path) {
+    json::value array = json::value::array(path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        array[i] = json::value::string(utility::conversions::to_string_t(path[i]));
+    }
+    return array;
+}
+
+/**
+ * Returns the route from the route cache, searching with context on a miss. Popular pairs are searched once, and
+ * identical requests that arrive during the search wait for it. With maxStops (not -1), the route is the shortest
+ * with at most that many stops, whatever the algorithm.
+ */
+std::shared_ptr<const RouteCache::Route> cachedRoute(const std::shared_ptr<Graph>& routeGraph, const std::string& startCode,
+                                                     const std::string& destCode, int mode, int routeRangeNm,
+                                                     RouteAlgorithm algorithm, int maxStops, SearchContext& context) {
+    RouteCache::Key key{startCode, destCode, routeRangeNm, mode, static_cast<int>(algorithm), maxStops};
+    return routeCache->getOrCompute(key, [&]() {
+        if (maxStops >= 0) {
+            return routeGraph->getShortestPathWithStops(startCode, destCode, context, maxStops, mode, routeRangeNm);
+        }
+        return routeGraph->getShortestPath(startCode, destCode, context, mode, routeRangeNm, algorithm);
+    });
+}
+
+/**
+ * Returns why algorithm cannot answer routes over range, or an empty string if it can. Contraction hierarchies and
+ * landmarks are built at startup rather than on a request, so algorithm=ch is only served for the ranges in CH_RANGES
+ * and algorithm=alt for those in ALT_RANGES.
+ */
+std::string unservedAlgorithmError(const std::shared_ptr<Graph>& routeGraph, RouteAlgorithm algorithm, int range) {
+    const std::vector<int>* built = nullptr;
+    std::string setting;
+    if (algorithm == RouteAlgorithm::ContractionHierarchy && !routeGraph->hasContractionHierarchy(range)) {
+        built = &contractionHierarchyRanges;
+        setting = "CH_RANGES";
+    } else if (algorithm == RouteAlgorithm::Landmarks && !routeGraph->hasLandmarks(range)) {
+        built = &landmarkRanges;
+        setting = "ALT_RANGES";
+    } else {
+        return "";
+    }
+    std::string ranges;
+    for (int builtRange : *built) {
+        ranges += (ranges.empty() ? "" : ", ") + std::to_string(builtRange);
+    }
+    return "algorithm " + routeAlgorithmName(algorithm) + " is only available for the ranges in " + setting + " (" +
+           (ranges.empty() ? "none" : ranges) + ")";
+}
+
+/**
+ * Handles GET /route?start=<startCode>&dest=<destCode>&range=<desiredRange>&algorithm=<algorithm>&maxStops=<stops>
+ * (algorithm is one of the names accepted by parseRouteAlgorithm, fewest-landings by default). With maxStops, the
+ * route is the shortest one that lands at most that many times on the way, and algorithm cannot be given.
+ */
+void handleRoute(http_request request) {
+    json::value response;
+
+    utility::string_t queryString = request.request_uri().query();
+    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+
+    auto algorithmParam = queryParams.find(U("algorithm"));
+    RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings;
+
+    if (algorithmParam != queryParams.end() &&
+        !parseRouteAlgorithm(utility::conversions::to_utf8string(algorithmParam->second), algorithm)) {
+        response[U("error")] = json::value::string(U("algorithm must be fewest-landings, distance, astar, bidirectional, bidirectional-fewest-landings, ch or alt"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    auto maxStopsParam = queryParams.find(U("maxStops"));
+    int maxStops = -1;
+    if (maxStopsParam != queryParams.end()) {
         try {
-            routeRangeNm = std::stoi(utility::conversions::to_utf8string(rangeParam->second));
-            if (routeRangeNm <= 0) {
-                response[U("error")] = json::value::string(U("range must be greater than 0"));
-                sendJson(request, status_codes::BadRequest, response);
-                return;
-            }
+            maxStops = std::stoi(utility::conversions::to_utf8string(maxStopsParam->second));
         } catch (const std::exception&) {
-            response[U("error")] = json::value::string(U("invalid range parameter"));
+            maxStops = -1;
+        }
+        if (maxStops < 0 || maxStops > MAX_STOPS) {
+            response[U("error")] = json::value::string(utility::conversions::to_string_t(
+                "maxStops must be between 0 and " + std::to_string(MAX_STOPS)));
+            sendJson(request, status_codes::BadRequest, response);
+            return;
+        }
+        if (algorithmParam != queryParams.end()) {
+            response[U("error")] = json::value::string(U("maxStops cannot be combined with algorithm"));
             sendJson(request, status_codes::BadRequest, response);
             return;
         }
     }
 
-    std::shared_ptr<Graph> routeGraph = getGraphForRange(routeRangeNm);
-
-    if (startCode.empty() || !routeGraph->isValidAirport(startCode)) {
-        response[U("error")] = json::value::string(U("invalid or missing start parameter"));
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+    std::string startCode, destCode;
+    int mode, routeRangeNm;
+    if (!readRouteParameters(request, queryParams, routeGraph, startCode, destCode, mode, routeRangeNm)) {
+        return;
+    }
+    std::string unserved = unservedAlgorithmError(routeGraph, algorithm, routeRangeNm);
+    if (!unserved.empty()) {
+        response[U("error")] = json::value::string(utility::conversions::to_string_t(unserved));
         sendJson(request, status_codes::BadRequest, response);
         return;
     }
 
-    if (destCode.empty() || !routeGraph->isValidAirport(destCode)) {
-        response[U("error")] = json::value::string(U("invalid or missing destination parameter"));
-        sendJson(request, status_codes::BadRequest, response);
+    // airports the range does not connect are rejected without a search, with the smallest range that connects them
+    // and the component (the airports a route within range connects) of each
+    std::shared_ptr<const MinimumRangeTree> tree = routeGraph->prepareMinimumRangeTree();
+    int startIdx = routeGraph->getAirportIndex(startCode);
+    int destIdx = routeGraph->getAirportIndex(destCode);
+    int minimumRangeNm = static_cast<int>(tree->minimumRange(startIdx, destIdx));
+    if (minimumRangeNm > routeRangeNm) {
+        int startComponent = static_cast<int>(tree->component(startIdx, routeRangeNm));
+        int destComponent = static_cast<int>(tree->component(destIdx, routeRangeNm));
+        response[U("error")] = json::value::string(U("no reachable path found"));
+        response[U("minimumRangeNm")] = json::value::number(minimumRangeNm);
+        response[U("startComponent")] = json::value::number(startComponent);
+        response[U("startComponentSize")] = json::value::number(static_cast<int>(tree->componentSize(startComponent)));
+        response[U("destComponent")] = json::value::number(destComponent);
+        response[U("destComponentSize")] = json::value::number(static_cast<int>(tree->componentSize(destComponent)));
+        sendJson(request, status_codes::NotFound, response);
         return;
     }
 
-    std::pair<std::vector<std::string>, double> res = routeGraph->getShortestPath(startCode, destCode, mode);
+    // each cpprest worker keeps the working memory of its searches from one request to the next
+    thread_local SearchContext searchContext;
+    std::shared_ptr<const RouteCache::Route> cached = cachedRoute(routeGraph, startCode, destCode, mode, routeRangeNm,
+                                                                  algorithm, maxStops, searchContext);
+    const RouteCache::Route& res = *cached;
 
     if (res.first.empty()) {
         response[U("error")] = json::value::string(U("no reachable path found"));
@@ -287,16 +661,558 @@ void handleRoute(http_request request) {
     response[U("start")] = json::value::string(utility::conversions::to_string_t(startCode));
     response[U("dest")] = json::value::string(utility::conversions::to_string_t(destCode));
     response[U("distance")] = json::value::number(res.second);
-    response[U("path")] = json::value::array(res.first.size());
+    response[U("path")] = pathToJson(res.first);
     response[U("rangeNm")] = json::value::number(routeRangeNm);
+    if (maxStops >= 0) {
+        response[U("maxStops")] = json::value::number(maxStops);
+        response[U("stops")] = json::value::number(static_cast<int>(res.first.size()) - 2);
+    } else {
+        response[U("algorithm")] = json::value::string(utility::conversions::to_string_t(routeAlgorithmName(algorithm)));
+    }
+
+    sendJson(request, status_codes::OK, response);
+}
+
+/**
+ * Handles GET /route/alternatives?start=<startCode>&dest=<destCode>&range=<desiredRange>&k=<count>
+ * Returns up to k routes that visit no airport twice, shortest first (k is 3 by default, at most MAX_ALTERNATIVES).
+ */
+void handleRouteAlternatives(http_request request) {
+    json::value response;
+
+    utility::string_t queryString = request.request_uri().query();
+    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+
+    auto kParam = queryParams.find(U("k"));
+    int k = 3;
+    if (kParam != queryParams.end()) {
+        try {
+            k = std::stoi(utility::conversions::to_utf8string(kParam->second));
+        } catch (const std::exception&) {
+            k = 0;
+        }
+        if (k <= 0 || k > MAX_ALTERNATIVES) {
+            response[U("error")] = json::value::string(utility::conversions::to_string_t(
+                "k must be between 1 and " + std::to_string(MAX_ALTERNATIVES)));
+            sendJson(request, status_codes::BadRequest, response);
+            return;
+        }
+    }
+
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+    std::string startCode, destCode;
+    int mode, routeRangeNm;
+    if (!readRouteParameters(request, queryParams, routeGraph, startCode, destCode, mode, routeRangeNm)) {
+        return;
+    }
+
+    // the spur searches run on the shared pool, whose workers keep their search contexts between requests
+    std::vector<std::pair<std::vector<std::string>, double>> routes = routeGraph->getKShortestPaths(startCode, destCode, k,
+                                                                                                   *searchPool, mode,
+                                                                                                   routeRangeNm);
+
+    if (routes.empty()) {
+        response[U("error")] = json::value::string(U("no reachable path found"));
+        sendJson(request, status_codes::NotFound, response);
+        return;
+    }
 
-    for (size_t i = 0; i < res.first.size(); i++) {
-        response[U("path")][i] = json::value::string(utility::conversions::to_string_t(res.first[i]));
+    response[U("start")] = json::value::string(utility::conversions::to_string_t(startCode));
+    response[U("dest")] = json::value::string(utility::conversions::to_string_t(destCode));
+    response[U("rangeNm")] = json::value::number(routeRangeNm);
+    response[U("routes")] = json::value::array(routes.size());
+    for (size_t i = 0; i < routes.size(); i++) {
+        response[U("routes")][i][U("distance")] = json::value::number(routes[i].second);
+        response[U("routes")][i][U("path")] = pathToJson(routes[i].first);
     }
 
     sendJson(request, status_codes::OK, response);
 }
 
+/**
+ * Handles GET /route/min-range?start=<startCode>&dest=<destCode>
+ * Returns the smallest aircraft range at which any route connects the two airports. withinMaxRange is false when
+ * that range is beyond MAX_RANGE_NM, so /route cannot fly it.
+ */
+void handleMinimumRange(http_request request) {
+    json::value response;
+
+    utility::string_t queryString = request.request_uri().query();
+    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+
+    auto startParam = queryParams.find(U("start"));
+    auto destParam = queryParams.find(U("dest"));
+    std::string startCode = startParam != queryParams.end() ? utility::conversions::to_utf8string(startParam->second) : "";
+    std::string destCode = destParam != queryParams.end() ? utility::conversions::to_utf8string(destParam->second) : "";
+
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+
+    if (startCode.empty() || !routeGraph->isValidAirport(startCode)) {
+        response[U("error")] = json::value::string(U("invalid or missing start parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    if (destCode.empty() || !routeGraph->isValidAirport(destCode)) {
+        response[U("error")] = json::value::string(U("invalid or missing destination parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    int minimumRange = routeGraph->minimumRange(startCode, destCode);
+
+    response[U("start")] = json::value::string(utility::conversions::to_string_t(startCode));
+    response[U("dest")] = json::value::string(utility::conversions::to_string_t(destCode));
+    response[U("minRangeNm")] = json::value::number(minimumRange);
+    response[U("withinMaxRange")] = json::value::boolean(minimumRange <= maxRangeNm);
+
+    sendJson(request, status_codes::OK, response);
+}
+
+/**
+ * Reads a positive integer parameter into value (left as it is if the parameter is not given).
+ * Sends a BadRequest and returns false if it is invalid.
+ */
+bool readPositiveParameter(http_request request, const std::map<utility::string_t, utility::string_t>& queryParams,
+                           const utility::string_t& name, int& value) {
+    auto param = queryParams.find(name);
+    if (param == queryParams.end()) {
+        return true;
+    }
+    try {
+        value = std::stoi(utility::conversions::to_utf8string(param->second));
+    } catch (const std::exception&) {
+        value = 0;
+    }
+    if (value <= 0) {
+        json::value response;
+        response[U("error")] = json::value::string(utility::conversions::to_string_t(
+            utility::conversions::to_utf8string(name) + " must be an integer greater than 0"));
+        sendJson(request, status_codes::BadRequest, response);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Handles GET /reachable?start=<startCode>&maxHops=<flights>&maxDist=<nm>&range=<desiredRange>
+ * Returns every airport reachable from start within maxHops flights and maxDist nm (at least one is required),
+ * closest first, as parallel arrays of codes, distances of the shortest route within the limits, and its flights.
+ * The body is written as text, since it can hold every airport in the dataset.
+ */
+void handleReachable(http_request request) {
+    json::value response;
+
+    utility::string_t queryString = request.request_uri().query();
+    std::map<utility::string_t, utility::string_t> queryParams = uri::split_query(queryString);
+
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+    auto startParam = queryParams.find(U("start"));
+    std::string startCode = startParam != queryParams.end() ? utility::conversions::to_utf8string(startParam->second) : "";
+    int maxHops = ReachableAirports::NO_LIMIT;
+    int maxDistance = ReachableAirports::NO_LIMIT;
+    int routeRangeNm;
+
+    if (!readPositiveParameter(request, queryParams, U("maxHops"), maxHops) ||
+        !readPositiveParameter(request, queryParams, U("maxDist"), maxDistance) ||
+        !readRangeParameter(request, queryParams, routeRangeNm)) {
+        return;
+    }
+
+    if (maxHops == ReachableAirports::NO_LIMIT && maxDistance == ReachableAirports::NO_LIMIT) {
+        response[U("error")] = json::value::string(U("missing maxHops or maxDist parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    if (startCode.empty() || !routeGraph->isValidAirport(startCode)) {
+        response[U("error")] = json::value::string(U("invalid or missing start parameter"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    ReachableAirports reachable = routeGraph->reachableAirports(startCode, maxHops, maxDistance, routeRangeNm);
+    const AirportTable& airportTable = routeGraph->getAirportTable();
+
+    // about 10 bytes per airport code and 6 per number
+    std::string body;
+    body.reserve(128 + reachable.size() * 24);
+    body += "{\"start\":";
+    appendJsonString(body, startCode);
+    body += ",\"rangeNm\":" + std::to_string(routeRangeNm);
+    body += ",\"maxHops\":" + (maxHops == ReachableAirports::NO_LIMIT ? "null" : std::to_string(maxHops));
+    body += ",\"maxDist\":" + (maxDistance == ReachableAirports::NO_LIMIT ? "null" : std::to_string(maxDistance));
+    body += ",\"count\":" + std::to_string(reachable.size());
+    body += ",\"airports\":[";
+    for (size_t i = 0; i < reachable.size(); i++) {
+        if (i > 0) {
+            body += ',';
+        }
+        appendJsonString(body, airportTable.id(reachable.airport(i)));
+    }
+    body += "],\"distances\":[";
+    for (size_t i = 0; i < reachable.size(); i++) {
+        if (i > 0) {
+            body += ',';
+        }
+        body += std::to_string(reachable.distance(i));
+    }
+    body += "],\"hops\":[";
+    for (size_t i = 0; i < reachable.size(); i++) {
+        if (i > 0) {
+            body += ',';
+        }
+        body += std::to_string(reachable.hops(i));
+    }
+    body += "]}";
+
+    sendJsonText(request, status_codes::OK, std::move(body));
+}
+
+/**
+ * Reads the airport codes of an array field of a POST /matrix body into codes.
+ * Returns an error message, or an empty string if every element is a valid airport code.
+ */
+std::string readMatrixAirports(const json::value& body, const utility::string_t& field, const std::shared_ptr<Graph>& routeGraph,
+                               std::vector<std::string>& codes) {
+    std::string name = utility::conversions::to_utf8string(field);
+    if (!body.has_field(field) || !body.at(field).is_array() || body.at(field).as_array().size() == 0) {
+        return name + " must be a non-empty array of airport codes";
+    }
+    if (body.at(field).as_array().size() > MAX_MATRIX_AIRPORTS) {
+        return name + " must have at most " + std::to_string(MAX_MATRIX_AIRPORTS) + " airports";
+    }
+    for (const json::value& code : body.at(field).as_array()) {
+        if (!code.is_string() || !routeGraph->isValidAirport(utility::conversions::to_utf8string(code.as_string()))) {
+            return name + " must only contain valid airport codes";
+        }
+        codes.push_back(utility::conversions::to_utf8string(code.as_string()));
+    }
+    return "";
+}
+
+/**
+ * Handles POST /matrix with a body {"sources": [codes], "targets": [codes], "range": nm, "paths": bool, "mode": 0 or 1}.
+ * Returns the shortest routes (by distance, then landings) from every source to every target as dense matrices
+ * of distances and flights (null where there is no route), and of paths if "paths" is true. range defaults to
+ * the configured aircraft range, and mode 1 gives the paths as airport names instead of codes.
+ */
+void handleMatrix(http_request request) {
+    json::value response;
+    json::value body;
+    try {
+        body = request.extract_json().get();
+    } catch (const std::exception&) {
+        response[U("error")] = json::value::string(U("invalid JSON body"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+    std::vector<std::string> sources, targets;
+    std::string error = body.is_object() ? readMatrixAirports(body, U("sources"), routeGraph, sources)
+                                         : "body must be a JSON object";
+    if (error.empty()) {
+        error = readMatrixAirports(body, U("targets"), routeGraph, targets);
+    }
+
+    int routeRangeNm = aircraftRangeNm.load();
+    if (error.empty() && body.has_field(U("range"))) {
+        if (!body.at(U("range")).is_integer() || body.at(U("range")).as_integer() <= 0 ||
+            body.at(U("range")).as_integer() > maxRangeNm) {
+            error = "range must be an integer between 1 and " + std::to_string(maxRangeNm);
+        } else {
+            routeRangeNm = body.at(U("range")).as_integer();
+        }
+    }
+
+    bool includePaths = false;
+    if (error.empty() && body.has_field(U("paths"))) {
+        if (!body.at(U("paths")).is_boolean()) {
+            error = "paths must be true or false";
+        } else {
+            includePaths = body.at(U("paths")).as_bool();
+        }
+    }
+
+    int mode = 0;
+    if (error.empty() && body.has_field(U("mode"))) {
+        if (!body.at(U("mode")).is_integer()) {
+            error = "invalid mode parameter";
+        } else {
+            mode = body.at(U("mode")).as_integer();
+        }
+    }
+
+    if (!error.empty()) {
+        response[U("error")] = json::value::string(utility::conversions::to_string_t(error));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    // the searches run on the shared pool, whose workers keep their search contexts between requests
+    DistanceMatrix matrix = routeGraph->distanceMatrix(sources, targets, *searchPool, routeRangeNm, includePaths);
+    const AirportTable& airportTable = routeGraph->getAirportTable();
+
+    response[U("rangeNm")] = json::value::number(routeRangeNm);
+    response[U("sources")] = pathToJson(sources);
+    response[U("targets")] = pathToJson(targets);
+    response[U("distances")] = json::value::array(sources.size());
+    response[U("hops")] = json::value::array(sources.size());
+    if (includePaths) {
+        response[U("paths")] = json::value::array(sources.size());
+    }
+    for (size_t s = 0; s < sources.size(); s++) {
+        response[U("distances")][s] = json::value::array(targets.size());
+        response[U("hops")][s] = json::value::array(targets.size());
+        if (includePaths) {
+            response[U("paths")][s] = json::value::array(targets.size());
+        }
+        for (size_t t = 0; t < targets.size(); t++) {
+            if (matrix.distance(s, t) == DistanceMatrix::UNREACHABLE) {
+                response[U("distances")][s][t] = json::value::null();
+                response[U("hops")][s][t] = json::value::null();
+                if (includePaths) {
+                    response[U("paths")][s][t] = json::value::null();
+                }
+                continue;
+            }
+            response[U("distances")][s][t] = json::value::number(matrix.distance(s, t));
+            response[U("hops")][s][t] = json::value::number(matrix.hops(s, t));
+            if (includePaths) {
+                // the matrix's paths run from the target back to the source
+                const std::vector<int>& path = matrix.path(s, t);
+                std::vector<std::string> names;
+                for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                    names.emplace_back(mode == 1 ? airportTable.name(*it) : airportTable.id(*it));
+                }
+                response[U("paths")][s][t] = pathToJson(names);
+            }
+        }
+    }
+
+    sendJson(request, status_codes::OK, response);
+}
+
+// One query of a POST /routes batch and, once it has run, its route or why there is none.
+struct BatchRoute {
+    std::string start;
+    std::string dest;
+    int range = 0;
+    int mode = 0;
+    RouteAlgorithm algorithm = RouteAlgorithm::FewestLandings;
+    int maxStops = -1;
+    std::string error;
+    std::shared_ptr<const RouteCache::Route> route;
+};
+
+/**
+ * Reads one query of a POST /routes body into route (range defaults to the configured aircraft range).
+ * Returns an error message, or an empty string if the query is valid.
+ */
+std::string readBatchRoute(const json::value& query, const std::shared_ptr<Graph>& routeGraph, BatchRoute& route) {
+    if (!query.is_object()) {
+        return "query must be a JSON object";
+    }
+    if (query.has_field(U("start")) && query.at(U("start")).is_string()) {
+        route.start = utility::conversions::to_utf8string(query.at(U("start")).as_string());
+    }
+    if (query.has_field(U("dest")) && query.at(U("dest")).is_string()) {
+        route.dest = utility::conversions::to_utf8string(query.at(U("dest")).as_string());
+    }
+    if (route.start.empty() || !routeGraph->isValidAirport(route.start)) {
+        return "invalid or missing start parameter";
+    }
+    if (route.dest.empty() || !routeGraph->isValidAirport(route.dest)) {
+        return "invalid or missing destination parameter";
+    }
+
+    route.range = aircraftRangeNm.load();
+    if (query.has_field(U("range"))) {
+        if (!query.at(U("range")).is_integer() || query.at(U("range")).as_integer() <= 0 ||
+            query.at(U("range")).as_integer() > maxRangeNm) {
+            return "range must be an integer between 1 and " + std::to_string(maxRangeNm);
+        }
+        route.range = query.at(U("range")).as_integer();
+    }
+    if (query.has_field(U("mode"))) {
+        if (!query.at(U("mode")).is_integer()) {
+            return "invalid mode parameter";
+        }
+        route.mode = query.at(U("mode")).as_integer();
+    }
+    if (query.has_field(U("algorithm"))) {
+        if (!query.at(U("algorithm")).is_string() ||
+            !parseRouteAlgorithm(utility::conversions::to_utf8string(query.at(U("algorithm")).as_string()), route.algorithm)) {
+            return "invalid algorithm parameter";
+        }
+    }
+    if (query.has_field(U("maxStops"))) {
+        if (query.has_field(U("algorithm"))) {
+            return "maxStops cannot be combined with algorithm";
+        }
+        if (!query.at(U("maxStops")).is_integer() || query.at(U("maxStops")).as_integer() < 0 ||
+            query.at(U("maxStops")).as_integer() > MAX_STOPS) {
+            return "maxStops must be an integer between 0 and " + std::to_string(MAX_STOPS);
+        }
+        route.maxStops = query.at(U("maxStops")).as_integer();
+    }
+    return unservedAlgorithmError(routeGraph, route.algorithm, route.range);
+}
+
+/**
+ * Runs the queries routes[first, last) that have no error on the batch pool, each worker searching with its own
+ * context from searchPoolContexts. The queries are ordered by range, so each worker's run of queries mostly shares
+ * one range's cached data.
+ */
+void runBatchRoutes(const std::shared_ptr<Graph>& routeGraph, std::vector<BatchRoute>& routes, size_t first, size_t last) {
+    std::vector<size_t> order;
+    for (size_t i = first; i < last; i++) {
+        if (routes[i].error.empty()) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return routes[a].range < routes[b].range; });
+
+    searchPool->run(order.size(), [&](size_t task, size_t worker) {
+        BatchRoute& route = routes[order[task]];
+        if (routeGraph->minimumRange(route.start, route.dest) > route.range) {
+            route.error = "no reachable path found";
+            return;
+        }
+        route.route = cachedRoute(routeGraph, route.start, route.dest, route.mode, route.range, route.algorithm,
+                                  route.maxStops, searchPoolContexts[worker]);
+        if (route.route->first.empty()) {
+            route.error = "no reachable path found";
+        }
+    });
+}
+
+// Appends the result of one query of a POST /routes batch to out as a JSON object.
+void appendBatchRoute(std::string& out, const BatchRoute& route) {
+    out += "{\"start\":";
+    appendJsonString(out, route.start);
+    out += ",\"dest\":";
+    appendJsonString(out, route.dest);
+    if (!route.error.empty()) {
+        out += ",\"error\":";
+        appendJsonString(out, route.error);
+        out += '}';
+        return;
+    }
+
+    char distance[32];
+    std::snprintf(distance, sizeof(distance), "%.15g", route.route->second);
+    out += ",\"rangeNm\":" + std::to_string(route.range);
+    if (route.maxStops >= 0) {
+        out += ",\"maxStops\":" + std::to_string(route.maxStops);
+        out += ",\"stops\":" + std::to_string(static_cast<int>(route.route->first.size()) - 2);
+    } else {
+        out += ",\"algorithm\":";
+        appendJsonString(out, routeAlgorithmName(route.algorithm));
+    }
+    out += ",\"distance\":";
+    out += distance;
+    out += ",\"path\":[";
+    for (size_t i = 0; i < route.route->first.size(); i++) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendJsonString(out, route.route->first[i]);
+    }
+    out += "]}";
+}
+
+/**
+ * Handles POST /routes with a body [{"start": code, "dest": code, "range": nm, "mode": 0 or 1, "algorithm": name,
+ * "maxStops": stops}, ...] (everything but start and dest is optional, as for GET /route). Returns an array with the result of every query in
+ * the order given: the route as GET /route returns it, or the query's codes and an error. The queries run in
+ * parallel on the batch pool and share the route cache with GET /route. Batches of more than ROUTES_PER_CHUNK
+ * queries are run and streamed a chunk at a time, so the response starts before the last chunk has been searched;
+ * if a chunk fails once the response has started, the array ends with an element holding only an error.
+ */
+void handleRoutes(http_request request) {
+    json::value response;
+    json::value body;
+    try {
+        body = request.extract_json().get();
+    } catch (const std::exception&) {
+        response[U("error")] = json::value::string(U("invalid JSON body"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    if (!body.is_array() || body.as_array().size() == 0 || body.as_array().size() > MAX_BATCH_ROUTES) {
+        response[U("error")] = json::value::string(utility::conversions::to_string_t(
+            "body must be an array of 1 to " + std::to_string(MAX_BATCH_ROUTES) + " route queries"));
+        sendJson(request, status_codes::BadRequest, response);
+        return;
+    }
+
+    std::shared_ptr<Graph> routeGraph = airportGraph;
+    std::vector<BatchRoute> routes(body.as_array().size());
+    for (size_t i = 0; i < routes.size(); i++) {
+        routes[i].error = readBatchRoute(body.as_array().at(i), routeGraph, routes[i]);
+    }
+
+    if (routes.size() <= ROUTES_PER_CHUNK) {
+        runBatchRoutes(routeGraph, routes, 0, routes.size());
+        std::string text = "[";
+        for (size_t i = 0; i < routes.size(); i++) {
+            if (i > 0) {
+                text += ',';
+            }
+            appendBatchRoute(text, routes[i]);
+        }
+        text += ']';
+        sendJsonText(request, status_codes::OK, std::move(text));
+        return;
+    }
+
+    // without a length, cpprest sends the body chunked as it is written to the buffer
+    concurrency::streams::producer_consumer_buffer<uint8_t> buffer;
+    http_response streamed(status_codes::OK);
+    addCorsHeaders(streamed.headers());
+    streamed.set_body(buffer.create_istream(), U("application/json"));
+    logRequest(request, status_codes::OK);
+    request.reply(streamed);
+
+    // the status has been sent, so a failure can only end the array early; the buffer is closed either way, or the
+    // response would never end
+    std::string text;
+    size_t written = 0; // The queries whose results are in the buffer.
+    try {
+        for (size_t first = 0; first < routes.size(); first += ROUTES_PER_CHUNK) {
+            size_t last = std::min(routes.size(), first + ROUTES_PER_CHUNK);
+            runBatchRoutes(routeGraph, routes, first, last);
+
+            text.clear();
+            for (size_t i = first; i < last; i++) {
+                text += i == 0 ? '[' : ',';
+                appendBatchRoute(text, routes[i]);
+                routes[i].route.reset();
+            }
+            if (last == routes.size()) {
+                text += ']';
+            }
+            buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(text.data()), text.size()).wait();
+            written = last;
+        }
+    } catch (const std::exception& e) {
+        Logger::error("POST /routes failed after " + std::to_string(written) + " routes: " + e.what());
+        text = written == 0 ? "[" : ",";
+        text += "{\"error\":";
+        appendJsonString(text, "batch failed after " + std::to_string(written) + " routes");
+        text += "}]";
+        try {
+            buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(text.data()), text.size()).wait();
+        } catch (const std::exception&) {
+            // the client has gone; closing the buffer is all that is left
+        }
+    }
+    buffer.close(std::ios_base::out).wait();
+}
+
 void handleGet(http_request request) {
     utility::string_t path = request.relative_uri().path();
 
@@ -309,12 +1225,27 @@ void handleGet(http_request request) {
     else if (path == U("/config")) {
         handleGetConfig(request);
     }
+    else if (path == U("/cache/stats")) {
+        handleCacheStats(request);
+    }
+    else if (path == U("/airports/near")) {
+        handleNearbyAirports(request);
+    }
     else if (path.rfind(U("/airports/"), 0) == 0) {
         handleAirportDetail(request);
     }
+    else if (path == U("/route/min-range")) {
+        handleMinimumRange(request);
+    }
+    else if (path == U("/route/alternatives")) {
+        handleRouteAlternatives(request);
+    }
     else if (path == U("/route")) {
         handleRoute(request);
     }
+    else if (path == U("/reachable")) {
+        handleReachable(request);
+    }
     else {
         json::value response;
         response[U("error")] = json::value::string(U("endpoint not found"));
@@ -336,6 +1267,43 @@ void handlePut(http_request request) {
     }
 }
 
+void handlePost(http_request request) {
+    utility::string_t path = request.relative_uri().path();
+
+    if (path == U("/matrix")) {
+        handleMatrix(request);
+    }
+    else if (path == U("/routes")) {
+        handleRoutes(request);
+    }
+    else {
+        json::value response;
+        response[U("error")] = json::value::string(U("endpoint not found"));
+        sendJson(request, status_codes::NotFound, response);
+    }
+}
+
+
+/**
+ * Reads the comma-separated ranges of the setting name (CH_RANGES or ALT_RANGES), skipping invalid ones and any past
+ * the Graph::MAX_PREPARED_RANGES the graph keeps.
+ */
+std::vector<int> readRangeList(const std::string& name, const char* value) {
+    std::vector<int> ranges;
+    std::istringstream list(value);
+    std::string range;
+    while (std::getline(list, range, ',')) {
+        if (!isInteger(range) || toInteger(range) <= 0 || toInteger(range) > maxRangeNm) {
+            Logger::warning("Ignoring invalid " + name + " value: " + range);
+        } else if (ranges.size() == Graph::MAX_PREPARED_RANGES) {
+            Logger::warning("Ignoring " + name + " value " + range + ": at most " +
+                            std::to_string(Graph::MAX_PREPARED_RANGES) + " ranges are kept");
+        } else {
+            ranges.push_back(toInteger(range));
+        }
+    }
+    return ranges;
+}
 
 int main() {
     std::signal(SIGINT, handleShutdownSignal);
@@ -343,26 +1311,79 @@ int main() {
 
     http_listener listener(web_link);
 
+    if (const char* threads = std::getenv("GRAPH_BUILD_THREADS")) {
+        if (isInteger(threads) && toInteger(threads) >= 0) {
+            graphBuildThreads = toInteger(threads);
+            // more build threads than hardware threads only take turns on the same cores
+            int hardwareThreads = static_cast<int>(resolveThreadCount(0));
+            if (graphBuildThreads > hardwareThreads) {
+                Logger::warning("Clamping GRAPH_BUILD_THREADS to the " + std::to_string(hardwareThreads) + " hardware threads");
+                graphBuildThreads = hardwareThreads;
+            }
+        } else {
+            Logger::warning("Ignoring invalid GRAPH_BUILD_THREADS value: " + std::string(threads));
+        }
+    }
 
-    std::ifstream file("./datasets/airports.json");
+    if (const char* threads = std::getenv("ROUTE_SEARCH_THREADS")) {
+        if (std::string(threads) == "1" || std::string(threads) == "2") {
+            routeSearchThreads = toInteger(threads);
+        } else {
+            Logger::warning("Ignoring invalid ROUTE_SEARCH_THREADS value (expected 1 or 2): " + std::string(threads));
+        }
+    }
 
-    // read airports data from airports.json
-    try {
-        if (!file.is_open()) {
-            Logger::error("Could not open airports dataset");
-            return 1;
+    if (const char* range = std::getenv("MAX_RANGE_NM")) {
+        if (isInteger(range) && toInteger(range) > 0) {
+            maxRangeNm = toInteger(range);
+        } else {
+            Logger::warning("Ignoring invalid MAX_RANGE_NM value: " + std::string(range));
         }
-        file >> airportsData;
-        Logger::info("Loaded " + std::to_string(airportsData.size()) + " airports");
-    } catch (const std::exception& e) {
-        Logger::error("Failed to parse airports dataset: " + std::string(e.what()));
-        return 1;
     }
 
-    getGraphForRange(aircraftRangeNm.load());
+    if (const char* ranges = std::getenv("CH_RANGES")) {
+        contractionHierarchyRanges = readRangeList("CH_RANGES", ranges);
+    }
+
+    if (const char* ranges = std::getenv("ALT_RANGES")) {
+        landmarkRanges = readRangeList("ALT_RANGES", ranges);
+    } else {
+        landmarkRanges = {std::min(aircraftRangeNm.load(), maxRangeNm)};
+    }
+
+    if (const char* threads = std::getenv("ROUTE_BATCH_THREADS")) {
+        if (isInteger(threads) && toInteger(threads) >= 0) {
+            routeBatchThreads = toInteger(threads);
+        } else {
+            Logger::warning("Ignoring invalid ROUTE_BATCH_THREADS value: " + std::string(threads));
+        }
+    }
+    searchPool = std::make_unique<WorkStealingPool>(routeBatchThreads);
+    searchPoolContexts = std::vector<SearchContext>(searchPool->size());
+
+    if (const char* megabytes = std::getenv("ROUTE_CACHE_MB")) {
+        if (isInteger(megabytes) && toInteger(megabytes) >= 0) {
+            routeCacheBytes = static_cast<size_t>(toInteger(megabytes)) * 1024 * 1024;
+        } else {
+            Logger::warning("Ignoring invalid ROUTE_CACHE_MB value: " + std::string(megabytes));
+        }
+    }
+    routeCache = std::make_unique<RouteCache>(routeCacheBytes);
+
+    if (const char* snapshot = std::getenv("GRAPH_SNAPSHOT")) {
+        graphSnapshotPath = snapshot;
+    }
+
+    if (!loadAirportGraph()) {
+        return 1;
+    }
+    if (aircraftRangeNm.load() > maxRangeNm) {
+        aircraftRangeNm.store(maxRangeNm);
+    }
 
     listener.support(methods::GET, handleGet);
     listener.support(methods::PUT, handlePut);
+    listener.support(methods::POST, handlePost);
     listener.support(methods::OPTIONS, handleOptions);
     try {
         listener.open().wait();
@@ -377,9 +1398,16 @@ int main() {
     std::cout << "  GET /health" << std::endl;
     std::cout << "  GET /airports?search=ottawa" << std::endl;
     std::cout << "  GET /airports/CYOW" << std::endl;
+    std::cout << "  GET /airports/near?lat=45.32&lon=-75.67&k=5" << std::endl;
     std::cout << "  GET /config" << std::endl;
+    std::cout << "  GET /cache/stats" << std::endl;
     std::cout << "  PUT /config/range?range=500" << std::endl;
     std::cout << "  GET /route?start=CYOW&dest=CYYZ" << std::endl;
+    std::cout << "  GET /route/alternatives?start=CYOW&dest=CYYZ&k=3" << std::endl;
+    std::cout << "  GET /route/min-range?start=CYOW&dest=EGLL" << std::endl;
+    std::cout << "  GET /reachable?start=CYOW&maxHops=2&range=500" << std::endl;
+    std::cout << "  POST /matrix {\"sources\": [\"CYOW\"], \"targets\": [\"CYYZ\", \"KJFK\"]}" << std::endl;
+    std::cout << "  POST /routes [{\"start\": \"CYOW\", \"dest\": \"CYYZ\"}, {\"start\": \"CYOW\", \"dest\": \"KLAX\", \"range\": 800}]" << std::endl;
     std::cout << "Press Ctrl+C to stop..." << std::endl;
 
     while (running) {
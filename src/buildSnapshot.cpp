@@ -0,0 +1,43 @@
+/**
+ * @file: buildSnapshot.cpp
+ * @author: 0Ykahil
+ *
+ * Offline tool that generates the airport graph from a JSON dataset and writes it to a
+ * binary snapshot, which api_service and flightPathOptimizer can start from instantly.
+ *
+ * Usage: ./build/buildSnapshot [dataset.json] [maxRangeNm] [output.snapshot]
+ */
+#include <iostream>
+#include <chrono>
+#include "Graph.h"
+#include "utility_functions.h"
+
+int main(int argc, char* argv[]) {
+    std::string datasetPath = argc > 1 ? argv[1] : "./datasets/airports.json";
+    std::string rangeText = argc > 2 ? argv[2] : "2000";
+    std::string snapshotPath = argc > 3 ? argv[3] : "./datasets/airports.snapshot";
+
+    if (!isInteger(rangeText) || toInteger(rangeText) <= 0) {
+        std::cerr << "Usage: buildSnapshot [dataset.json] [maxRangeNm] [output.snapshot]" << std::endl;
+        return 1;
+    }
+    int maxRange = toInteger(rangeText);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    try {
+        AirportTable airports = AirportTable::load(datasetPath);
+
+        Graph g(airports.size());
+        g.generateAirportGraph(airports, maxRange, true, BuildMode::SpatialGrid);
+        g.saveSnapshot(snapshotPath);
+
+        std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - t1;
+        std::cout << "Wrote " << snapshotPath << ": " << g.getAirports().size() << " airports, "
+                  << g.edgeCount() << " edges, ranges up to " << maxRange << "nm (" << ms.count() << "ms)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to build snapshot: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
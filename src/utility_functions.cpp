@@ -5,6 +5,8 @@
  * Implementation of the utility functions
  */
 #include "utility_functions.h"
+#include <charconv>
+#include <cmath>
 #include <filesystem>
 namespace fs = std::filesystem;
 
@@ -67,6 +69,20 @@ int toInteger(const std::string& string) {
     return out;
 }
 
+bool toFiniteDouble(const std::string& string, double& out) {
+    double value = 0;
+    try {
+        value = std::stod(string);
+    } catch (const std::exception&) {
+        return false; // not a number, or outside the range of a double
+    }
+    if (!std::isfinite(value)) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
 bool fileExists(const std::string& filename) {
     std::ifstream file(filename);
     return file.good();
@@ -138,6 +154,12 @@ std::string toUpperCase(std::string str) {
     return out;
 }
 
+std::string formatCoordinate(double degrees) {
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), degrees);
+    return std::string(buffer, result.ptr);
+}
+
 int promptRange() {
     std::string input; // Will hold the string input OR the value from read()
     int out = 0; // Will carry the integer value of input and be returned
@@ -6,14 +6,122 @@
  */
 #include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <set>
+#include <random>
+#include <functional>
+#include <thread>
+#include <atomic>
 #include <catch2/catch.hpp>
 #include "Graph.h"
 #include "Airport.h"
+#include "DistanceKernel.h"
+#include "RouteCache.h"
+#include "WorkStealing.h"
 
 Airport a1("YOW", "Ottawa", "medium_airport", 45.3225, -75.6692);
 Airport a2("JFK", "New York", "large_airport", 40.6413, -73.7781);
 Airport a3("LAX", "Los Angeles", "large_airport", 33.9416, -118.4085);
 
+namespace {
+
+// The airports of airports.json in a graph generated at 500nm, built once and shared by the tests that only search it.
+Graph& airportsGraph() {
+    static std::unique_ptr<Graph> graph = [] {
+        auto g = std::make_unique<Graph>(0);
+        g->generateAirportGraph(AirportTable::load("./datasets/airports.json"), 500, false, BuildMode::SpatialGrid);
+        // routes are only searched on hierarchies and landmarks built beforehand
+        for (int range : {250, 500}) {
+            g->prepareContractionHierarchy(range);
+            g->prepareLandmarks(range);
+        }
+        return g;
+    }();
+    return *graph;
+}
+
+// Returns count (start, dest) pairs of airport indices spread over n airports.
+std::vector<std::pair<size_t, size_t>> samplePairs(size_t n, size_t count) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < count; ++i) {
+        pairs.push_back({(i * 37) % n, (i * 101 + 13) % n});
+    }
+    return pairs;
+}
+
+/**
+ * Returns the shortest distance from start to every airport at range (-1 where there is no route), from a Dijkstra
+ * that settles every airport it reaches (reachableAirports without limits), so it takes no shortcuts.
+ */
+std::vector<int> dijkstraDistances(Graph& g, size_t start, int range) {
+    std::vector<int> distances(g.getAirportTable().size(), -1);
+    distances[start] = 0;
+    ReachableAirports reachable = g.reachableAirports(std::string(g.getAirportTable().id(start)), ReachableAirports::NO_LIMIT,
+                                                      ReachableAirports::NO_LIMIT, range);
+    for (size_t i = 0; i < reachable.size(); ++i) {
+        distances[reachable.airport(i)] = reachable.distance(i);
+    }
+    return distances;
+}
+
+/**
+ * Returns the length of the route every algorithm should find from start to dest at range (-1 if there is none):
+ * the direct flight if there is one, as every algorithm takes it to avoid landings, or else Dijkstra's distance.
+ */
+int expectedDistance(Graph& g, size_t start, size_t dest, int range) {
+    ReachableAirports direct = g.reachableAirports(std::string(g.getAirportTable().id(start)), 1,
+                                                   ReachableAirports::NO_LIMIT, range);
+    for (size_t i = 0; i < direct.size(); ++i) {
+        if (direct.airport(i) == dest) {
+            return direct.distance(i);
+        }
+    }
+    return dijkstraDistances(g, start, range)[dest];
+}
+
+// Requires route (in the format of findShortestPath) to go from start to dest and be expected nm long, or to be empty if expected is -1.
+void requireRoute(const std::pair<std::vector<int>, double>& route, size_t start, size_t dest, int expected) {
+    if (expected < 0) {
+        REQUIRE(route.first.empty());
+        return;
+    }
+    REQUIRE_FALSE(route.first.empty());
+    REQUIRE(route.second == expected);
+    REQUIRE(route.first.front() == static_cast<int>(dest));
+    REQUIRE(route.first.back() == static_cast<int>(start));
+}
+
+// The algorithms that find the shortest route. The fewest-landings ones trade distance for landings, and Distance
+// returns the first route with a direct flight to the destination that it finds.
+const std::vector<RouteAlgorithm> SHORTEST_ROUTE_ALGORITHMS = {RouteAlgorithm::AStar, RouteAlgorithm::Bidirectional,
+                                                               RouteAlgorithm::ContractionHierarchy, RouteAlgorithm::Landmarks};
+const std::vector<RouteAlgorithm> HEURISTIC_ROUTE_ALGORITHMS = {RouteAlgorithm::FewestLandings, RouteAlgorithm::Distance,
+                                                                RouteAlgorithm::BidirectionalFewestLandings};
+
+/**
+ * Requires every algorithm to agree with Dijkstra on a pair at range: the shortest route algorithms find a route
+ * expected nm long (see expectedDistance), and the others a route no shorter, or none of them a route when there is none.
+ */
+void requireRoutesMatchDijkstra(Graph& g, size_t start, size_t dest, int range, int expected) {
+    Airport from = g.getAirportTable().airport(start);
+    Airport to = g.getAirportTable().airport(dest);
+    for (RouteAlgorithm algorithm : SHORTEST_ROUTE_ALGORITHMS) {
+        requireRoute(g.findShortestPath(from, to, range, algorithm), start, dest, expected);
+    }
+    requireRoute(g.findShortestPathBidirectional(from, to, range, false, true), start, dest, expected);
+    for (RouteAlgorithm algorithm : HEURISTIC_ROUTE_ALGORITHMS) {
+        std::pair<std::vector<int>, double> route = g.findShortestPath(from, to, range, algorithm);
+        REQUIRE(route.first.empty() == (expected < 0));
+        if (expected >= 0) {
+            REQUIRE(route.second >= expected);
+            REQUIRE(route.first.front() == static_cast<int>(dest));
+            REQUIRE(route.first.back() == static_cast<int>(start));
+        }
+    }
+}
+
+}
+
 TEST_CASE("Graph with 1 vertex") {
     size_t numAirports = 1;
 
@@ -223,6 +331,69 @@ TEST_CASE("getShortestPath can return airport names") {
     REQUIRE(result.second == 45);
 }
 
+TEST_CASE("A* finds the same routes as the distance mode") {
+    std::ifstream file("./datasets/testairports_multi.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 250, false);
+
+    for (const auto& [start, dest] : std::vector<std::pair<std::string, std::string>>{{"KCLE", "CYOW"}, {"CYYZ", "KIAG"}, {"CYOW", "KMDW"}}) {
+        REQUIRE(g.getShortestPath(start, dest, 0, Graph::UNLIMITED_RANGE, RouteAlgorithm::AStar) ==
+                g.getShortestPath(start, dest, 0, Graph::UNLIMITED_RANGE, RouteAlgorithm::Distance));
+    }
+    std::pair<std::vector<std::string>, double> result = g.getShortestPath("KCLE", "CYOW", 0, Graph::UNLIMITED_RANGE, RouteAlgorithm::AStar);
+    REQUIRE(result.first == std::vector<std::string>{"KCLE", "KIAG", "CYOW"});
+    REQUIRE(result.second == 357);
+    REQUIRE(g.getShortestPath("CYYZ", "CYOW", 0, 100, RouteAlgorithm::AStar).first.empty());
+
+    RouteAlgorithm algorithm;
+    REQUIRE(parseRouteAlgorithm("astar", algorithm));
+    REQUIRE(algorithm == RouteAlgorithm::AStar);
+    REQUIRE(routeAlgorithmName(algorithm) == "astar");
+    REQUIRE_FALSE(parseRouteAlgorithm("fastest", algorithm));
+}
+
+TEST_CASE("Every route algorithm agrees with Dijkstra") {
+    Graph& g = airportsGraph();
+    size_t n = g.getAirportTable().size();
+    for (int range : {250, 500}) {
+        for (const auto& [start, dest] : samplePairs(n, 40)) {
+            requireRoutesMatchDijkstra(g, start, dest, range, expectedDistance(g, start, dest, range));
+        }
+    }
+}
+
+TEST_CASE("Every route algorithm handles unreachable pairs, a start that is the destination and a range below every flight") {
+    Graph& g = airportsGraph();
+    size_t n = g.getAirportTable().size();
+
+    // airports in different parts of the network at 150nm
+    std::shared_ptr<const MinimumRangeTree> tree = g.prepareMinimumRangeTree();
+    size_t unreachable = 0;
+    for (const auto& [start, dest] : samplePairs(n, 40)) {
+        if (tree->component(start, 150) != tree->component(dest, 150)) {
+            REQUIRE(dijkstraDistances(g, start, 150)[dest] == -1);
+            requireRoutesMatchDijkstra(g, start, dest, 150, -1);
+            ++unreachable;
+        }
+    }
+    REQUIRE(unreachable > 0);
+
+    // a route to where it starts takes no flights, at any range
+    for (int range : {0, 250}) {
+        requireRoutesMatchDijkstra(g, 7, 7, range, 0);
+        REQUIRE(g.findShortestPath(g.getAirportTable().airport(7), g.getAirportTable().airport(7), range).first ==
+                std::vector<int>{7});
+    }
+
+    // no flight is shorter than a mile, so nothing but the start can be reached
+    for (const auto& [start, dest] : samplePairs(n, 10)) {
+        requireRoutesMatchDijkstra(g, start, dest, 1, start == dest ? 0 : -1);
+    }
+}
+
 TEST_CASE("getShortestPath returns empty path when no route exists") {
     std::ifstream file("./datasets/testairports_multi.json");
     nlohmann::json jsonData;
@@ -236,3 +407,1012 @@ TEST_CASE("getShortestPath returns empty path when no route exists") {
     REQUIRE(result.first.empty());
     REQUIRE(result.second == 0);
 }
+
+TEST_CASE("Spatial grid build produces the same graph as the all pairs build") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    for (int threshold : {0, 45, 250, 1000}) {
+        Graph allPairs(jsonData.size());
+        allPairs.generateAirportGraph(jsonData, threshold, false);
+        Graph grid(jsonData.size());
+        grid.generateAirportGraph(jsonData, threshold, false, BuildMode::SpatialGrid);
+
+        std::ostringstream expected, output;
+        allPairs.printGraph(expected);
+        grid.printGraph(output);
+
+        REQUIRE(output.str() == expected.str());
+    }
+}
+
+TEST_CASE("Spatial grid build handles the antimeridian and the poles") {
+    nlohmann::json jsonData = nlohmann::json::parse(R"([
+        {"ident": "EAST", "name": "East", "type": "small_airport", "latitude": "0.5", "longitude": "179.9"},
+        {"ident": "WEST", "name": "West", "type": "small_airport", "latitude": "-0.5", "longitude": "-179.8"},
+        {"ident": "NPOLE", "name": "North A", "type": "small_airport", "latitude": "89.9", "longitude": "10.0"},
+        {"ident": "NPOLE2", "name": "North B", "type": "small_airport", "latitude": "89.8", "longitude": "-170.0"},
+        {"ident": "SPOLE", "name": "South A", "type": "small_airport", "latitude": "-89.95", "longitude": "45.0"},
+        {"ident": "SPOLE2", "name": "South B", "type": "small_airport", "latitude": "-89.5", "longitude": "-135.0"},
+        {"ident": "FAR", "name": "Far", "type": "small_airport", "latitude": "45.0", "longitude": "0.0"}
+    ])");
+
+    Graph allPairs(jsonData.size());
+    allPairs.generateAirportGraph(jsonData, 100, false);
+    Graph grid(jsonData.size());
+    grid.generateAirportGraph(jsonData, 100, false, BuildMode::SpatialGrid);
+
+    std::ostringstream expected, output;
+    allPairs.printGraph(expected);
+    grid.printGraph(output);
+
+    REQUIRE(output.str() == expected.str());
+    REQUIRE(grid.getShortestPath("EAST", "WEST").first.size() == 2);
+    REQUIRE(grid.getShortestPath("NPOLE", "NPOLE2").first.size() == 2);
+    REQUIRE(grid.getShortestPath("SPOLE", "SPOLE2").first.size() == 2);
+}
+
+TEST_CASE("nearestAirports and airportsWithinRadius match a full scan") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 100, false, BuildMode::SpatialGrid);
+    std::vector<Airport> airports = g.getAirports();
+
+    for (auto [lat, lon] : {std::pair<double, double>{45.32, -75.67}, {19.43, -99.07}, {89.0, 179.9}, {-10.0, -179.5}}) {
+        std::vector<double> distances;
+        for (const Airport& airport : airports) {
+            distances.push_back(haversine(lat, lon, airport.latitude, airport.longitude));
+        }
+        std::sort(distances.begin(), distances.end());
+
+        std::vector<std::pair<Airport, double>> nearest = g.nearestAirports(lat, lon, 7);
+        REQUIRE(nearest.size() == 7);
+        for (size_t i = 0; i < nearest.size(); i++) {
+            REQUIRE(nearest[i].second == Approx(distances[i]));
+        }
+
+        std::vector<std::pair<Airport, double>> within = g.airportsWithinRadius(lat, lon, 400);
+        size_t expectedCount = std::upper_bound(distances.begin(), distances.end(), 400.0) - distances.begin();
+        REQUIRE(within.size() == expectedCount);
+        for (const auto& [airport, distance] : within) {
+            REQUIRE(distance <= 400);
+        }
+    }
+
+    std::vector<std::pair<Airport, double>> closest = g.nearestAirports(45.3225, -75.6692, 1);
+    REQUIRE(closest[0].first.id == "CYOW");
+}
+
+TEST_CASE("Batched distance kernel agrees with haversine") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 0, false);
+    std::vector<Airport> airports = g.getAirports();
+    CoordinateTable table(airports);
+
+    double maxChord = chordForDistance(300);
+    std::vector<uint32_t> hits(airports.size());
+    std::vector<double> chords2(airports.size());
+
+    for (size_t i = 0; i < airports.size(); i += 97) {
+        const double q[3] = {table.x[i], table.y[i], table.z[i]};
+        size_t found = chordWithin(table.x.data(), table.y.data(), table.z.data(), airports.size(),
+                                   q, maxChord * maxChord, hits.data());
+        chordDistances2(table.x.data(), table.y.data(), table.z.data(), airports.size(), q, chords2.data());
+
+        std::vector<uint32_t> expected;
+        for (size_t j = 0; j < airports.size(); j++) {
+            if (airports[i].distanceTo(airports[j]) <= 300) {
+                expected.push_back(j);
+            }
+            double chordNm = 2 * EARTH_RADIUS_NM * std::asin(std::sqrt(chords2[j]) / 2);
+            REQUIRE(chordNm == Approx(airports[i].distanceTo(airports[j])).margin(1e-6));
+        }
+
+        REQUIRE(std::vector<uint32_t>(hits.begin(), hits.begin() + found) == expected);
+    }
+}
+
+TEST_CASE("Multithreaded builds produce the same graph as the single threaded build") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph single(jsonData.size());
+    single.generateAirportGraph(jsonData, 250, false);
+    std::ostringstream expected;
+    single.printGraph(expected);
+
+    for (BuildMode mode : {BuildMode::AllPairs, BuildMode::SpatialGrid}) {
+        for (size_t threads : {2, 3, 8}) {
+            Graph g(jsonData.size());
+            g.generateAirportGraph(jsonData, 250, true, mode, threads);
+
+            std::ostringstream output;
+            g.printGraph(output);
+            REQUIRE(output.str() == expected.str());
+        }
+    }
+}
+
+TEST_CASE("Edges added after generating the graph are frozen into the adjacency before queries") {
+    std::ifstream file("./datasets/testairports_multi.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 100, false);
+    REQUIRE(g.edgeCount() == 2);
+    REQUIRE(g.getShortestPath("CYYZ", "CYOW").first.empty());
+
+    std::vector<Airport> airports = g.getAirports();
+    g.addEdge(airports[2], airports[0]); // CYYZ <-> CYOW
+    REQUIRE(g.edgeCount() == 4);
+
+    std::pair<std::vector<std::string>, double> result = g.getShortestPath("KIAG", "CYOW");
+    std::vector<std::string> expectedPath = {"KIAG", "CYYZ", "CYOW"};
+    REQUIRE(result.first == expectedPath);
+
+    // the added flight is longer than the threshold, so the hierarchy and landmarks of ranges past it include it
+    REQUIRE(g.prepareContractionHierarchy(100) != g.prepareContractionHierarchy(Graph::UNLIMITED_RANGE));
+    REQUIRE(g.prepareLandmarks(100) != g.prepareLandmarks(Graph::UNLIMITED_RANGE));
+    for (RouteAlgorithm algorithm : {RouteAlgorithm::ContractionHierarchy, RouteAlgorithm::Landmarks}) {
+        REQUIRE(g.getShortestPath("KIAG", "CYOW", 0, Graph::UNLIMITED_RANGE, algorithm).first == expectedPath);
+        REQUIRE(g.getShortestPath("KIAG", "CYOW", 0, 100, algorithm).first.empty());
+    }
+
+    // once frozen, edges print by destination
+    std::ostringstream output;
+    g.printGraph(output);
+    REQUIRE(output.str().find("Airport CYYZ (Lester B. Pearson International Airport) -> CYOW (") != std::string::npos);
+}
+
+TEST_CASE("A graph generated at a large threshold finds the same routes as one generated at the aircraft's range") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph maxRangeGraph(jsonData.size());
+    maxRangeGraph.generateAirportGraph(jsonData, 1000, false, BuildMode::SpatialGrid);
+    REQUIRE(maxRangeGraph.getMaxRange() == 1000);
+    std::vector<Airport> airports = maxRangeGraph.getAirports();
+
+    for (int range : {120, 250, 500}) {
+        Graph rangeGraph(jsonData.size());
+        rangeGraph.generateAirportGraph(jsonData, range, false, BuildMode::SpatialGrid);
+
+        for (size_t i = 0; i < 40; ++i) {
+            const Airport& start = airports[(i * 37) % airports.size()];
+            const Airport& dest = airports[(i * 101 + 13) % airports.size()];
+
+            REQUIRE(maxRangeGraph.findShortestPath(start, dest, range) == rangeGraph.findShortestPath(start, dest));
+            REQUIRE(maxRangeGraph.findShortestPathMIN(start, dest, range) == rangeGraph.findShortestPathMIN(start, dest));
+        }
+    }
+
+    // an edge exactly as long as the range is flown, one a fraction longer is not
+    std::pair<std::vector<std::string>, double> direct = maxRangeGraph.getShortestPath("CYYZ", "CYOW");
+    REQUIRE(direct.first.size() == 2);
+    int length = static_cast<int>(direct.second);
+    REQUIRE(maxRangeGraph.getShortestPath("CYYZ", "CYOW", 0, length + 1).first.size() == 2);
+    REQUIRE(maxRangeGraph.getShortestPath("CYYZ", "CYOW", 0, length).first != direct.first);
+}
+
+TEST_CASE("A graph loaded from a snapshot matches the graph it was saved from") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 500, false, BuildMode::SpatialGrid);
+
+    std::string snapshotPath = (std::filesystem::temp_directory_path() / "graphTest.snapshot").string();
+    g.saveSnapshot(snapshotPath);
+
+    Graph loaded(0);
+    loaded.loadSnapshot(snapshotPath);
+    REQUIRE(loaded.getMaxRange() == 500);
+    REQUIRE(loaded.edgeCount() == g.edgeCount());
+
+    std::ostringstream expected, output;
+    g.printGraph(expected);
+    loaded.printGraph(output);
+    REQUIRE(output.str() == expected.str());
+
+    std::vector<Airport> airports = g.getAirports();
+    std::vector<Airport> loadedAirports = loaded.getAirports();
+    REQUIRE(loadedAirports.size() == airports.size());
+    for (size_t i = 0; i < airports.size(); ++i) {
+        REQUIRE(loadedAirports[i].id == airports[i].id);
+        REQUIRE(loadedAirports[i].continent == airports[i].continent);
+        REQUIRE(loadedAirports[i].latitude == airports[i].latitude);
+    }
+
+    REQUIRE(loaded.getShortestPath("KCLE", "CYOW", 0, 250) == g.getShortestPath("KCLE", "CYOW", 0, 250));
+    REQUIRE(loaded.nearestAirports(45.32, -75.67, 3).front().first.id == "CYOW");
+
+    // a truncated file is rejected
+    std::ifstream in(snapshotPath, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(snapshotPath, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size() / 2);
+    out.close();
+    Graph truncated(0);
+    REQUIRE_THROWS_AS(truncated.loadSnapshot(snapshotPath), std::runtime_error);
+
+    std::filesystem::remove(snapshotPath);
+}
+
+TEST_CASE("Streaming an airport dataset into a table matches parsing the whole document") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+
+    AirportTable streamed = AirportTable::load("./datasets/airports.json");
+    AirportTable parsed = AirportTable::fromJson(jsonData);
+    REQUIRE(streamed.size() == jsonData.size());
+    REQUIRE(parsed.size() == jsonData.size());
+
+    for (size_t i = 0; i < streamed.size(); ++i) {
+        REQUIRE(streamed.id(i) == jsonData[i]["ident"]);
+        REQUIRE(streamed.name(i) == parsed.name(i));
+        REQUIRE(streamed.continent(i) == jsonData[i]["continent"]);
+        REQUIRE(streamed.latitude(i) == std::stod(jsonData[i]["latitude"].get<std::string>()));
+        REQUIRE(streamed.longitude(i) == std::stod(jsonData[i]["longitude"].get<std::string>()));
+    }
+
+    Graph fromJson(jsonData.size());
+    fromJson.generateAirportGraph(jsonData, 250, false);
+    Graph fromTable(streamed.size());
+    fromTable.generateAirportGraph(streamed, 250, false);
+
+    std::ostringstream expected, output;
+    fromJson.printGraph(expected);
+    fromTable.printGraph(output);
+    REQUIRE(output.str() == expected.str());
+
+    std::istringstream missingField(R"([{"ident": "CYOW", "name": "Ottawa", "type": "large_airport", "latitude": "45.3"}])");
+    REQUIRE_THROWS_AS(AirportTable::load(missingField), std::runtime_error);
+    std::istringstream badCoordinate(R"([{"ident": "CYOW", "name": "Ottawa", "type": "large_airport", "latitude": "north", "longitude": "-75.6"}])");
+    REQUIRE_THROWS_AS(AirportTable::load(badCoordinate), std::runtime_error);
+    std::istringstream truncatedDocument(R"([{"ident": "CYOW", "name": )");
+    REQUIRE_THROWS_AS(AirportTable::load(truncatedDocument), std::runtime_error);
+}
+
+TEST_CASE("An airport table keeps its strings in one arena and its types as an enum") {
+    AirportTable table;
+    table.add("CYOW", "Ottawa Macdonald-Cartier International Airport", parseAirportType("large_airport"), "NA", 45.3225, -75.6692);
+    table.add("CYUL", "Montreal / Pierre Elliott Trudeau International Airport", parseAirportType("large_airport"), "NA", 45.4706, -73.7408);
+    table.add("XXXX", "Somewhere", parseAirportType("heliport"), "", 0, 0);
+
+    REQUIRE(table.id(1) == "CYUL");
+    REQUIRE(table.type(0) == AirportType::Large);
+    REQUIRE(table.type(2) == AirportType::Unknown);
+    REQUIRE(airportTypeName(table.type(1)) == "large_airport");
+    // the continent is interned, so both airports point at the same characters
+    REQUIRE(table.continent(0).data() == table.continent(1).data());
+
+    Airport copy = table.airport(0);
+    REQUIRE(copy.name == "Ottawa Macdonald-Cartier International Airport");
+    REQUIRE(copy.type == AirportType::Large);
+
+    Graph g(0);
+    g.generateAirportGraph(AirportTable::load("./datasets/airports.json"), 250, false);
+    int index = g.getAirportIndex("CYOW");
+    REQUIRE(index >= 0);
+    REQUIRE(g.getAirportTable().id(index) == "CYOW");
+    REQUIRE(g.getAirportIndex("NOPE") == -1);
+    REQUIRE(g.getAirportNameByCode("CYOW") == "CYOW: " + std::string(g.getAirportTable().name(index)));
+    REQUIRE(g.getAirportNameByCode("NOPE") == "NOPE NOT FOUND");
+}
+
+TEST_CASE("Bidirectional fewest-landings routes never land more often than the shortest routes") {
+    Graph& g = airportsGraph();
+    std::vector<Airport> airports = g.getAirports();
+
+    for (int range : {250, 500}) {
+        for (const auto& [start, dest] : samplePairs(airports.size(), 40)) {
+            std::pair<std::vector<int>, double> shortest = g.findShortestPathBidirectional(airports[start], airports[dest], range);
+            std::pair<std::vector<int>, double> fewestLandings =
+                g.findShortestPathBidirectional(airports[start], airports[dest], range, true);
+            REQUIRE(fewestLandings.first.size() <= shortest.first.size());
+            REQUIRE(fewestLandings.second >= shortest.second);
+        }
+    }
+
+    Graph threads(0);
+    threads.generateAirportGraph(AirportTable::load("./datasets/airports.json"), 500, false, BuildMode::SpatialGrid);
+    threads.setBidirectionalThreads(true);
+    REQUIRE(threads.getShortestPath("CYOW", "KLAX", 0, 500, RouteAlgorithm::Bidirectional).second ==
+            threads.getShortestPath("CYOW", "KLAX", 0, 500, RouteAlgorithm::AStar).second);
+}
+
+TEST_CASE("Contraction hierarchies are shared by the ranges they answer") {
+    Graph& g = airportsGraph();
+
+    // the hierarchy of a range is built once, and every range long enough for every flight shares one
+    std::shared_ptr<const ContractionHierarchy> hierarchy = g.prepareContractionHierarchy(250);
+    REQUIRE(g.prepareContractionHierarchy(250) == hierarchy);
+    REQUIRE(hierarchy->getRange() == 250);
+
+    // a range without a hierarchy still gets the shortest route, and no hierarchy is built for it
+    REQUIRE_FALSE(g.hasContractionHierarchy(300));
+    const AirportTable& airports = g.getAirportTable();
+    for (const auto& [start, dest] : samplePairs(airports.size(), 150)) {
+        requireRoute(g.findShortestPath(airports.airport(start), airports.airport(dest), 300,
+                                        RouteAlgorithm::ContractionHierarchy),
+                     start, dest, expectedDistance(g, start, dest, 300));
+    }
+    REQUIRE_FALSE(g.hasContractionHierarchy(300));
+
+    AirportTable table = AirportTable::load("./datasets/testairports_multi.json");
+    Graph small(table.size());
+    small.generateAirportGraph(table, 300, false);
+    std::vector<Airport> smallAirports = small.getAirports();
+
+    // a range without a hierarchy is searched with Dijkstra instead, and no hierarchy is built for it
+    REQUIRE_FALSE(small.hasContractionHierarchy(Graph::UNLIMITED_RANGE));
+    for (const Airport& start : smallAirports) {
+        for (const Airport& dest : smallAirports) {
+            REQUIRE(small.findShortestPath(start, dest, Graph::UNLIMITED_RANGE, RouteAlgorithm::ContractionHierarchy).second ==
+                    small.findShortestPathBidirectional(start, dest).second);
+        }
+    }
+    REQUIRE_FALSE(small.hasContractionHierarchy(Graph::UNLIMITED_RANGE));
+
+    REQUIRE(small.prepareContractionHierarchy(1000) == small.prepareContractionHierarchy(Graph::UNLIMITED_RANGE));
+    REQUIRE(small.hasContractionHierarchy(Graph::UNLIMITED_RANGE));
+    for (const Airport& start : smallAirports) {
+        for (const Airport& dest : smallAirports) {
+            REQUIRE(small.findShortestPath(start, dest, Graph::UNLIMITED_RANGE, RouteAlgorithm::ContractionHierarchy).second ==
+                    small.findShortestPathBidirectional(start, dest).second);
+        }
+    }
+
+    // only the most recently used hierarchies are kept
+    for (int range = 1; range <= static_cast<int>(Graph::MAX_PREPARED_RANGES); ++range) {
+        small.prepareContractionHierarchy(range);
+    }
+    REQUIRE_FALSE(small.hasContractionHierarchy(Graph::UNLIMITED_RANGE));
+    REQUIRE(small.hasContractionHierarchy(1));
+    REQUIRE(small.hasContractionHierarchy(static_cast<int>(Graph::MAX_PREPARED_RANGES)));
+}
+
+TEST_CASE("Landmark bounds never exceed the shortest route") {
+    Graph& g = airportsGraph();
+
+    for (int range : {250, 500}) {
+        std::shared_ptr<const LandmarkTable> landmarks = g.prepareLandmarks(range);
+        REQUIRE(landmarks->numLandmarks() == LandmarkTable::DEFAULT_LANDMARKS);
+        REQUIRE(g.prepareLandmarks(range) == landmarks);
+        std::vector<uint32_t> all(landmarks->numLandmarks());
+        for (size_t l = 0; l < all.size(); ++l) {
+            all[l] = static_cast<uint32_t>(l);
+        }
+
+        // the bound never exceeds the route, and proves unreachable routes unreachable
+        for (const auto& [start, dest] : samplePairs(g.getAirportTable().size(), 40)) {
+            int expected = dijkstraDistances(g, start, range)[dest];
+            uint32_t bound = landmarks->lowerBound(start, dest, all);
+            if (expected < 0) {
+                REQUIRE(bound == LandmarkTable::UNREACHED);
+            } else {
+                REQUIRE(bound <= static_cast<uint32_t>(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("Farthest landmark selection picks the ends of a line") {
+    // 0 - 1 - 2 - 3 - 4, each flight 100nm
+    std::vector<Edge> edges;
+    for (Vertex v = 0; v < 4; ++v) {
+        edges.emplace_back(v, v + 1, CompressedAdjacency::packWeight(100));
+        edges.emplace_back(v + 1, v, CompressedAdjacency::packWeight(100));
+    }
+    CompressedAdjacency adjacency(5, edges);
+
+    LandmarkTable table = LandmarkTable::build(adjacency, 500, 2, LandmarkSelection::Farthest, 1);
+    REQUIRE(table.getLandmarks() == std::vector<uint32_t>{4, 0});
+    REQUIRE(table.distance(0, 1) == 300);
+    REQUIRE(table.lowerBound(1, 3, {0, 1}) == 200);
+}
+
+TEST_CASE("A search context is reused across searches and graphs") {
+    Graph& g = airportsGraph();
+    std::vector<Airport> airports = g.getAirports();
+
+    SearchContext context;
+    for (const auto& [start, dest] : samplePairs(airports.size(), 40)) {
+        for (RouteAlgorithm algorithm : {RouteAlgorithm::FewestLandings, RouteAlgorithm::Distance, RouteAlgorithm::AStar,
+                                           RouteAlgorithm::Landmarks}) {
+            // a fresh context each time gives the same route as one left over from the previous searches
+            SearchContext fresh;
+            REQUIRE(g.findShortestPath(airports[start], airports[dest], context, 250, algorithm) ==
+                    g.findShortestPath(airports[start], airports[dest], fresh, 250, algorithm));
+        }
+    }
+
+    // a context sized for the large graph also serves a smaller one
+    AirportTable table = AirportTable::load("./datasets/testairports_multi.json");
+    Graph small(table.size());
+    small.generateAirportGraph(table, 250, false);
+    REQUIRE(small.getShortestPath("KCLE", "CYOW", context) == small.getShortestPath("KCLE", "CYOW"));
+    REQUIRE(small.getShortestPath("KMDW", "CYOW", context).first.empty());
+}
+
+TEST_CASE("Every search queue gives the same routes") {
+    Graph& g = airportsGraph();
+    std::vector<Airport> airports = g.getAirports();
+
+    SearchContext binary(SearchQueue::BinaryHeap);
+    SearchContext quaternary(SearchQueue::QuaternaryHeap);
+    SearchContext radix(SearchQueue::RadixHeap);
+    for (int range : {250, 500}) {
+        for (const auto& [start, dest] : samplePairs(airports.size(), 40)) {
+            // ties between equal distances pop in the same order on every queue, so even the landings agree
+            for (RouteAlgorithm algorithm : {RouteAlgorithm::FewestLandings, RouteAlgorithm::Distance}) {
+                auto expected = g.findShortestPath(airports[start], airports[dest], binary, range, algorithm);
+                REQUIRE(g.findShortestPath(airports[start], airports[dest], quaternary, range, algorithm) == expected);
+                REQUIRE(g.findShortestPath(airports[start], airports[dest], radix, range, algorithm) == expected);
+            }
+        }
+    }
+
+    SearchQueue queue;
+    REQUIRE(parseSearchQueue("radix", queue));
+    REQUIRE(queue == SearchQueue::RadixHeap);
+    REQUIRE(searchQueueName(SearchQueue::QuaternaryHeap) == "4-ary");
+    REQUIRE_FALSE(parseSearchQueue("fibonacci", queue));
+}
+
+TEST_CASE("K shortest paths match every simple route ranked by distance") {
+    // a small random network, small enough to list every route without a repeated airport
+    std::mt19937 rng(7);
+    const Vertex numVertices = 8;
+    std::vector<std::vector<std::pair<Vertex, int>>> flights(numVertices);
+    std::vector<Edge> edges;
+    for (Vertex u = 0; u < numVertices; ++u) {
+        for (Vertex v = u + 1; v < numVertices; ++v) {
+            if (rng() % 2 == 0) {
+                int distance = 50 + rng() % 400;
+                flights[u].push_back({v, distance});
+                flights[v].push_back({u, distance});
+                edges.emplace_back(u, v, CompressedAdjacency::packWeight(distance));
+                edges.emplace_back(v, u, CompressedAdjacency::packWeight(distance));
+            }
+        }
+    }
+    CompressedAdjacency adjacency(numVertices, edges);
+
+    const uint32_t range = 300;
+    std::vector<int> allCosts;
+    std::vector<char> onPath(numVertices, 0);
+    std::function<void(Vertex, int)> listRoutes = [&](Vertex u, int cost) {
+        if (u == numVertices - 1) {
+            allCosts.push_back(cost);
+            return;
+        }
+        onPath[u] = 1;
+        for (const auto& [v, distance] : flights[u]) {
+            if (!onPath[v] && static_cast<uint32_t>(distance) <= range) {
+                listRoutes(v, cost + distance);
+            }
+        }
+        onPath[u] = 0;
+    };
+    listRoutes(0, 0);
+    std::sort(allCosts.begin(), allCosts.end());
+    REQUIRE(allCosts.size() > 3);
+
+    WorkStealingPool pool(2);
+    KShortestPaths search(adjacency, pool);
+    std::vector<std::pair<std::vector<int>, double>> routes = search.findPaths(0, numVertices - 1, allCosts.size() + 5, range);
+    REQUIRE(routes.size() == allCosts.size());
+    std::set<std::vector<int>> distinct;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        REQUIRE(routes[i].second == allCosts[i]);
+        REQUIRE(routes[i].first.front() == static_cast<int>(numVertices - 1));
+        REQUIRE(routes[i].first.back() == 0);
+        distinct.insert(routes[i].first);
+    }
+    REQUIRE(distinct.size() == routes.size());
+
+    Graph g(0);
+    g.generateAirportGraph(AirportTable::load("./datasets/testairports_multi.json"), 250, false);
+    std::vector<std::pair<std::vector<std::string>, double>> named = g.getKShortestPaths("KCLE", "CYOW", 3);
+    REQUIRE_FALSE(named.empty());
+    REQUIRE(named[0].first.front() == "KCLE");
+    REQUIRE(named[0].first.back() == "CYOW");
+    REQUIRE(g.getKShortestPaths("KMDW", "CYOW", 3).empty());
+
+    // a pool shared by several searches gives the same routes, search after search
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        REQUIRE(g.getKShortestPaths("KCLE", "CYOW", 3, pool) == named);
+        REQUIRE(g.getKShortestPaths("KMDW", "CYOW", 3, pool).empty());
+    }
+}
+
+TEST_CASE("A distance matrix matches single route searches, with or without a hierarchy") {
+    Graph g(0);
+    g.generateAirportGraph(AirportTable::load("./datasets/airports.json"), 500, false, BuildMode::SpatialGrid);
+    std::vector<Airport> airports = g.getAirports();
+
+    std::vector<std::string> sources, targets;
+    for (size_t i = 0; i < 12; ++i) {
+        sources.push_back(airports[(i * 37) % airports.size()].id);
+    }
+    for (size_t i = 0; i < 15; ++i) {
+        targets.push_back(airports[(i * 101 + 13) % airports.size()].id);
+    }
+    targets.push_back(sources[0]);
+    targets.push_back(targets[0]);
+
+    DistanceMatrix searched = g.distanceMatrix(sources, targets, 250, true, 2);
+    REQUIRE(searched.numSources() == sources.size());
+    REQUIRE(searched.numTargets() == targets.size());
+    for (size_t s = 0; s < sources.size(); ++s) {
+        for (size_t t = 0; t < targets.size(); ++t) {
+            std::pair<std::vector<int>, double> expected =
+                g.findShortestPathBidirectional(airports[g.getAirportIndex(sources[s])], airports[g.getAirportIndex(targets[t])], 250);
+            if (sources[s] == targets[t]) {
+                REQUIRE(searched.distance(s, t) == 0);
+                REQUIRE(searched.hops(s, t) == 0);
+            } else if (expected.first.empty()) {
+                REQUIRE(searched.distance(s, t) == DistanceMatrix::UNREACHABLE);
+                REQUIRE(searched.path(s, t).empty());
+            } else {
+                REQUIRE(searched.distance(s, t) == expected.second);
+                REQUIRE(searched.hops(s, t) == static_cast<int>(searched.path(s, t).size()) - 1);
+                REQUIRE(searched.path(s, t).front() == g.getAirportIndex(targets[t]));
+                REQUIRE(searched.path(s, t).back() == g.getAirportIndex(sources[s]));
+            }
+        }
+    }
+
+    // with the hierarchy built, its buckets give the same distances and landings
+    g.prepareContractionHierarchy(250);
+    DistanceMatrix bucketed = g.distanceMatrix(sources, targets, 250, true, 2);
+    for (size_t s = 0; s < sources.size(); ++s) {
+        for (size_t t = 0; t < targets.size(); ++t) {
+            REQUIRE(bucketed.distance(s, t) == searched.distance(s, t));
+            REQUIRE(bucketed.hops(s, t) == searched.hops(s, t));
+            REQUIRE(static_cast<int>(bucketed.path(s, t).size()) == searched.hops(s, t) + 1);
+            if (!bucketed.path(s, t).empty()) {
+                REQUIRE(bucketed.path(s, t).front() == g.getAirportIndex(targets[t]));
+                REQUIRE(bucketed.path(s, t).back() == g.getAirportIndex(sources[s]));
+            }
+        }
+    }
+
+    // a shared pool gives the same matrices, searched and bucketed, one request after another
+    WorkStealingPool pool(3);
+    DistanceMatrix searched300 = g.distanceMatrix(sources, targets, 300, true, 2);
+    for (int repeat = 0; repeat < 2; ++repeat) {
+        DistanceMatrix pooled = g.distanceMatrix(sources, targets, pool, 250, true);
+        DistanceMatrix pooledSearch = g.distanceMatrix(sources, targets, pool, 300, true);
+        for (size_t s = 0; s < sources.size(); ++s) {
+            for (size_t t = 0; t < targets.size(); ++t) {
+                REQUIRE(pooled.distance(s, t) == bucketed.distance(s, t));
+                REQUIRE(pooled.path(s, t) == bucketed.path(s, t));
+                REQUIRE(pooledSearch.distance(s, t) == searched300.distance(s, t));
+                REQUIRE(pooledSearch.path(s, t) == searched300.path(s, t));
+            }
+        }
+    }
+
+    REQUIRE_FALSE(g.distanceMatrix(sources, targets, 250).hasPaths());
+    REQUIRE_THROWS_AS(g.distanceMatrix({"NOT AN AIRPORT"}, targets), std::invalid_argument);
+}
+
+TEST_CASE("The minimum range is the first range a route is found at") {
+    Graph& g = airportsGraph();
+    std::vector<Airport> airports = g.getAirports();
+
+    for (const auto& [startIdx, destIdx] : samplePairs(airports.size(), 60)) {
+        const Airport& start = airports[startIdx];
+        const Airport& dest = airports[destIdx];
+        int range = g.minimumRange(start.id, dest.id);
+        REQUIRE(range >= 0);
+        if (range > 500) {
+            REQUIRE(g.findShortestPath(start, dest, 500).first.empty());
+            continue;
+        }
+        if (start.id != dest.id) {
+            REQUIRE_FALSE(g.findShortestPath(start, dest, range).first.empty());
+            REQUIRE(g.findShortestPath(start, dest, range - 1).first.empty());
+        }
+    }
+
+    // two airports are in one component at exactly the ranges at least their minimum range
+    std::shared_ptr<const MinimumRangeTree> tree = g.prepareMinimumRangeTree();
+    for (int range : {150, 250, 500}) {
+        for (const auto& [startIdx, destIdx] : samplePairs(airports.size(), 60)) {
+            REQUIRE((tree->component(startIdx, range) == tree->component(destIdx, range)) ==
+                    (g.minimumRange(airports[startIdx].id, airports[destIdx].id) <= range));
+        }
+    }
+
+    REQUIRE(g.minimumRange(airports[3].id, airports[3].id) == 0);
+    REQUIRE(g.minimumRange("NOT AN AIRPORT", airports[0].id) == -1);
+    REQUIRE(g.prepareMinimumRangeTree() == g.prepareMinimumRangeTree());
+    REQUIRE(g.prepareMinimumRangeTree()->numAirports() == airports.size());
+}
+
+TEST_CASE("Components of the minimum range tree match the airports a search can reach") {
+    Graph& g = airportsGraph();
+    std::vector<Airport> airports = g.getAirports();
+    std::shared_ptr<const MinimumRangeTree> tree = g.prepareMinimumRangeTree();
+    const int NO_LIMIT = ReachableAirports::NO_LIMIT;
+
+    for (int range : {150, 250}) {
+        // a component holds the start and every airport a search from it reaches, and nothing else
+        std::set<uint32_t> components;
+        for (size_t i = 0; i < 12; ++i) {
+            size_t start = (i * 97) % airports.size();
+            uint32_t component = tree->component(start, range);
+            components.insert(component);
+            ReachableAirports reached = g.reachableAirports(airports[start].id, NO_LIMIT, NO_LIMIT, range);
+            REQUIRE(tree->componentSize(component) == reached.size() + 1);
+            for (size_t k = 0; k < reached.size(); ++k) {
+                REQUIRE(tree->component(reached.airport(k), range) == component);
+            }
+        }
+        // 150nm splits the network, and the starts fall in several parts of it
+        REQUIRE((range > 150 || components.size() > 1));
+
+        for (const auto& [startIdx, destIdx] : samplePairs(airports.size(), 60)) {
+            bool connected = tree->component(startIdx, range) == tree->component(destIdx, range);
+            REQUIRE(connected == !g.findShortestPath(airports[startIdx], airports[destIdx], range).first.empty());
+            if (startIdx != destIdx) {
+                REQUIRE(connected == !g.getShortestPath(airports[startIdx].id, airports[destIdx].id, 0, range).first.empty());
+            }
+        }
+    }
+
+    // past every flight, one component holds every airport
+    REQUIRE(tree->componentSize(tree->component(0, UINT32_MAX)) == airports.size());
+}
+
+TEST_CASE("Reachable airports match the shortest routes within the flight and distance limits") {
+    Graph g(0);
+    g.generateAirportGraph(AirportTable::load("./datasets/airports.json"), 500, false, BuildMode::SpatialGrid);
+    std::vector<Airport> airports = g.getAirports();
+    const Airport& start = airports[17];
+    const int NO_LIMIT = ReachableAirports::NO_LIMIT;
+
+    std::vector<std::string> ids;
+    for (const Airport& airport : airports) {
+        ids.push_back(airport.id);
+    }
+    DistanceMatrix matrix = g.distanceMatrix({start.id}, ids, 150);
+    auto asMap = [](const ReachableAirports& reachable) {
+        std::map<uint32_t, std::pair<int, int>> found;
+        for (size_t i = 0; i < reachable.size(); ++i) {
+            REQUIRE((i == 0 || reachable.distance(i - 1) <= reachable.distance(i)));
+            found[reachable.airport(i)] = {reachable.distance(i), reachable.hops(i)};
+        }
+        REQUIRE(found.size() == reachable.size());
+        return found;
+    };
+
+    // within a distance: the airports whose shortest route is no longer, with its distance and flights
+    std::map<uint32_t, std::pair<int, int>> withinDistance = asMap(g.reachableAirports(start.id, NO_LIMIT, 600, 150));
+    size_t expected = 0;
+    for (size_t v = 0; v < airports.size(); ++v) {
+        double distance = matrix.distance(0, v);
+        if (v == 17 || distance == DistanceMatrix::UNREACHABLE || distance > 600) {
+            REQUIRE(withinDistance.count(v) == 0);
+            continue;
+        }
+        ++expected;
+        REQUIRE(withinDistance.at(v).first == distance);
+        REQUIRE(withinDistance.at(v).second == matrix.hops(0, v));
+    }
+    REQUIRE(withinDistance.size() == expected);
+    REQUIRE(expected > 0);
+
+    // one flight: exactly the airports with a direct flight
+    std::map<uint32_t, std::pair<int, int>> direct = asMap(g.reachableAirports(start.id, 1, NO_LIMIT, 150));
+    for (size_t v = 0; v < airports.size(); ++v) {
+        bool isDirect = v != 17 && g.findShortestPath(start, airports[v], 150).first.size() == 2;
+        REQUIRE(direct.count(v) == (isDirect ? 1u : 0u));
+    }
+
+    // enough flights: every airport a route reaches, at its shortest distance
+    std::map<uint32_t, std::pair<int, int>> everywhere = asMap(g.reachableAirports(start.id, 100000, NO_LIMIT, 150));
+    std::map<uint32_t, std::pair<int, int>> unlimited = asMap(g.reachableAirports(start.id, NO_LIMIT, NO_LIMIT, 150));
+    REQUIRE(everywhere.size() == unlimited.size());
+    std::shared_ptr<const MinimumRangeTree> tree = g.prepareMinimumRangeTree();
+    REQUIRE(unlimited.size() + 1 == tree->componentSize(tree->component(17, 150)));
+    for (const auto& [v, found] : unlimited) {
+        REQUIRE(everywhere.at(v).first == found.first);
+    }
+
+    // both limits: fewer airports, never closer than their shortest route
+    std::map<uint32_t, std::pair<int, int>> fewer = asMap(g.reachableAirports(start.id, 2, NO_LIMIT, 150));
+    std::map<uint32_t, std::pair<int, int>> both = asMap(g.reachableAirports(start.id, 2, 600, 150));
+    for (const auto& [v, found] : both) {
+        REQUIRE(found.second <= 2);
+        REQUIRE(found.first <= 600);
+        REQUIRE(fewer.at(v).first == found.first);
+        REQUIRE(withinDistance.at(v).first <= found.first);
+    }
+    for (const auto& [v, found] : fewer) {
+        REQUIRE(both.count(v) == (found.first <= 600 ? 1u : 0u));
+    }
+
+    REQUIRE_THROWS_AS(g.reachableAirports("NOT AN AIRPORT", 2), std::invalid_argument);
+}
+
+TEST_CASE("The route cache answers repeated and concurrent identical requests with one search") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 500, false);
+    std::vector<Airport> airports = g.getAirports();
+
+    RouteCache cache(1024 * 1024, 4);
+    std::atomic<int> searches(0);
+    auto search = [&](const std::string& start, const std::string& dest) {
+        return [&, start, dest]() {
+            ++searches;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return g.getShortestPath(start, dest, 0, 300);
+        };
+    };
+
+    // requests for the same pair that arrive while it is being searched wait for that search
+    RouteCache::Key key{airports[0].id, airports[400].id, 300, 0, 0};
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<const RouteCache::Route>> results(8);
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i]() { results[i] = cache.getOrCompute(key, search(key.start, key.dest)); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(searches == 1);
+    for (const std::shared_ptr<const RouteCache::Route>& result : results) {
+        REQUIRE(*result == g.getShortestPath(key.start, key.dest, 0, 300));
+    }
+    RouteCache::Stats stats = cache.stats();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.hits + stats.coalesced == 7);
+    REQUIRE(stats.entries == 1);
+
+    // the key includes the range, mode and algorithm
+    RouteCache::Key otherRange = key;
+    otherRange.range = 500;
+    cache.getOrCompute(otherRange, search(key.start, key.dest));
+    REQUIRE(searches == 2);
+
+    // a failed search is not cached
+    RouteCache::Key failing{airports[1].id, airports[2].id, 300, 0, 0};
+    REQUIRE_THROWS_AS(cache.getOrCompute(failing, []() -> RouteCache::Route { throw std::runtime_error("search failed"); }),
+                      std::runtime_error);
+    cache.getOrCompute(failing, search(failing.start, failing.dest));
+    REQUIRE(searches == 3);
+    REQUIRE(cache.stats().entries == 3);
+
+    // a small budget keeps only the most recently used results
+    RouteCache small(2048, 1);
+    for (size_t i = 0; i < 40; ++i) {
+        small.getOrCompute({airports[i].id, airports[i + 1].id, 300, 0, 0},
+                           [&]() { return g.getShortestPath(airports[i].id, airports[i + 1].id, 0, 300); });
+        REQUIRE(small.stats().bytes <= 2048);
+    }
+    RouteCache::Stats smallStats = small.stats();
+    REQUIRE(smallStats.evictions > 0);
+    REQUIRE(smallStats.entries + smallStats.evictions == 40);
+    small.getOrCompute({airports[39].id, airports[40].id, 300, 0, 0}, []() -> RouteCache::Route { return {}; });
+    REQUIRE(small.stats().hits == 1);
+
+    cache.clear();
+    REQUIRE(cache.stats().entries == 0);
+    REQUIRE(cache.stats().bytes == 0);
+}
+
+TEST_CASE("Routes with a limit on stops are the shortest routes with that many flights or fewer") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 500, false);
+    std::vector<Airport> airports = g.getAirports();
+    const int range = 200;
+
+    // the layered search of reachableAirports gives the shortest distance within a number of flights to every airport
+    auto distanceWithin = [&](size_t src, size_t dest, int flights) {
+        ReachableAirports reachable = g.reachableAirports(airports[src].id, flights, ReachableAirports::NO_LIMIT, range);
+        for (size_t i = 0; i < reachable.size(); ++i) {
+            if (reachable.airport(i) == dest) {
+                return reachable.distance(i);
+            }
+        }
+        return -1;
+    };
+
+    size_t checked = 0;
+    for (size_t pair = 0; pair < 12; ++pair) {
+        size_t src = (pair * 97) % airports.size();
+        size_t dest = (pair * 389 + 11) % airports.size();
+        std::vector<std::pair<std::vector<std::string>, double>> byStops =
+            g.getShortestPathsByStops(airports[src].id, airports[dest].id, 6, 0, range);
+
+        double previous = -1;
+        for (int stops = 0; stops <= 6; ++stops) {
+            std::pair<std::vector<int>, double> route = g.findShortestPathWithStops(airports[src], airports[dest], stops, range);
+            // a route to the airport it starts at takes no flights, whatever the limit
+            int expected = src == dest ? 0 : distanceWithin(src, dest, stops + 1);
+            if (expected < 0) {
+                REQUIRE(route.first.empty());
+                continue;
+            }
+            ++checked;
+            REQUIRE(route.second == expected);
+            REQUIRE(route.first.size() <= static_cast<size_t>(stops) + 2);
+            REQUIRE(route.first.front() == static_cast<int>(dest));
+            REQUIRE(route.first.back() == static_cast<int>(src));
+            int length = 0;
+            for (size_t i = 0; i + 1 < route.first.size(); ++i) {
+                int flight = distanceWithin(route.first[i + 1], route.first[i], 1);
+                REQUIRE(flight >= 0);
+                length += flight;
+            }
+            REQUIRE(length == route.second);
+            REQUIRE(g.getShortestPathWithStops(airports[src].id, airports[dest].id, stops, 0, range).second == route.second);
+
+            // each number of stops that shortens the route gives one route, fewest stops first
+            if (route.second != previous) {
+                REQUIRE(std::any_of(byStops.begin(), byStops.end(), [&](const auto& r) { return r.second == route.second; }));
+            }
+            previous = route.second;
+        }
+        REQUIRE(byStops.empty() == (previous < 0));
+        if (!byStops.empty()) {
+            REQUIRE(byStops.back().second == previous);
+        }
+    }
+    REQUIRE(checked > 10);
+    REQUIRE(g.getShortestPathsByStops("NOT AN AIRPORT", airports[0].id, 3).empty());
+
+    for (int stops : {0, 3}) {
+        std::pair<std::vector<int>, double> route = g.findShortestPathWithStops(airports[5], airports[5], stops, range);
+        REQUIRE(route == std::pair<std::vector<int>, double>({5}, 0));
+        REQUIRE(g.getShortestPathWithStops(airports[5].id, airports[5].id, stops, 0, range) ==
+                std::pair<std::vector<std::string>, double>({airports[5].id}, 0));
+        REQUIRE(g.getShortestPathsByStops(airports[5].id, airports[5].id, stops, 0, range).size() == 1);
+    }
+}
+
+TEST_CASE("Delta-stepping distances from an airport match Dijkstra's for any bucket width and thread count") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 500, false);
+    std::vector<Airport> airports = g.getAirports();
+
+    for (int range : {150, 500, Graph::UNLIMITED_RANGE}) {
+        for (size_t start : {size_t(0), airports.size() / 2}) {
+            // a Dijkstra with no limits reaches every airport with a route, at its shortest distance
+            std::vector<int> expected(airports.size(), DeltaStepping::UNREACHABLE);
+            expected[start] = 0;
+            ReachableAirports reachable = g.reachableAirports(airports[start].id, ReachableAirports::NO_LIMIT,
+                                                              ReachableAirports::NO_LIMIT, range);
+            for (size_t i = 0; i < reachable.size(); ++i) {
+                expected[reachable.airport(i)] = reachable.distance(i);
+            }
+
+            for (uint32_t bucketWidth : {0u, 1u, 40u, 1000u}) {
+                for (size_t numThreads : {1, 3}) {
+                    REQUIRE(g.distancesFrom(airports[start].id, range, numThreads, bucketWidth) == expected);
+                }
+            }
+        }
+    }
+    REQUIRE_THROWS_AS(g.distancesFrom("NOT AN AIRPORT"), std::invalid_argument);
+}
+
+TEST_CASE("The airport search index finds the same airports as scanning every code and name") {
+    std::ifstream file("./datasets/airports.json");
+    nlohmann::json jsonData;
+    file >> jsonData;
+    Graph g(jsonData.size());
+    g.generateAirportGraph(jsonData, 500, false);
+    const AirportTable& table = g.getAirportTable();
+    std::shared_ptr<const AirportSearchIndex> index = g.prepareSearchIndex();
+    REQUIRE(index->size() == table.size());
+
+    auto scan = [&](const std::string& text, bool includeCodes) {
+        std::string upperText = toUpperCase(text);
+        std::vector<uint32_t> found;
+        for (size_t i = 0; i < table.size(); ++i) {
+            bool matchesName = toUpperCase(std::string(table.name(i))).find(upperText) != std::string::npos;
+            bool matchesCode = toUpperCase(std::string(table.id(i))).find(upperText) != std::string::npos;
+            if (matchesName || (includeCodes && matchesCode)) {
+                found.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return found;
+    };
+
+    // parts of real names and codes of every length, in mixed case, and text that is in no airport
+    std::vector<std::string> queries = {"", "a", "Ot", "ott", "Ottawa", "inter", "INTERNATIONAL AIRPORT", "cy", "CYO",
+                                        "CYOW", "ield", "airport", "zzq", "xyzzy", "  "};
+    for (size_t i = 0; i < table.size(); i += table.size() / 20 + 1) {
+        std::string name(table.name(i));
+        queries.push_back(name.substr(name.size() / 3, 5));
+        queries.push_back(std::string(table.id(i)).substr(1));
+    }
+    for (const std::string& query : queries) {
+        REQUIRE(index->search(query) == scan(query, true));
+        REQUIRE(index->search(query, false) == scan(query, false));
+
+        std::vector<std::string> byName = g.searchAirportCodeByName(query);
+        std::vector<uint32_t> expected = scan(query, false);
+        REQUIRE(byName.size() == expected.size());
+        for (size_t k = 0; k < expected.size(); ++k) {
+            REQUIRE(byName[k] == std::string(table.id(expected[k])) + ": " + std::string(table.name(expected[k])));
+        }
+    }
+    REQUIRE(index->code(0) == toUpperCase(std::string(table.id(0))));
+    REQUIRE(g.prepareSearchIndex() == index);
+}
+
+TEST_CASE("A work-stealing pool runs every task of each job once, on the same workers, from several threads") {
+    WorkStealingPool pool(3);
+    REQUIRE(pool.size() == 3);
+
+    // each worker records its thread, which must not change from job to job
+    std::vector<std::thread::id> workerThreads(pool.size());
+    std::vector<std::atomic<int>> runs(1000);
+    std::atomic<bool> movedThread(false);
+    for (size_t job = 0; job < 5; ++job) {
+        pool.run(runs.size(), [&](size_t task, size_t worker) {
+            runs[task]++;
+            if (workerThreads[worker] == std::thread::id()) {
+                workerThreads[worker] = std::this_thread::get_id();
+            } else if (workerThreads[worker] != std::this_thread::get_id()) {
+                movedThread = true;
+            }
+        });
+    }
+    REQUIRE_FALSE(movedThread);
+    for (const auto& count : runs) {
+        REQUIRE(count == 5);
+    }
+
+    // jobs from several threads take turns
+    std::atomic<int> total(0);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; ++c) {
+        callers.emplace_back([&]() { pool.run(100, [&](size_t, size_t) { total++; }); });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    REQUIRE(total == 400);
+
+    // a task's exception reaches the caller, and the pool keeps running jobs
+    REQUIRE_THROWS_AS(pool.run(100, [](size_t task, size_t) {
+        if (task == 42) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    total = 0;
+    pool.run(10, [&](size_t, size_t) { total++; });
+    REQUIRE(total == 10);
+    pool.run(0, [&](size_t, size_t) { total++; });
+    REQUIRE(total == 10);
+}
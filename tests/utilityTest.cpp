@@ -26,6 +26,18 @@ TEST_CASE("Test toInteger") {
     REQUIRE(toInteger("500") == 500);
 }
 
+TEST_CASE("Test toFiniteDouble") {
+    double value = 7;
+    for (const char* text : {"", " ", "Hello", "nan", "NaN", "-nan", "inf", "-inf", "infinity", "1e999"}) {
+        REQUIRE_FALSE(toFiniteDouble(text, value));
+        REQUIRE(value == 7);
+    }
+    REQUIRE(toFiniteDouble("45.3225", value));
+    REQUIRE(value == 45.3225);
+    REQUIRE(toFiniteDouble("-180", value));
+    REQUIRE(value == -180);
+}
+
 TEST_CASE("Test toUpperCase") {
     std::string s = "hello world";
     REQUIRE(toUpperCase("") == "");
@@ -33,3 +45,22 @@ TEST_CASE("Test toUpperCase") {
     REQUIRE(toUpperCase("name") == "NAME");
     REQUIRE(toUpperCase(s) == "HELLO WORLD");
 }
+
+TEST_CASE("Test formatCoordinate gives back the datasets' coordinate text") {
+    REQUIRE(formatCoordinate(45.3225) == "45.3225");
+    REQUIRE(formatCoordinate(-88.41190338134766) == "-88.41190338134766");
+    REQUIRE(formatCoordinate(-90) == "-90");
+    REQUIRE(formatCoordinate(0) == "0");
+
+    for (const char* filename : {"./datasets/airports.json", "./datasets/global_airports.json"}) {
+        std::ifstream file(filename);
+        nlohmann::json airports;
+        file >> airports;
+        for (const nlohmann::json& airport : airports) {
+            for (const char* key : {"latitude", "longitude"}) {
+                std::string text = airport[key].get<std::string>();
+                REQUIRE(formatCoordinate(std::stod(text)) == text);
+            }
+        }
+    }
+}